@@ -30,9 +30,14 @@
  */
 
 #include <future>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include <string.h>
 #include <unistd.h>
+#include <zlib.h>
 
 #include "config.h"
 
@@ -50,8 +55,10 @@
 #include "base/injector.hh"
 #include "base/lnav_log.hh"
 #include "base/paths.hh"
+#include "base/string_util.hh"
 #include "fmt/format.h"
 #include "hasher.hh"
+#include "safe/safe.h"
 
 namespace fs = std::filesystem;
 
@@ -186,13 +193,117 @@ filename_to_tmp_path(const std::string& filename)
 }
 
 #if HAVE_ARCHIVE_H
-static walk_result_t
-copy_data(const std::string& filename,
+using extract_result_t = Result<void, std::string>;
+
+/**
+ * The suffix added to files that are stored compressed in the cache.
+ */
+static constexpr char COMPRESSED_SUFFIX[] = ".lnav.gz";
+
+static constexpr size_t MAX_EXTRACT_WORKERS = 4;
+
+static const std::string CANCELLED_MSG = "extraction was cancelled";
+
+/**
+ * The state of an archive that is being unpacked in the background.
+ */
+struct extraction_job {
+    struct member {
+        extracted_file m_file;
+        bool m_finished{false};
+    };
+
+    /**
+     * A link whose target might be stored under a different name in a
+     * compressed cache, so it is created after all the members are out.
+     */
+    struct deferred_link {
+        fs::path dl_path;
+        fs::path dl_target;
+        std::string dl_value;
+        bool dl_hard{false};
+    };
+
+    extraction_job(std::string filename, extract_cb cb)
+        : ej_filename(std::move(filename)), ej_progress_cb(std::move(cb)),
+          ej_config(injector::get<const config&>())
+    {
+    }
+
+    void add_member(extracted_file ef, bool finished)
+    {
+        auto path = ef.ef_path;
+
+        this->ej_members.writeAccess()->insert_or_assign(
+            path, member{std::move(ef), finished});
+    }
+
+    void finish_member(const fs::path& path)
+    {
+        auto members = this->ej_members.writeAccess();
+        auto iter = members->find(path);
+
+        if (iter != members->end()) {
+            iter->second.m_finished = true;
+        }
+    }
+
+    /**
+     * @return The members that are done or have some content that can be
+     *   indexed.
+     */
+    std::vector<extracted_file> get_started_files() const
+    {
+        std::vector<extracted_file> retval;
+        auto members = this->ej_members.readAccess();
+
+        for (const auto& pair : *members) {
+            std::error_code ec;
+
+            if (pair.second.m_finished || fs::file_size(pair.first, ec) > 0) {
+                retval.emplace_back(pair.second.m_file);
+            }
+        }
+
+        return retval;
+    }
+
+    const std::string ej_filename;
+    const extract_cb ej_progress_cb;
+    const config ej_config;
+    std::atomic<bool> ej_cancelled{false};
+    safe::Safe<std::map<fs::path, member>> ej_members;
+    safe::Safe<std::vector<deferred_link>> ej_links;
+    std::shared_future<extract_result_t> ej_future;
+};
+
+struct job_registry {
+    static job_registry& singleton()
+    {
+        static job_registry retval;
+
+        return retval;
+    }
+
+    ~job_registry()
+    {
+        for (auto& pair : this->jr_jobs) {
+            pair.second->ej_cancelled = true;
+        }
+    }
+
+    std::mutex jr_mutex;
+    std::map<fs::path, std::shared_ptr<extraction_job>> jr_jobs;
+};
+
+template<typename W>
+static extract_result_t
+copy_data(const extraction_job& job,
           struct archive* ar,
           struct archive_entry* entry,
-          struct archive* aw,
           const fs::path& entry_path,
-          struct extract_progress* ep)
+          struct extract_progress* ep,
+          W write_block)
 {
     int r;
     const void* buff;
@@ -200,8 +311,11 @@ copy_data(const std::string& filename,
     la_int64_t offset;
 
     for (;;) {
+        if (job.ej_cancelled) {
+            return Err(CANCELLED_MSG);
+        }
         if (total >= next_space_check) {
-            const auto& cfg = injector::get<const config&>();
+            const auto& cfg = job.ej_config;
             auto tmp_space = fs::space(entry_path);
 
             if (tmp_space.available < cfg.amc_min_free_space) {
@@ -227,65 +341,278 @@ copy_data(const std::string& filename,
             return Err(fmt::format(
                 FMT_STRING("failed to extract '{}' from archive '{}' -- {}"),
                 archive_entry_pathname_utf8(entry),
-                filename,
+                job.ej_filename,
                 archive_error_string(ar)));
         }
-        r = archive_write_data_block(aw, buff, size, offset);
-        if (r != ARCHIVE_OK) {
-            return Err(fmt::format(FMT_STRING("failed to write file: {} -- {}"),
-                                   entry_path.string(),
-                                   archive_error_string(aw)));
-        }
+        TRY(write_block(buff, size, offset));
 
         total += size;
-        ep->ep_out_size.fetch_add(size);
+        if (ep != nullptr) {
+            ep->ep_out_size.fetch_add(size);
+        }
     }
 }
 
-static walk_result_t
-extract(const std::string& filename, const extract_cb& cb)
+/**
+ * Write a regular file from the archive to the cache as a gzip file so
+ * that it takes up less space on disk.  The line_buffer reads these files
+ * directly, so nothing else needs to be done to index them.
+ */
+static extract_result_t
+compress_entry(extraction_job& job,
+               struct archive* arc,
+               struct archive_entry* entry,
+               const fs::path& entry_path,
+               const fs::path& name,
+               struct extract_progress* ep)
 {
-    static const int FLAGS = ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_PERM
-        | ARCHIVE_EXTRACT_ACL | ARCHIVE_EXTRACT_FFLAGS;
-
+    auto gz_path = entry_path;
     std::error_code ec;
-    auto tmp_path = filename_to_tmp_path(filename);
 
-    fs::create_directories(tmp_path.parent_path(), ec);
+    gz_path += COMPRESSED_SUFFIX;
+    fs::create_directories(gz_path.parent_path(), ec);
     if (ec) {
         return Err(
             fmt::format(FMT_STRING("unable to create directory: {} -- {}"),
-                        tmp_path.parent_path().string(),
+                        gz_path.parent_path().string(),
                         ec.message()));
     }
 
-    auto arc_lock = lnav::filesystem::file_lock(tmp_path);
-    auto lock_guard = lnav::filesystem::file_lock::guard(&arc_lock);
-    auto done_path = tmp_path;
+    auto fd = lnav::filesystem::openp(
+        gz_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        return Err(fmt::format(FMT_STRING("unable to create file: {} -- {}"),
+                               gz_path.string(),
+                               strerror(errno)));
+    }
+    auto* gz = gzdopen(fd, "wb");
+    if (gz == nullptr) {
+        close(fd);
+        return Err(
+            fmt::format(FMT_STRING("unable to open gzip stream: {}"),
+                        gz_path.string()));
+    }
 
-    done_path += ".done";
+    auto copy_res = copy_data(
+        job,
+        arc,
+        entry,
+        gz_path,
+        ep,
+        [gz, &gz_path](const void* buff, size_t size, la_int64_t offset)
+            -> extract_result_t {
+            // Sparse files can skip ahead, gzseek() will fill in the gap
+            // with zeros.
+            if (offset != gztell(gz) && gzseek(gz, offset, SEEK_SET) == -1) {
+                return Err(
+                    fmt::format(FMT_STRING("failed to seek in file: {}"),
+                                gz_path.string()));
+            }
+            if (size > 0 && gzwrite(gz, buff, size) == 0) {
+                int errnum = 0;
 
-    if (fs::exists(done_path)) {
-        size_t file_count = 0;
-        if (fs::is_directory(tmp_path)) {
-            for (const auto& entry : fs::directory_iterator(tmp_path, ec)) {
-                (void) entry;
-                file_count += 1;
+                return Err(
+                    fmt::format(FMT_STRING("failed to write file: {} -- {}"),
+                                gz_path.string(),
+                                gzerror(gz, &errnum)));
             }
+            return Ok();
+        });
+    auto total = gztell(gz);
+    auto close_rc = gzclose(gz);
+    if (copy_res.isErr()) {
+        fs::remove(gz_path, ec);
+        return copy_res;
+    }
+    if (close_rc != Z_OK) {
+        fs::remove(gz_path, ec);
+        return Err(fmt::format(FMT_STRING("failed to write file: {}"),
+                               gz_path.string()));
+    }
+
+    if (total == 0) {
+        // Nothing to compress, so store a plain empty file instead of a
+        // gzip header that would be mistaken for content.
+        fs::remove(gz_path, ec);
+        lnav::filesystem::create_file(entry_path, O_WRONLY, 0600);
+        job.add_member(extracted_file{entry_path, name, true}, true);
+    } else {
+        job.add_member(extracted_file{gz_path, name, false}, true);
+    }
+
+    return Ok();
+}
+
+static extract_result_t
+extract_entry(extraction_job& job,
+              struct archive* arc,
+              struct archive_entry* entry,
+              struct archive* ext,
+              const fs::path& tmp_path)
+{
+    const auto& filename = job.ej_filename;
+    auto tmp_base = tmp_path.lexically_normal();
+    const auto* format_name = archive_format_name(arc);
+    auto filter_count = archive_filter_count(arc);
+
+    const auto* entry_path_str = archive_entry_pathname_utf8(entry);
+    if (entry_path_str == nullptr) {
+        return Ok();
+    }
+
+    auto_mem<archive_entry> wentry(archive_entry_free);
+    wentry = archive_entry_clone(entry);
+    auto desired_pathname = fs::path(entry_path_str).relative_path();
+    if (strcmp(format_name, "raw") == 0 && filter_count >= 2) {
+        desired_pathname = fs::path(filename).filename();
+    }
+    auto entry_path = (tmp_path / desired_pathname).lexically_normal();
+    auto rel = entry_path.lexically_relative(tmp_base);
+    if (rel.empty() || lnav::filesystem::contains_dotdot(rel)) {
+        log_warning("ignoring naughty path: %s", entry_path_str);
+        return Ok();
+    }
+    archive_entry_copy_pathname(wentry, entry_path.c_str());
+    auto entry_mode = archive_entry_mode(wentry);
+    auto is_plain_file = S_ISREG(entry_mode)
+        && archive_entry_hardlink(entry) == nullptr;
+    auto has_data
+        = !archive_entry_size_is_set(entry) || archive_entry_size(entry) > 0;
+
+    if (job.ej_config.amc_compress_cache && S_ISREG(entry_mode)
+        && !is_plain_file)
+    {
+        auto link_target = (tmp_path
+                            / fs::path(archive_entry_hardlink(entry))
+                                  .relative_path())
+                               .lexically_normal();
+        auto target_rel = link_target.lexically_relative(tmp_base);
+        if (target_rel.empty() || lnav::filesystem::contains_dotdot(target_rel))
+        {
+            log_warning("ignoring naughty hard link '%s' with target '%s'",
+                        entry_path_str,
+                        archive_entry_hardlink(entry));
+            return Ok();
         }
-        if (file_count > 0) {
-            auto now = fs::file_time_type::clock::now();
-            fs::last_write_time(done_path, now);
-            log_info("%s: archive has already been extracted!",
-                     done_path.c_str());
+        job.ej_links.writeAccess()->emplace_back(
+            extraction_job::deferred_link{entry_path, link_target, "", true});
+        return Ok();
+    }
+
+    auto prog = job.ej_progress_cb(
+        entry_path,
+        archive_entry_size_is_set(entry) ? archive_entry_size(entry) : -1);
+    if (job.ej_config.amc_compress_cache && is_plain_file && has_data) {
+        return compress_entry(job, arc, entry, entry_path, rel, prog.get());
+    }
+
+    archive_entry_set_perm(
+        wentry, S_IRUSR | (S_ISDIR(entry_mode) ? S_IXUSR | S_IWUSR : 0));
+    if (S_ISLNK(entry_mode)) {
+        auto* target_path_str = archive_entry_symlink(wentry);
+        if (target_path_str == nullptr) {
+            log_warning("symlink is null: %s", entry_path_str);
             return Ok();
         }
-        log_warning("%s: archive cache has been damaged, re-extracting",
-                    done_path.c_str());
+        auto link_target = fs::path(target_path_str);
+        auto resolved = link_target;
+        if (link_target.is_absolute()) {
+            // Confine to tmp_path: strip root, rejoin under tmp_path,
+            // then express as relative from the symlink's own directory.
+            auto confined
+                = (tmp_path / link_target.relative_path()).lexically_normal();
+            auto rewritten
+                = confined.lexically_relative(entry_path.parent_path());
+            if (rewritten.empty()) {
+                log_warning("ignoring symlink with unrepresentable target: %s",
+                            entry_path_str);
+                return Ok();
+            }
+            archive_entry_set_symlink(wentry, rewritten.c_str());
+            resolved = confined;
+        } else {
+            // Relative target: verify it lands inside tmp_base, but leave
+            // the literal target alone so kernel resolution matches.
+            resolved
+                = (entry_path.parent_path() / link_target).lexically_normal();
+            auto target_rel = resolved.lexically_relative(tmp_base);
+            if (target_rel.empty()
+                || lnav::filesystem::contains_dotdot(target_rel))
+            {
+                log_warning("ignoring naughty symlink '%s' with target '%s'",
+                            entry_path_str,
+                            target_path_str);
+                return Ok();
+            }
+        }
+        if (job.ej_config.amc_compress_cache) {
+            job.ej_links.writeAccess()->emplace_back(
+                extraction_job::deferred_link{
+                    entry_path, resolved, archive_entry_symlink(wentry)});
+            return Ok();
+        }
+    }
+    auto r = archive_write_header(ext, wentry);
+    if (r < ARCHIVE_OK) {
+        return Err(fmt::format(FMT_STRING("unable to write entry: {} -- {}"),
+                               entry_path.string(),
+                               archive_error_string(ext)));
+    }
 
-        fs::remove(done_path);
+    // The file exists on disk now, so it can start being indexed while
+    // the rest of it is written out.
+    if (is_plain_file) {
+        job.add_member(extracted_file{entry_path, rel, !has_data}, false);
+    }
+    if (has_data) {
+        TRY(copy_data(
+            job,
+            arc,
+            entry,
+            entry_path,
+            prog.get(),
+            [ext, &entry_path](const void* buff, size_t size, la_int64_t offset)
+                -> extract_result_t {
+                auto rc = archive_write_data_block(ext, buff, size, offset);
+                if (rc != ARCHIVE_OK) {
+                    return Err(fmt::format(
+                        FMT_STRING("failed to write file: {} -- {}"),
+                        entry_path.string(),
+                        archive_error_string(ext)));
+                }
+                return Ok();
+            }));
+    }
+    r = archive_write_finish_entry(ext);
+    if (r != ARCHIVE_OK) {
+        return Err(fmt::format(FMT_STRING("unable to finish entry: {} -- {}"),
+                               entry_path.string(),
+                               archive_error_string(ext)));
+    }
+    if (is_plain_file) {
+        job.finish_member(entry_path);
     }
 
+    return Ok();
+}
+
+/**
+ * Unpack the entries in the archive whose index modulo the worker count
+ * matches the given worker index.  The first worker decides whether the
+ * format allows members to be skipped cheaply and, if so, starts the other
+ * workers and returns their futures in the "helpers" vector.
+ */
+static extract_result_t
+extract_entries(extraction_job& job,
+                const fs::path& tmp_path,
+                size_t worker_index,
+                size_t worker_count,
+                std::vector<std::future<extract_result_t>>* helpers)
+{
+    static const int FLAGS = ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_PERM
+        | ARCHIVE_EXTRACT_ACL | ARCHIVE_EXTRACT_FFLAGS;
+
+    const auto& filename = job.ej_filename;
     auto_mem<archive> arc(archive_free);
     auto_mem<archive> ext(archive_free);
 
@@ -302,14 +629,11 @@ extract(const std::string& filename, const extract_cb& cb)
                                filename,
                                archive_error_string(arc)));
     }
-    auto tmp_base = tmp_path.lexically_normal();
 
-    log_info("extracting %s to %s", filename.c_str(), tmp_path.c_str());
-    while (true) {
+    for (size_t index = 0; !job.ej_cancelled; index++) {
         struct archive_entry* entry = nullptr;
         auto r = archive_read_next_header(arc, &entry);
         if (r == ARCHIVE_EOF) {
-            log_info("all done");
             break;
         }
         if (r != ARCHIVE_OK) {
@@ -319,115 +643,291 @@ extract(const std::string& filename, const extract_cb& cb)
                             archive_error_string(arc)));
         }
 
-        const auto* format_name = archive_format_name(arc);
-        auto filter_count = archive_filter_count(arc);
+        if (index == 0 && helpers != nullptr) {
+            // Members of a zip file are compressed independently and the
+            // central directory lets the reader jump over them, so they
+            // can be unpacked in parallel.  Other formats, like 7z with
+            // solid blocks, would have to decompress the data to skip it.
+            auto format = archive_format(arc) & ARCHIVE_FORMAT_BASE_MASK;
+            auto max_workers = std::min<size_t>(
+                MAX_EXTRACT_WORKERS, std::thread::hardware_concurrency());
+
+            if (format == ARCHIVE_FORMAT_ZIP && max_workers > 1) {
+                log_info("extracting %s with %zu workers",
+                         filename.c_str(),
+                         max_workers);
+                worker_count = max_workers;
+                for (size_t lpc = 1; lpc < worker_count; lpc++) {
+                    helpers->emplace_back(std::async(
+                        std::launch::async,
+                        [&job, tmp_path, lpc, worker_count]() {
+                            return extract_entries(
+                                job, tmp_path, lpc, worker_count, nullptr);
+                        }));
+                }
+            }
+        }
 
-        const auto* entry_path_str = archive_entry_pathname_utf8(entry);
-        if (entry_path_str == nullptr) {
+        if (index % worker_count != worker_index) {
             continue;
         }
 
-        auto_mem<archive_entry> wentry(archive_entry_free);
-        wentry = archive_entry_clone(entry);
-        auto desired_pathname = fs::path(entry_path_str).relative_path();
-        if (strcmp(format_name, "raw") == 0 && filter_count >= 2) {
-            desired_pathname = fs::path(filename).filename();
+        auto entry_res = extract_entry(job, arc, entry, ext, tmp_path);
+        if (entry_res.isErr()) {
+            return entry_res;
         }
-        auto entry_path = (tmp_path / desired_pathname).lexically_normal();
-        auto rel = entry_path.lexically_relative(tmp_base);
-        if (rel.empty() || lnav::filesystem::contains_dotdot(rel)) {
-            log_warning("ignoring naughty path: %s", entry_path_str);
-            continue;
-        }
-        auto* prog = cb(
-            entry_path,
-            archive_entry_size_is_set(entry) ? archive_entry_size(entry) : -1);
-        archive_entry_copy_pathname(wentry, entry_path.c_str());
-        auto entry_mode = archive_entry_mode(wentry);
-
-        archive_entry_set_perm(
-            wentry, S_IRUSR | (S_ISDIR(entry_mode) ? S_IXUSR | S_IWUSR : 0));
-        if (S_ISLNK(entry_mode)) {
-            auto* target_path_str = archive_entry_symlink(wentry);
-            if (target_path_str == nullptr) {
-                log_warning("symlink is null: %s", entry_path_str);
+    }
+    archive_read_close(arc);
+    archive_write_close(ext);
+
+    if (job.ej_cancelled) {
+        return Err(CANCELLED_MSG);
+    }
+
+    return Ok();
+}
+
+/**
+ * Create the links that were held back while extracting to a compressed
+ * cache.  If the target was compressed, the link is made to the compressed
+ * file and gets the same suffix so that it is listed as the same member.
+ */
+static void
+create_deferred_links(extraction_job& job)
+{
+    auto links = std::move(*job.ej_links.writeAccess());
+
+    // Keep going while progress is made since a link can point at another
+    // link that has not been created yet.
+    auto made_progress = true;
+    while (made_progress && !links.empty()) {
+        made_progress = false;
+        for (auto iter = links.begin(); iter != links.end();) {
+            std::error_code ec;
+            auto link_path = iter->dl_path;
+            auto target = iter->dl_target;
+            auto value = fs::path(iter->dl_value);
+            auto gz_target = target;
+
+            gz_target += COMPRESSED_SUFFIX;
+            if (fs::is_regular_file(gz_target, ec)) {
+                target = gz_target;
+                link_path += COMPRESSED_SUFFIX;
+                value += COMPRESSED_SUFFIX;
+            } else if (!fs::exists(target, ec)) {
+                ++iter;
                 continue;
             }
-            auto link_target = fs::path(target_path_str);
-            if (link_target.is_absolute()) {
-                // Confine to tmp_path: strip root, rejoin under tmp_path,
-                // then express as relative from the symlink's own directory.
-                auto confined = (tmp_path / link_target.relative_path())
-                                    .lexically_normal();
-                auto rewritten
-                    = confined.lexically_relative(entry_path.parent_path());
-                if (rewritten.empty()) {
-                    log_warning(
-                        "ignoring symlink with unrepresentable target: %s",
-                        entry_path_str);
-                    continue;
+
+            fs::create_directories(link_path.parent_path(), ec);
+            if (iter->dl_hard) {
+                fs::create_hard_link(target, link_path, ec);
+                if (ec) {
+                    ec.clear();
+                    fs::copy_file(target, link_path, ec);
                 }
-                archive_entry_set_symlink(wentry, rewritten.c_str());
             } else {
-                // Relative target: verify it lands inside tmp_base, but leave
-                // the literal target alone so kernel resolution matches.
-                auto resolved = (entry_path.parent_path() / link_target)
-                                    .lexically_normal();
-                auto target_rel = resolved.lexically_relative(tmp_base);
-                if (target_rel.empty()
-                    || lnav::filesystem::contains_dotdot(target_rel))
-                {
-                    log_warning(
-                        "ignoring naughty symlink '%s' with target '%s'",
-                        entry_path_str,
-                        target_path_str);
-                    continue;
-                }
+                fs::create_symlink(value, link_path, ec);
+            }
+            if (ec) {
+                log_warning("unable to create link: %s -> %s -- %s",
+                            link_path.c_str(),
+                            target.c_str(),
+                            ec.message().c_str());
             }
+            made_progress = true;
+            iter = links.erase(iter);
         }
-        r = archive_write_header(ext, wentry);
-        if (r < ARCHIVE_OK) {
-            return Err(
-                fmt::format(FMT_STRING("unable to write entry: {} -- {}"),
-                            entry_path.string(),
-                            archive_error_string(ext)));
+    }
+    for (const auto& dl : links) {
+        log_warning("ignoring link with missing target: %s -> %s",
+                    dl.dl_path.c_str(),
+                    dl.dl_target.c_str());
+    }
+}
+
+/**
+ * Check if the archive has already been fully unpacked into the cache.  The
+ * cache lock must be held by the caller.
+ */
+static bool
+check_extracted(const fs::path& tmp_path)
+{
+    auto done_path = tmp_path;
+
+    done_path += ".done";
+    if (!fs::exists(done_path)) {
+        return false;
+    }
+
+    std::error_code ec;
+    size_t file_count = 0;
+    if (fs::is_directory(tmp_path)) {
+        for (const auto& entry : fs::directory_iterator(tmp_path, ec)) {
+            (void) entry;
+            file_count += 1;
         }
+    }
+    if (file_count > 0) {
+        auto now = fs::file_time_type::clock::now();
+        fs::last_write_time(done_path, now);
+        log_info("%s: archive has already been extracted!", done_path.c_str());
+        return true;
+    }
+    log_warning("%s: archive cache has been damaged, re-extracting",
+                done_path.c_str());
 
-        if (!archive_entry_size_is_set(entry) || archive_entry_size(entry) > 0)
-        {
-            TRY(copy_data(filename, arc, entry, ext, entry_path, prog));
+    fs::remove(done_path);
+    return false;
+}
+
+static extract_result_t
+extract(extraction_job& job, const fs::path& tmp_path)
+{
+    static auto op = lnav_operation{"archive_extract"};
+    auto op_guard = lnav_opid_guard::internal(op);
+
+    std::error_code ec;
+
+    fs::create_directories(tmp_path.parent_path(), ec);
+    if (ec) {
+        return Err(
+            fmt::format(FMT_STRING("unable to create directory: {} -- {}"),
+                        tmp_path.parent_path().string(),
+                        ec.message()));
+    }
+
+    auto arc_lock = lnav::filesystem::file_lock(tmp_path);
+    auto lock_guard = lnav::filesystem::file_lock::guard(&arc_lock);
+
+    if (check_extracted(tmp_path)) {
+        return Ok();
+    }
+
+    log_info("extracting %s to %s", job.ej_filename.c_str(), tmp_path.c_str());
+
+    std::vector<std::future<extract_result_t>> helpers;
+    std::vector<extract_result_t> results;
+
+    results.emplace_back(extract_entries(job, tmp_path, 0, 1, &helpers));
+    if (results.back().isErr()) {
+        job.ej_cancelled = true;
+    }
+    for (auto& helper : helpers) {
+        results.emplace_back(helper.get());
+        if (results.back().isErr()) {
+            job.ej_cancelled = true;
         }
-        r = archive_write_finish_entry(ext);
-        if (r != ARCHIVE_OK) {
-            return Err(
-                fmt::format(FMT_STRING("unable to finish entry: {} -- {}"),
-                            entry_path.string(),
-                            archive_error_string(ext)));
+    }
+
+    std::optional<std::string> error;
+    for (auto& res : results) {
+        if (res.isOk()) {
+            continue;
+        }
+        // Prefer the error that caused the other workers to be cancelled.
+        auto msg = res.unwrapErr();
+        if (!error || (error.value() == CANCELLED_MSG && msg != CANCELLED_MSG))
+        {
+            error = msg;
         }
     }
-    archive_read_close(arc);
-    archive_write_close(ext);
+    if (error) {
+        return Err(error.value());
+    }
 
+    create_deferred_links(job);
+    log_info("finished extracting %s", job.ej_filename.c_str());
+    auto done_path = tmp_path;
+    done_path += ".done";
     lnav::filesystem::create_file(done_path, O_WRONLY, 0600);
 
     return Ok();
 }
+
+static extracted_file
+to_extracted_file(const fs::path& tmp_path, const fs::directory_entry& entry)
+{
+    extracted_file retval;
+    std::error_code ec;
+
+    retval.ef_path = entry.path();
+    retval.ef_name = fs::relative(entry.path(), tmp_path, ec);
+    auto name_str = retval.ef_name.string();
+    if (endswith(name_str, COMPRESSED_SUFFIX)) {
+        name_str.resize(name_str.size() - strlen(COMPRESSED_SUFFIX));
+        retval.ef_name = name_str;
+    }
+    retval.ef_empty = entry.file_size(ec) == 0;
+
+    return retval;
+}
 #endif
 
 walk_result_t
-walk_archive_files(
-    const std::string& filename,
-    const extract_cb& cb,
-    const std::function<void(const fs::path&, const fs::directory_entry&)>&
-        callback)
+walk_archive_files(const std::string& filename,
+                   const extract_cb& cb,
+                   const std::function<void(const extracted_file&)>& callback)
 {
 #if HAVE_ARCHIVE_H
     auto tmp_path = filename_to_tmp_path(filename);
+    auto& reg = job_registry::singleton();
+    std::shared_ptr<extraction_job> job;
+    auto done_path = tmp_path;
 
-    auto result = extract(filename, cb);
-    if (result.isErr()) {
-        fs::remove_all(tmp_path);
-        return result;
+    done_path += ".done";
+    {
+        std::lock_guard<std::mutex> lg(reg.jr_mutex);
+        auto iter = reg.jr_jobs.find(tmp_path);
+
+        if (iter != reg.jr_jobs.end()) {
+            job = iter->second;
+        } else {
+            auto extracted = false;
+
+            if (fs::exists(done_path)) {
+                auto arc_lock = lnav::filesystem::file_lock(tmp_path);
+                auto lock_guard
+                    = lnav::filesystem::file_lock::guard(&arc_lock);
+
+                extracted = check_extracted(tmp_path);
+            }
+            if (!extracted) {
+                job = std::make_shared<extraction_job>(filename, cb);
+                // The job outlives the thread since the future blocks in
+                // its destructor, so a plain pointer avoids a cycle.
+                job->ej_future = std::async(
+                    std::launch::async,
+                    [job_ptr = job.get(), tmp_path]() {
+                        return extract(*job_ptr, tmp_path);
+                    });
+                reg.jr_jobs.emplace(tmp_path, job);
+            }
+        }
+    }
+
+    if (job) {
+        if (job->ej_future.wait_for(std::chrono::seconds(0))
+            != std::future_status::ready)
+        {
+            for (const auto& ef : job->get_started_files()) {
+                callback(ef);
+            }
+            return Ok(walk_status_t::in_progress);
+        }
+
+        {
+            std::lock_guard<std::mutex> lg(reg.jr_mutex);
+
+            reg.jr_jobs.erase(tmp_path);
+        }
+        const auto& result = job->ej_future.get();
+        if (result.isErr()) {
+            std::error_code ec;
+
+            fs::remove_all(tmp_path, ec);
+            return Err(result.unwrapErr());
+        }
     }
 
     std::error_code ec;
@@ -436,7 +936,7 @@ walk_archive_files(
             continue;
         }
 
-        callback(tmp_path, entry);
+        callback(to_extracted_file(tmp_path, entry));
     }
     if (ec) {
         return Err(fmt::format(FMT_STRING("failed to walk temp dir: {} -- {}"),
@@ -444,12 +944,25 @@ walk_archive_files(
                                ec.message()));
     }
 
-    return Ok();
+    return Ok(walk_status_t::complete);
 #else
     return Err(std::string("not compiled with libarchive"));
 #endif
 }
 
+bool
+is_extracting()
+{
+#if HAVE_ARCHIVE_H
+    auto& reg = job_registry::singleton();
+    std::lock_guard<std::mutex> lg(reg.jr_mutex);
+
+    return !reg.jr_jobs.empty();
+#else
+    return false;
+#endif
+}
+
 std::future<void>
 cleanup_cache()
 {
@@ -36,6 +36,7 @@
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -56,8 +57,13 @@ struct extract_progress {
     std::atomic<size_t> ep_out_size{0};
 };
 
-using extract_cb
-    = std::function<extract_progress*(const std::filesystem::path&, ssize_t)>;
+/**
+ * Called when a file starts being unpacked from an archive.  The returned
+ * progress object is updated while the file is written and released once
+ * the file is done.  This can be called from several threads at once.
+ */
+using extract_cb = std::function<std::shared_ptr<extract_progress>(
+    const std::filesystem::path&, ssize_t)>;
 
 struct archive_info {
     struct entry {
@@ -78,21 +84,48 @@ Result<describe_result, std::string> describe(
 
 std::filesystem::path filename_to_tmp_path(const std::string& filename);
 
-using walk_result_t = Result<void, std::string>;
+/**
+ * A file that has been, or is being, unpacked from an archive.
+ */
+struct extracted_file {
+    /** The path to the file in the archive cache. */
+    std::filesystem::path ef_path;
+    /** The path of the file inside the archive. */
+    std::filesystem::path ef_name;
+    /** True if the file has no content. */
+    bool ef_empty{false};
+};
+
+enum class walk_status_t {
+    in_progress,
+    complete,
+};
+
+using walk_result_t = Result<walk_status_t, std::string>;
 
 /**
+ * Unpack an archive into the cache directory and pass the files in it to
+ * the given callback.  The archive is unpacked in the background so that
+ * the files can be indexed while they are being written.  Until the result
+ * is walk_status_t::complete, this function needs to be called again to
+ * pick up the files that have been started since the last call.  The
+ * callback can be passed the same file more than once.
  *
  * @feature f0:archive
  *
- * @param filename
- * @param cb
- * @return
+ * @param filename The path to the archive.
+ * @param cb The callback used to report the progress for each file.
+ * @return The status of the extraction or an error message.
  */
 walk_result_t walk_archive_files(
     const std::string& filename,
     const extract_cb& cb,
-    const std::function<void(const std::filesystem::path&,
-                             const std::filesystem::directory_entry&)>&);
+    const std::function<void(const extracted_file&)>&);
+
+/**
+ * @return True if any archives are still being unpacked.
+ */
+bool is_extracting();
 
 [[nodiscard]] std::future<void> cleanup_cache();
 
@@ -29,7 +29,10 @@
  * @file intern_string.cc
  */
 
+#include <cstddef>
+#include <memory>
 #include <mutex>
+#include <new>
 
 #include "intern_string.hh"
 
@@ -44,24 +47,147 @@
 #include "ww898/cp_utf8.hpp"
 #include "xxHash/xxhash.h"
 
-const static int TABLE_SIZE = 4095;
+namespace {
 
-struct intern_string::intern_table {
-    ~intern_table()
+/**
+ * Bump allocator for the interned strings.  The strings live as long as
+ * the table, so they are packed into large blocks instead of being
+ * allocated one at a time.
+ */
+class intern_arena {
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    void* allocate(size_t size)
     {
-        for (auto is : this->it_table) {
-            auto curr = is;
+        size = (size + alignof(std::max_align_t) - 1)
+            & ~(alignof(std::max_align_t) - 1);
+        if (size > BLOCK_SIZE / 4) {
+            this->ia_blocks.emplace_back(new char[size]);
+            return this->ia_blocks.back().get();
+        }
+        if (this->ia_blocks.empty() || this->ia_remaining < size) {
+            this->ia_blocks.emplace_back(new char[BLOCK_SIZE]);
+            this->ia_next = this->ia_blocks.back().get();
+            this->ia_remaining = BLOCK_SIZE;
+        }
+
+        auto* retval = this->ia_next;
+        this->ia_next += size;
+        this->ia_remaining -= size;
+        return retval;
+    }
+
+private:
+    std::vector<std::unique_ptr<char[]>> ia_blocks;
+    char* ia_next{nullptr};
+    size_t ia_remaining{0};
+};
+
+}  // namespace
+
+/**
+ * The table is split into shards that each have their own lock and
+ * bucket array.  Lookups of strings that are already interned do not
+ * take any locks, they only follow the bucket and chain pointers that
+ * are published with release stores.  Inserts lock the shard, check
+ * again, and then push the new string onto the head of its chain.  When
+ * a shard gets too full, its bucket array is doubled and the chains are
+ * relinked.  A reader racing with a resize might miss a string, but it
+ * will find it when it retries under the lock.  Strings are never freed
+ * and old bucket arrays are kept until the table is destroyed, so a
+ * reader can never follow a dangling pointer.
+ */
+struct intern_string::intern_table {
+    static constexpr size_t SHARD_BITS = 6;
+    static constexpr size_t SHARD_COUNT = 1UL << SHARD_BITS;
+    static constexpr size_t INITIAL_BUCKETS = 64;
+
+    struct bucket_array {
+        explicit bucket_array(size_t size)
+            : ba_mask(size - 1),
+              ba_heads(new std::atomic<intern_string*>[size])
+        {
+            for (size_t lpc = 0; lpc < size; lpc++) {
+                this->ba_heads[lpc].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<intern_string*>& head_for(unsigned long hash) const
+        {
+            return this->ba_heads[(hash >> SHARD_BITS) & this->ba_mask];
+        }
+
+        size_t ba_mask;
+        std::unique_ptr<std::atomic<intern_string*>[]> ba_heads;
+    };
+
+    struct shard {
+        shard()
+        {
+            this->s_arrays.emplace_back(
+                std::make_unique<bucket_array>(INITIAL_BUCKETS));
+            this->s_buckets.store(this->s_arrays.back().get(),
+                                  std::memory_order_release);
+        }
+
+        static intern_string* find(const bucket_array* ba,
+                                   unsigned long hash,
+                                   const char* str,
+                                   size_t len)
+        {
+            auto* curr = ba->head_for(hash).load(std::memory_order_acquire);
 
             while (curr != nullptr) {
-                auto next = curr->is_next;
+                if (curr->is_hash == hash && curr->is_size == len
+                    && memcmp(curr->is_str, str, len) == 0)
+                {
+                    return curr;
+                }
+                curr = curr->is_next.load(std::memory_order_acquire);
+            }
+
+            return nullptr;
+        }
+
+        void grow()
+        {
+            auto* old_ba = this->s_buckets.load(std::memory_order_relaxed);
+            auto new_ba
+                = std::make_unique<bucket_array>((old_ba->ba_mask + 1) * 2);
+
+            for (size_t lpc = 0; lpc <= old_ba->ba_mask; lpc++) {
+                auto* curr
+                    = old_ba->ba_heads[lpc].load(std::memory_order_relaxed);
+
+                while (curr != nullptr) {
+                    auto* next = curr->is_next.load(std::memory_order_relaxed);
+                    auto& head = new_ba->head_for(curr->is_hash);
 
-                delete curr;
-                curr = next;
+                    curr->is_next.store(head.load(std::memory_order_relaxed),
+                                        std::memory_order_release);
+                    head.store(curr, std::memory_order_release);
+                    curr = next;
+                }
             }
+
+            this->s_buckets.store(new_ba.get(), std::memory_order_release);
+            this->s_arrays.emplace_back(std::move(new_ba));
         }
+
+        std::atomic<bucket_array*> s_buckets{nullptr};
+        std::mutex s_mutex;
+        size_t s_count{0};
+        std::vector<std::unique_ptr<bucket_array>> s_arrays;
+        intern_arena s_arena;
+    };
+
+    shard& shard_for(unsigned long hash)
+    {
+        return this->it_shards[hash & (SHARD_COUNT - 1)];
     }
 
-    intern_string* it_table[TABLE_SIZE];
+    shard it_shards[SHARD_COUNT];
 };
 
 intern_table_lifetime
@@ -81,36 +207,45 @@ hash_str(const char* str, size_t len)
 const intern_string*
 intern_string::lookup(const char* str, ssize_t len) noexcept
 {
-    unsigned long h;
-    intern_string* curr;
-
     if (len == -1) {
         len = strlen(str);
     }
-    h = hash_str(str, len) % TABLE_SIZE;
 
-    {
-        static std::mutex table_mutex;
+    static auto* tab = get_table_lifetime().get();
+    auto h = hash_str(str, len);
+    auto& sh = tab->shard_for(h);
+    auto* retval = intern_table::shard::find(
+        sh.s_buckets.load(std::memory_order_acquire), h, str, len);
 
-        std::lock_guard<std::mutex> lk(table_mutex);
-        auto tab = get_table_lifetime();
+    if (retval != nullptr) {
+        return retval;
+    }
 
-        curr = tab->it_table[h];
-        while (curr != nullptr) {
-            if (static_cast<ssize_t>(curr->is_str.size()) == len
-                && strncmp(curr->is_str.c_str(), str, len) == 0)
-            {
-                return curr;
-            }
-            curr = curr->is_next;
-        }
+    std::lock_guard<std::mutex> lk(sh.s_mutex);
+    auto* ba = sh.s_buckets.load(std::memory_order_relaxed);
 
-        curr = new intern_string(str, len);
-        curr->is_next = tab->it_table[h];
-        tab->it_table[h] = curr;
+    retval = intern_table::shard::find(ba, h, str, len);
+    if (retval != nullptr) {
+        return retval;
+    }
+
+    auto* mem = sh.s_arena.allocate(sizeof(intern_string) + len + 1);
+    auto* str_copy = static_cast<char*>(mem) + sizeof(intern_string);
 
-        return curr;
+    memcpy(str_copy, str, len);
+    str_copy[len] = '\0';
+    retval = new (mem) intern_string(str_copy, len, h);
+
+    auto& head = ba->head_for(h);
+    retval->is_next.store(head.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    head.store(retval, std::memory_order_release);
+    sh.s_count += 1;
+    if (sh.s_count > ba->ba_mask + 1) {
+        sh.grow();
     }
+
+    return retval;
 }
 
 const intern_string*
@@ -128,7 +263,7 @@ intern_string::lookup(const std::string& str) noexcept
 bool
 intern_string::startswith(const char* prefix) const
 {
-    const char* curr = this->is_str.data();
+    const char* curr = this->is_str;
 
     while (*prefix != '\0' && *prefix == *curr) {
         prefix += 1;
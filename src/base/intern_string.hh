@@ -32,6 +32,7 @@
 #ifndef intern_string_hh
 #define intern_string_hh
 
+#include <atomic>
 #include <functional>
 #include <optional>
 #include <ostream>
@@ -872,17 +873,20 @@ public:
 
     static const intern_string* lookup(const std::string& str) noexcept;
 
-    const char* get() const { return this->is_str.c_str(); };
+    const char* get() const { return this->is_str; };
 
-    const char* data() const { return this->is_str.c_str(); };
+    const char* data() const { return this->is_str; };
 
-    size_t size() const { return this->is_str.size(); }
+    size_t size() const { return this->is_size; }
 
-    std::string to_string() const { return this->is_str; }
+    std::string to_string() const
+    {
+        return std::string(this->is_str, this->is_size);
+    }
 
     string_fragment to_string_fragment() const
     {
-        return string_fragment{this->is_str};
+        return string_fragment::from_bytes(this->is_str, this->is_size);
     }
 
     bool startswith(const char* prefix) const;
@@ -893,13 +897,21 @@ public:
 private:
     friend intern_table;
 
-    intern_string(const char* str, ssize_t len)
-        : is_next(nullptr), is_str(str, (size_t) len)
+    intern_string(const char* str, size_t len, unsigned long hash)
+        : is_hash(hash), is_size(len), is_str(str)
     {
     }
 
-    intern_string* is_next;
-    std::string is_str;
+    /**
+     * The next string in the hash chain.  Readers follow this link without
+     * holding a lock, so it is only modified while the table shard is
+     * locked and always points at a live string or nullptr.
+     */
+    std::atomic<intern_string*> is_next{nullptr};
+    unsigned long is_hash;
+    size_t is_size;
+    /** The NUL-terminated copy of the string in the table's arena. */
+    const char* is_str;
 };
 
 using intern_table_lifetime = std::shared_ptr<intern_string::intern_table>;
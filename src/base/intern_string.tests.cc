@@ -29,12 +29,56 @@
 
 #include <cctype>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "intern_string.hh"
 
 #include "config.h"
 #include "doctest/doctest.h"
 
+TEST_CASE("intern_string::lookup")
+{
+    const auto* is1 = intern_string::lookup("abc", -1);
+    const auto* is2 = intern_string::lookup(std::string("abc"));
+
+    CHECK(is1 == is2);
+    CHECK(is1->to_string() == "abc");
+    CHECK(is1->get()[is1->size()] == '\0');
+    CHECK(intern_string::lookup("abcd", 3) == is1);
+    CHECK(intern_string::lookup("", 0)->size() == 0);
+}
+
+TEST_CASE("intern_string::lookup concurrent")
+{
+    static constexpr int THREADS = 4;
+    static constexpr int KEYS = 20000;
+
+    std::vector<std::vector<const intern_string*>> results(THREADS);
+    std::vector<std::thread> threads;
+
+    for (int tid = 0; tid < THREADS; tid++) {
+        threads.emplace_back([tid, &results]() {
+            for (int lpc = 0; lpc < KEYS; lpc++) {
+                auto key = "concurrent-" + std::to_string(lpc);
+
+                results[tid].emplace_back(intern_string::lookup(key));
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    for (int tid = 1; tid < THREADS; tid++) {
+        CHECK(results[tid] == results[0]);
+    }
+    for (int lpc = 0; lpc < KEYS; lpc++) {
+        CHECK(results[0][lpc]->to_string()
+              == "concurrent-" + std::to_string(lpc));
+    }
+}
+
 TEST_CASE("string_fragment::startswith")
 {
     std::string empty;
@@ -212,6 +212,75 @@ get_pid_str()
     return buffer;
 }
 
+static std::atomic<const lnav_operation*> lnav_operation_head{nullptr};
+
+lnav_operation::lnav_operation(const char* name) : lo_name(name)
+{
+    auto* next = lnav_operation_head.load();
+
+    do {
+        this->lo_next = next;
+    } while (!lnav_operation_head.compare_exchange_weak(next, this));
+}
+
+const lnav_operation*
+lnav_operation::head()
+{
+    return lnav_operation_head.load();
+}
+
+void
+lnav_operation::record(std::chrono::microseconds duration)
+{
+    uint64_t us = std::max(duration.count(), int64_t{0});
+    size_t index = 0;
+
+    while (index < HISTOGRAM_SIZE - 1 && (1ULL << index) <= us) {
+        index += 1;
+    }
+    this->lo_histogram[index].fetch_add(1, std::memory_order_relaxed);
+    this->lo_total_us.fetch_add(us, std::memory_order_relaxed);
+
+    auto max_us = this->lo_max_us.load(std::memory_order_relaxed);
+    while (max_us < us
+           && !this->lo_max_us.compare_exchange_weak(
+               max_us, us, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t
+lnav_operation::completed() const
+{
+    uint64_t retval = 0;
+
+    for (const auto& bucket : this->lo_histogram) {
+        retval += bucket.load(std::memory_order_relaxed);
+    }
+
+    return retval;
+}
+
+uint64_t
+lnav_operation::percentile(double fraction) const
+{
+    const auto total = this->completed();
+    const auto max_us = this->lo_max_us.load(std::memory_order_relaxed);
+    uint64_t seen = 0;
+
+    if (total == 0) {
+        return 0;
+    }
+    for (size_t index = 0; index < HISTOGRAM_SIZE; index++) {
+        seen += this->lo_histogram[index].load(std::memory_order_relaxed);
+        if (seen >= fraction * total) {
+            return std::min(uint64_t{1} << index, max_us);
+        }
+    }
+
+    return max_us;
+}
+
 lnav_opid_guard::lnav_opid_guard() : log_opid_size(lnav_opid.size())
 {
     static const auto* PID_STR = get_pid_str();
@@ -239,6 +308,8 @@ lnav_opid_guard::internal(lnav_operation& op)
     lnav_opid.push_back('-');
     auto count = op.lo_count.fetch_add(1, std::memory_order_relaxed);
     fmt::format_to(std::back_inserter(lnav_opid), FMT_STRING("{}"), count);
+    retval.log_operation = &op;
+    retval.log_start_time = std::chrono::steady_clock::now();
 
     return retval;
 }
@@ -305,6 +376,11 @@ lnav_opid_guard::unique()
 lnav_opid_guard::~lnav_opid_guard()
 {
     if (this->log_guard_helper.gh_enabled) {
+        if (this->log_operation != nullptr) {
+            this->log_operation->record(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - this->log_start_time));
+        }
         if (this->log_orig_opid.empty()) {
             lnav_opid.resize(this->log_opid_size);
         } else {
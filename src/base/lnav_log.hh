@@ -32,7 +32,9 @@
 #ifndef lnav_log_hh
 #define lnav_log_hh
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -123,11 +125,42 @@ struct log_crash_recoverer {
     virtual void log_crash_recover() = 0;
 };
 
+/**
+ * A named operation that is tracked in the debug log.  Each guarded run of
+ * the operation is also timed and recorded in a histogram so that slow
+ * operations can be found without a debug build.  Operations are expected
+ * to be static and they are linked into a list when constructed.
+ */
 struct lnav_operation {
-    lnav_operation(const char* name) : lo_name(name) {}
+    /** The number of power-of-two buckets in the duration histogram. */
+    static constexpr size_t HISTOGRAM_SIZE = 28;
+
+    lnav_operation(const char* name);
+
+    lnav_operation(const lnav_operation&) = delete;
+    lnav_operation& operator=(const lnav_operation&) = delete;
+
+    /** @return The first of all the operations that have been created. */
+    static const lnav_operation* head();
+
+    void record(std::chrono::microseconds duration);
+
+    /** @return The number of completed runs of the operation. */
+    uint64_t completed() const;
+
+    /**
+     * @return An estimate of the duration, in microseconds, that the given
+     * fraction of the completed runs finished within.
+     */
+    uint64_t percentile(double fraction) const;
 
     const char* lo_name;
     std::atomic_int32_t lo_count{0};
+    /** Bucket N holds the runs that took less than 2^N microseconds. */
+    std::array<std::atomic_uint32_t, HISTOGRAM_SIZE> lo_histogram{};
+    std::atomic_uint64_t lo_total_us{0};
+    std::atomic_uint64_t lo_max_us{0};
+    const lnav_operation* lo_next{nullptr};
 };
 
 struct lnav_opid_guard {
@@ -139,13 +172,17 @@ struct lnav_opid_guard {
 
     lnav_opid_guard(lnav_opid_guard&& other) noexcept
         : log_opid_size(other.log_opid_size),
-          log_guard_helper(std::move(other.log_guard_helper))
+          log_guard_helper(std::move(other.log_guard_helper)),
+          log_operation(other.log_operation),
+          log_start_time(other.log_start_time)
     {
     }
     lnav_opid_guard& operator=(lnav_opid_guard&& other) noexcept
     {
         this->log_opid_size = other.log_opid_size;
         this->log_guard_helper = std::move(other.log_guard_helper);
+        this->log_operation = other.log_operation;
+        this->log_start_time = other.log_start_time;
         return *this;
     }
 
@@ -160,6 +197,8 @@ private:
     size_t log_opid_size;
     lnav::guard_helper log_guard_helper;
     std::string log_orig_opid;
+    lnav_operation* log_operation{nullptr};
+    std::chrono::steady_clock::time_point log_start_time;
 };
 
 extern std::optional<FILE*> lnav_log_file;
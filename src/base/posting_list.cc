@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "posting_list.hh"
+
+namespace lnav {
+
+bool
+posting_list::push_back(uint32_t value)
+{
+    if (this->pl_count > 0 && value <= this->pl_last) {
+        return false;
+    }
+
+    auto delta = value - this->pl_last;
+    while (delta >= 0x80) {
+        this->pl_bytes.push_back((delta & 0x7f) | 0x80);
+        delta >>= 7;
+    }
+    this->pl_bytes.push_back(delta);
+    this->pl_count += 1;
+    this->pl_last = value;
+
+    return true;
+}
+
+void
+posting_list::append(const posting_list& other)
+{
+    if (this->empty()) {
+        *this = other;
+        return;
+    }
+
+    other.for_each([this](uint32_t value) { this->push_back(value); });
+}
+
+std::vector<uint32_t>
+posting_list::to_vector() const
+{
+    std::vector<uint32_t> retval;
+
+    retval.reserve(this->pl_count);
+    this->for_each([&retval](uint32_t value) { retval.push_back(value); });
+
+    return retval;
+}
+
+std::optional<posting_list>
+posting_list::from_bytes(string_fragment bytes)
+{
+    posting_list retval;
+    uint64_t value = 0;
+    uint64_t delta = 0;
+    int shift = 0;
+
+    for (const auto ch : bytes) {
+        const auto byte = (unsigned char) ch;
+
+        if (shift > 28) {
+            return std::nullopt;
+        }
+        delta |= (uint64_t) (byte & 0x7f) << shift;
+        if (byte & 0x80) {
+            shift += 7;
+            continue;
+        }
+        if ((retval.pl_count > 0 && delta == 0)
+            || value + delta > UINT32_MAX)
+        {
+            return std::nullopt;
+        }
+        value += delta;
+        retval.pl_count += 1;
+        delta = 0;
+        shift = 0;
+    }
+    if (shift != 0) {
+        return std::nullopt;
+    }
+
+    retval.pl_bytes.assign(bytes.udata(), bytes.udata() + bytes.length());
+    retval.pl_last = value;
+
+    return retval;
+}
+
+}  // namespace lnav
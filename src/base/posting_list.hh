@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef lnav_posting_list_hh_
+#define lnav_posting_list_hh_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "intern_string.hh"
+
+namespace lnav {
+
+/**
+ * An increasing list of integers, like line numbers, that is stored as
+ * variable-length deltas.  Values that are close together take a byte
+ * each, so a list of the lines for an opid or thread ID stays small.
+ */
+class posting_list {
+public:
+    /**
+     * Append a value to the list.
+     *
+     * @param value The value, which must be greater than the last one.
+     * @return True if the value was added, false if it was not greater
+     *   than the last value in the list.
+     */
+    bool push_back(uint32_t value);
+
+    void append(const posting_list& other);
+
+    size_t size() const { return this->pl_count; }
+
+    bool empty() const { return this->pl_count == 0; }
+
+    uint32_t back() const { return this->pl_last; }
+
+    template<typename F>
+    void for_each(F func) const
+    {
+        uint32_t value = 0;
+        uint32_t delta = 0;
+        int shift = 0;
+
+        for (const auto byte : this->pl_bytes) {
+            delta |= (uint32_t) (byte & 0x7f) << shift;
+            if (byte & 0x80) {
+                shift += 7;
+                continue;
+            }
+            value += delta;
+            func(value);
+            delta = 0;
+            shift = 0;
+        }
+    }
+
+    std::vector<uint32_t> to_vector() const;
+
+    /** The encoded form of the list, for serializing. */
+    string_fragment to_bytes() const
+    {
+        return string_fragment::from_bytes(this->pl_bytes.data(),
+                                           this->pl_bytes.size());
+    }
+
+    /**
+     * Rebuild a list from the output of to_bytes().
+     *
+     * @return The list or nullopt if the encoding is not valid.
+     */
+    static std::optional<posting_list> from_bytes(string_fragment bytes);
+
+    size_t memory_size() const { return this->pl_bytes.capacity(); }
+
+    void clear()
+    {
+        this->pl_bytes.clear();
+        this->pl_count = 0;
+        this->pl_last = 0;
+    }
+
+private:
+    std::vector<unsigned char> pl_bytes;
+    uint32_t pl_count{0};
+    uint32_t pl_last{0};
+};
+
+}  // namespace lnav
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "posting_list.hh"
+
+#include "doctest/doctest.h"
+
+TEST_CASE("posting_list empty")
+{
+    lnav::posting_list pl;
+
+    CHECK(pl.empty());
+    CHECK(pl.to_vector().empty());
+    CHECK(pl.to_bytes().empty());
+}
+
+TEST_CASE("posting_list round trip")
+{
+    const std::vector<uint32_t> expected = {
+        0, 1, 2, 127, 128, 300, 16384, 70000, 1U << 28, UINT32_MAX};
+    lnav::posting_list pl;
+
+    for (const auto value : expected) {
+        CHECK(pl.push_back(value));
+    }
+    CHECK(pl.size() == expected.size());
+    CHECK(pl.back() == UINT32_MAX);
+    CHECK(pl.to_vector() == expected);
+
+    auto copy = lnav::posting_list::from_bytes(pl.to_bytes());
+    REQUIRE(copy.has_value());
+    CHECK(copy->size() == expected.size());
+    CHECK(copy->back() == UINT32_MAX);
+    CHECK(copy->to_vector() == expected);
+}
+
+TEST_CASE("posting_list rejects out of order")
+{
+    lnav::posting_list pl;
+
+    CHECK(pl.push_back(10));
+    CHECK_FALSE(pl.push_back(10));
+    CHECK_FALSE(pl.push_back(5));
+    CHECK(pl.push_back(11));
+    CHECK(pl.to_vector() == std::vector<uint32_t>{10, 11});
+}
+
+TEST_CASE("posting_list append")
+{
+    lnav::posting_list pl1;
+    lnav::posting_list pl2;
+
+    pl1.push_back(1);
+    pl1.push_back(5);
+    pl2.push_back(5);
+    pl2.push_back(200);
+    pl1.append(pl2);
+    CHECK(pl1.to_vector() == std::vector<uint32_t>{1, 5, 200});
+}
+
+TEST_CASE("posting_list invalid bytes")
+{
+    static const unsigned char TRUNCATED[] = {0x80};
+    static const unsigned char DUPLICATE[] = {0x01, 0x00};
+
+    CHECK_FALSE(lnav::posting_list::from_bytes(
+                    string_fragment::from_bytes(TRUNCATED, sizeof(TRUNCATED)))
+                    .has_value());
+    CHECK_FALSE(lnav::posting_list::from_bytes(
+                    string_fragment::from_bytes(DUPLICATE, sizeof(DUPLICATE)))
+                    .has_value());
+}
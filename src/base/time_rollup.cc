@@ -0,0 +1,299 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "time_rollup.hh"
+
+namespace lnav {
+
+namespace {
+
+using namespace std::chrono_literals;
+
+const std::chrono::microseconds LEVEL_WIDTHS[] = {
+    1min,
+    5min,
+    15min,
+    1h,
+    4h,
+    8h,
+    24h,
+};
+
+int64_t
+bucket_key(std::chrono::microseconds time, std::chrono::microseconds width)
+{
+    auto retval = time.count() / width.count();
+
+    if (time.count() < 0 && time.count() % width.count() != 0) {
+        retval -= 1;
+    }
+    return retval;
+}
+
+}  // namespace
+
+void
+time_rollup::summary::add_value(double value)
+{
+    this->s_count += 1;
+    this->s_min = std::min(this->s_min, value);
+    this->s_max = std::max(this->s_max, value);
+    this->s_sum += value;
+
+    for (auto& cent : this->s_centroids) {
+        if (cent.c_mean == value) {
+            cent.c_weight += 1;
+            return;
+        }
+    }
+    this->s_centroids.emplace_back(centroid{value, 1});
+    if (this->s_centroids.size() > MAX_CENTROIDS * 2) {
+        this->compress();
+    }
+}
+
+void
+time_rollup::summary::merge(const summary& other)
+{
+    if (other.s_count == 0) {
+        return;
+    }
+
+    this->s_count += other.s_count;
+    this->s_min = std::min(this->s_min, other.s_min);
+    this->s_max = std::max(this->s_max, other.s_max);
+    this->s_sum += other.s_sum;
+    this->s_exact = this->s_exact && other.s_exact;
+    for (const auto& cent : other.s_centroids) {
+        auto iter = std::find_if(
+            this->s_centroids.begin(),
+            this->s_centroids.end(),
+            [&cent](const auto& lhs) { return lhs.c_mean == cent.c_mean; });
+
+        if (iter != this->s_centroids.end()) {
+            iter->c_weight += cent.c_weight;
+        } else {
+            this->s_centroids.emplace_back(cent);
+        }
+    }
+    if (this->s_centroids.size() > MAX_CENTROIDS * 2) {
+        this->compress();
+    }
+}
+
+void
+time_rollup::summary::compress()
+{
+    // Merge neighboring centroids into groups of roughly equal weight,
+    // which keeps the shape of the distribution while bounding the size.
+    std::sort(this->s_centroids.begin(),
+              this->s_centroids.end(),
+              [](const auto& lhs, const auto& rhs) {
+                  return lhs.c_mean < rhs.c_mean;
+              });
+
+    uint64_t total_weight = 0;
+    for (const auto& cent : this->s_centroids) {
+        total_weight += cent.c_weight;
+    }
+
+    std::vector<centroid> merged;
+    merged.reserve(MAX_CENTROIDS);
+    auto group_weight = uint64_t{0};
+    auto group_sum = 0.0;
+    auto seen_weight = uint64_t{0};
+    for (const auto& cent : this->s_centroids) {
+        group_weight += cent.c_weight;
+        group_sum += cent.c_mean * cent.c_weight;
+        seen_weight += cent.c_weight;
+        if (seen_weight * MAX_CENTROIDS
+            >= total_weight * (merged.size() + 1))
+        {
+            merged.emplace_back(
+                centroid{group_sum / group_weight, group_weight});
+            group_weight = 0;
+            group_sum = 0.0;
+        }
+    }
+    if (group_weight > 0) {
+        merged.emplace_back(centroid{group_sum / group_weight, group_weight});
+    }
+    this->s_centroids = std::move(merged);
+    this->s_exact = false;
+}
+
+time_rollup::time_rollup()
+{
+    this->clear();
+}
+
+void
+time_rollup::add_value(std::chrono::microseconds time, double value)
+{
+    auto& finest = this->tr_levels.front();
+    auto key = bucket_key(time, finest.l_width);
+
+    this->tr_count += 1;
+    // Values mostly arrive in time order, so check the last bucket before
+    // doing a lookup.
+    if (!finest.l_buckets.empty() && finest.l_buckets.rbegin()->first == key)
+    {
+        finest.l_buckets.rbegin()->second.add_value(value);
+    } else {
+        finest.l_buckets[key].add_value(value);
+    }
+    this->tr_dirty_from = std::min(this->tr_dirty_from, finest.l_width * key);
+
+    if (finest.l_buckets.size() > MAX_FINEST_BUCKETS
+        && this->tr_levels.size() > 1)
+    {
+        this->drop_finest_level();
+    }
+}
+
+void
+time_rollup::update_levels() const
+{
+    if (this->tr_dirty_from == std::chrono::microseconds::max()) {
+        return;
+    }
+
+    // Each level is rebuilt from the one below it, starting at the bucket
+    // that holds the earliest change.  Since values mostly arrive in time
+    // order, that is only a handful of merges per level.
+    for (size_t lpc = 1; lpc < this->tr_levels.size(); lpc++) {
+        const auto& lower = this->tr_levels[lpc - 1];
+        auto& lvl = this->tr_levels[lpc];
+        auto first_key = bucket_key(this->tr_dirty_from, lvl.l_width);
+
+        lvl.l_buckets.erase(lvl.l_buckets.lower_bound(first_key),
+                            lvl.l_buckets.end());
+        for (auto iter = lower.l_buckets.lower_bound(
+                 bucket_key(lvl.l_width * first_key, lower.l_width));
+             iter != lower.l_buckets.end();
+             ++iter)
+        {
+            auto key = bucket_key(lower.l_width * iter->first, lvl.l_width);
+
+            lvl.l_buckets[key].merge(iter->second);
+        }
+    }
+    this->tr_dirty_from = std::chrono::microseconds::max();
+}
+
+void
+time_rollup::drop_finest_level()
+{
+    this->update_levels();
+    this->tr_levels.erase(this->tr_levels.begin());
+}
+
+bool
+time_rollup::can_summarize(std::chrono::microseconds begin,
+                           std::chrono::microseconds end) const
+{
+    const auto finest = this->tr_levels.front().l_width.count();
+
+    return begin < end && begin.count() % finest == 0
+        && end.count() % finest == 0;
+}
+
+time_rollup::summary
+time_rollup::summarize(std::chrono::microseconds begin,
+                       std::chrono::microseconds end) const
+{
+    summary retval;
+    auto curr = begin;
+
+    this->update_levels();
+    while (curr < end) {
+        // Use the coarsest bucket that starts here and fits in the range.
+        const auto* best = &this->tr_levels.front();
+        for (const auto& lvl : this->tr_levels) {
+            if (curr.count() % lvl.l_width.count() == 0
+                && curr + lvl.l_width <= end)
+            {
+                best = &lvl;
+            }
+        }
+
+        auto key = bucket_key(curr, best->l_width);
+        auto iter = best->l_buckets.lower_bound(key);
+        if (iter == best->l_buckets.end()) {
+            break;
+        }
+        if (iter->first == key) {
+            retval.merge(iter->second);
+            curr += best->l_width;
+        } else {
+            // Skip ahead over the empty buckets to the next one with data,
+            // staying aligned to the finest level.
+            auto next = std::min(end, best->l_width * iter->first);
+            const auto finest = this->tr_levels.front().l_width;
+
+            next = finest * bucket_key(next, finest);
+            curr = std::max(curr + finest, next);
+        }
+    }
+
+    return retval;
+}
+
+void
+time_rollup::for_each_finest(
+    std::chrono::microseconds begin,
+    std::chrono::microseconds end,
+    const std::function<void(const summary&)>& func) const
+{
+    const auto& finest = this->tr_levels.front();
+    auto end_key = bucket_key(end, finest.l_width);
+
+    for (auto iter
+         = finest.l_buckets.lower_bound(bucket_key(begin, finest.l_width));
+         iter != finest.l_buckets.end() && iter->first < end_key;
+         ++iter)
+    {
+        func(iter->second);
+    }
+}
+
+void
+time_rollup::clear()
+{
+    this->tr_levels.clear();
+    for (const auto width : LEVEL_WIDTHS) {
+        this->tr_levels.emplace_back(width);
+    }
+    this->tr_dirty_from = std::chrono::microseconds::max();
+    this->tr_count = 0;
+}
+
+}  // namespace lnav
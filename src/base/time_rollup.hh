@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef lnav_time_rollup_hh_
+#define lnav_time_rollup_hh_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace lnav {
+
+/**
+ * Aggregates of a numeric value over fixed-width time buckets at several
+ * resolutions.  The width of each level is a multiple of the one below
+ * it, like a segment tree, so a time range can be summarized from a few
+ * coarse buckets with finer ones at the edges instead of visiting every
+ * value in the range.
+ *
+ * Values are only added to the finest level, the coarser levels are
+ * brought up-to-date from the ones below them when a summary is needed.
+ * Once the finest level has too many buckets, it is dropped and the next
+ * level becomes the finest.
+ */
+class time_rollup {
+public:
+    /** The maximum number of centroids kept in a summary's digest. */
+    static constexpr size_t MAX_CENTROIDS = 32;
+
+    /** The maximum number of buckets kept in the finest level. */
+    static constexpr size_t MAX_FINEST_BUCKETS = 8 * 1024;
+
+    struct centroid {
+        double c_mean;
+        uint64_t c_weight;
+    };
+
+    /**
+     * The count, range, and sum of a set of values, along with a small
+     * mergeable digest of their distribution.  The digest is exact until
+     * there are more than MAX_CENTROIDS * 2 distinct values.
+     */
+    struct summary {
+        void add_value(double value);
+
+        void merge(const summary& other);
+
+        uint64_t s_count{0};
+        double s_min{std::numeric_limits<double>::max()};
+        double s_max{std::numeric_limits<double>::lowest()};
+        double s_sum{0.0};
+        std::vector<centroid> s_centroids;
+        /**
+         * True if each centroid is a distinct value and its weight is the
+         * number of times the value was seen.
+         */
+        bool s_exact{true};
+
+    private:
+        void compress();
+    };
+
+    time_rollup();
+
+    time_rollup(const time_rollup&) = delete;
+    time_rollup& operator=(const time_rollup&) = delete;
+    time_rollup(time_rollup&&) = default;
+    time_rollup& operator=(time_rollup&&) = default;
+
+    void add_value(std::chrono::microseconds time, double value);
+
+    /**
+     * @return True if the range lines up with the finest buckets and can
+     *   be passed to summarize().
+     */
+    bool can_summarize(std::chrono::microseconds begin,
+                       std::chrono::microseconds end) const;
+
+    summary summarize(std::chrono::microseconds begin,
+                      std::chrono::microseconds end) const;
+
+    /**
+     * Call the given function with each non-empty bucket of the finest
+     * level in the range.  The buckets are not merged like they are in
+     * summarize(), so their digests stay exact for longer.
+     */
+    void for_each_finest(
+        std::chrono::microseconds begin,
+        std::chrono::microseconds end,
+        const std::function<void(const summary&)>& func) const;
+
+    /** The number of values added to the rollup. */
+    uint64_t count() const { return this->tr_count; }
+
+    /** The width of the buckets in the finest level. */
+    std::chrono::microseconds finest_width() const
+    {
+        return this->tr_levels.front().l_width;
+    }
+
+    void clear();
+
+private:
+    struct level {
+        explicit level(std::chrono::microseconds width) : l_width(width) {}
+
+        std::chrono::microseconds l_width;
+        std::map<int64_t, summary> l_buckets;
+    };
+
+    void update_levels() const;
+
+    void drop_finest_level();
+
+    mutable std::vector<level> tr_levels;
+    /** The start of the earliest finest bucket changed since the update. */
+    mutable std::chrono::microseconds tr_dirty_from{
+        std::chrono::microseconds::max()};
+    uint64_t tr_count{0};
+};
+
+}  // namespace lnav
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <chrono>
+
+#include "time_rollup.hh"
+
+#include "doctest/doctest.h"
+
+using namespace std::chrono_literals;
+
+TEST_CASE("time_rollup summarize")
+{
+    lnav::time_rollup tr;
+    const auto base = std::chrono::microseconds{24h * 1000};
+
+    // One value every 30 seconds for two days.
+    for (int lpc = 0; lpc < 2 * 24 * 60 * 2; lpc++) {
+        tr.add_value(base + lpc * 30s, lpc % 10);
+    }
+    CHECK(tr.count() == 2 * 24 * 60 * 2);
+
+    CHECK(tr.can_summarize(base, base + 1min));
+    CHECK_FALSE(tr.can_summarize(base, base + 30s));
+    CHECK_FALSE(tr.can_summarize(base + 1min, base));
+
+    auto minute = tr.summarize(base, base + 1min);
+    CHECK(minute.s_count == 2);
+    CHECK(minute.s_min == 0.0);
+    CHECK(minute.s_max == 1.0);
+    CHECK(minute.s_sum == 1.0);
+
+    // An unaligned range that has to use several levels.
+    auto range = tr.summarize(base + 7min, base + 24h + 3h + 2min);
+    CHECK(range.s_count == (24 * 60 + 3 * 60 + 2 - 7) * 2);
+    CHECK(range.s_min == 0.0);
+    CHECK(range.s_max == 9.0);
+
+    auto all = tr.summarize(base - 24h * 7, base + 24h * 7);
+    CHECK(all.s_count == tr.count());
+    CHECK(all.s_centroids.size() == 10);
+
+    uint64_t weight = 0;
+    for (const auto& cent : all.s_centroids) {
+        weight += cent.c_weight;
+    }
+    CHECK(weight == tr.count());
+
+    auto empty = tr.summarize(base + 24h * 3, base + 24h * 4);
+    CHECK(empty.s_count == 0);
+}
+
+TEST_CASE("time_rollup compress")
+{
+    lnav::time_rollup tr;
+
+    for (int lpc = 0; lpc < 1000; lpc++) {
+        tr.add_value(std::chrono::microseconds{0}, lpc);
+    }
+
+    auto sum = tr.summarize(std::chrono::microseconds{0}, 1min);
+    CHECK(sum.s_count == 1000);
+    CHECK(sum.s_min == 0.0);
+    CHECK(sum.s_max == 999.0);
+    CHECK(sum.s_centroids.size() <= lnav::time_rollup::MAX_CENTROIDS * 2);
+
+    uint64_t weight = 0;
+    for (const auto& cent : sum.s_centroids) {
+        weight += cent.c_weight;
+        CHECK(cent.c_mean >= 0.0);
+        CHECK(cent.c_mean <= 999.0);
+    }
+    CHECK(weight == 1000);
+    CHECK_FALSE(sum.s_exact);
+}
+
+TEST_CASE("time_rollup for_each_finest")
+{
+    lnav::time_rollup tr;
+
+    for (int lpc = 0; lpc < 10; lpc++) {
+        tr.add_value(lpc * 1min, lpc % 3);
+        tr.add_value(lpc * 1min + 30s, lpc % 3);
+    }
+    for (int lpc = 0; lpc < 100; lpc++) {
+        tr.add_value(20min, lpc);
+    }
+
+    uint64_t count = 0;
+    size_t buckets = 0;
+    tr.for_each_finest(2min, 5min, [&](const auto& summ) {
+        CHECK(summ.s_exact);
+        CHECK(summ.s_centroids.size() == 1);
+        CHECK(summ.s_centroids[0].c_weight == 2);
+        count += summ.s_count;
+        buckets += 1;
+    });
+    CHECK(buckets == 3);
+    CHECK(count == 6);
+
+    tr.for_each_finest(20min, 21min, [&](const auto& summ) {
+        CHECK_FALSE(summ.s_exact);
+        CHECK(summ.s_count == 100);
+    });
+}
+
+TEST_CASE("time_rollup update after summarize")
+{
+    lnav::time_rollup tr;
+
+    tr.add_value(10min, 1.0);
+    tr.add_value(2min, 2.0);
+    CHECK(tr.summarize(std::chrono::microseconds{0}, 1h).s_count == 2);
+
+    // Values added after a summary, including out-of-order ones, have to
+    // show up in the coarser levels too.
+    tr.add_value(30min, 3.0);
+    tr.add_value(1min, 4.0);
+    auto hour = tr.summarize(std::chrono::microseconds{0}, 1h);
+    CHECK(hour.s_count == 4);
+    CHECK(hour.s_sum == 10.0);
+    CHECK(tr.summarize(1min, 2min).s_sum == 4.0);
+}
+
+TEST_CASE("time_rollup drop finest level")
+{
+    lnav::time_rollup tr;
+    const auto minutes = lnav::time_rollup::MAX_FINEST_BUCKETS + 1;
+
+    for (size_t lpc = 0; lpc < minutes; lpc++) {
+        tr.add_value(lpc * 1min, 1.0);
+    }
+
+    CHECK(tr.finest_width() == 5min);
+    CHECK_FALSE(tr.can_summarize(std::chrono::microseconds{0}, 1min));
+    CHECK(tr.can_summarize(std::chrono::microseconds{0}, 5min));
+    CHECK(tr.summarize(std::chrono::microseconds{0}, 5min).s_count == 5);
+    CHECK(tr.summarize(std::chrono::microseconds{0}, 24h * 30).s_count
+          == minutes);
+}
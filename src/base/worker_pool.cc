@@ -0,0 +1,165 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <exception>
+
+#include "worker_pool.hh"
+
+#include "fmt/format.h"
+#include "lnav_log.hh"
+
+namespace lnav {
+
+worker_pool&
+worker_pool::shared()
+{
+    static worker_pool retval(
+        "worker",
+        std::clamp(static_cast<size_t>(std::thread::hardware_concurrency()),
+                   size_t{1},
+                   MAX_WORKERS));
+
+    return retval;
+}
+
+worker_pool::worker_pool(std::string name, size_t count)
+    : wp_name(std::move(name))
+{
+    count = std::max(count, size_t{1});
+    this->wp_threads.reserve(count);
+    for (size_t lpc = 0; lpc < count; lpc++) {
+        this->wp_threads.emplace_back(
+            [this, lpc]() { this->worker_loop(lpc); });
+    }
+}
+
+worker_pool::~worker_pool()
+{
+    {
+        std::lock_guard<std::mutex> lg(this->wp_mutex);
+
+        this->wp_stopping = true;
+    }
+    this->wp_cond.notify_all();
+    for (auto& th : this->wp_threads) {
+        th.join();
+    }
+}
+
+std::future<void>
+worker_pool::submit(std::function<void()> task)
+{
+    std::packaged_task<void()> pt(std::move(task));
+    auto retval = pt.get_future();
+
+    {
+        std::lock_guard<std::mutex> lg(this->wp_mutex);
+
+        this->wp_tasks.emplace_back(std::move(pt));
+    }
+    this->wp_cond.notify_one();
+
+    return retval;
+}
+
+size_t
+worker_pool::for_ranges(size_t count,
+                        size_t min_per_range,
+                        const std::function<void(size_t, size_t)>& func)
+{
+    auto range_count = std::clamp(count / std::max(min_per_range, size_t{1}),
+                                  size_t{1},
+                                  this->size() + 1);
+
+    if (range_count <= 1) {
+        func(0, count);
+        return 1;
+    }
+
+    auto range_size = (count + range_count - 1) / range_count;
+    std::vector<std::future<void>> pending;
+
+    pending.reserve(range_count - 1);
+    for (auto start = range_size; start < count; start += range_size) {
+        auto end = std::min(start + range_size, count);
+
+        pending.emplace_back(
+            this->submit([&func, start, end]() { func(start, end); }));
+    }
+    // The queued ranges refer to func, so they have to be waited on
+    // before leaving, even if this one fails.
+    std::exception_ptr error;
+    try {
+        func(0, range_size);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (auto& fut : pending) {
+        try {
+            fut.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return pending.size() + 1;
+}
+
+void
+worker_pool::worker_loop(size_t index)
+{
+    log_set_thread_prefix(
+        fmt::format(FMT_STRING("{}-{}"), this->wp_name, index));
+
+    while (true) {
+        std::packaged_task<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(this->wp_mutex);
+
+            this->wp_cond.wait(lock, [this]() {
+                return this->wp_stopping || !this->wp_tasks.empty();
+            });
+            if (this->wp_tasks.empty()) {
+                return;
+            }
+            task = std::move(this->wp_tasks.front());
+            this->wp_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+}  // namespace lnav
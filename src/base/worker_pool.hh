@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef lnav_worker_pool_hh_
+#define lnav_worker_pool_hh_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lnav {
+
+/**
+ * A fixed-size group of threads that run tasks from a shared queue.  The
+ * threads are started once and reused, so callers that want to fan out
+ * short pieces of work do not pay for creating a thread each time.
+ */
+class worker_pool {
+public:
+    /** The maximum number of threads in the shared pool. */
+    static constexpr size_t MAX_WORKERS = 8;
+
+    /**
+     * @return The process-wide pool, which is started on first use with
+     * one thread per core, up to MAX_WORKERS.
+     */
+    static worker_pool& shared();
+
+    /**
+     * @param name The prefix used for the threads in the log.
+     * @param count The number of threads to start, at least one.
+     */
+    worker_pool(std::string name, size_t count);
+
+    worker_pool(const worker_pool&) = delete;
+    worker_pool& operator=(const worker_pool&) = delete;
+
+    ~worker_pool();
+
+    size_t size() const { return this->wp_threads.size(); }
+
+    /**
+     * Queue a task to be run by one of the threads.
+     *
+     * @return A future that is ready when the task has finished.
+     */
+    std::future<void> submit(std::function<void()> task);
+
+    /**
+     * Split [0, count) into ranges of at least min_per_range items and
+     * call func(begin, end) for each one.  The first range is run on the
+     * calling thread and the rest are queued on the pool.  There is at
+     * most one more range than there are threads in the pool.  Returns
+     * after all of the ranges have finished.
+     *
+     * @return The number of ranges the work was split into.
+     */
+    size_t for_ranges(size_t count,
+                      size_t min_per_range,
+                      const std::function<void(size_t, size_t)>& func);
+
+private:
+    void worker_loop(size_t index);
+
+    std::string wp_name;
+    std::mutex wp_mutex;
+    std::condition_variable wp_cond;
+    std::deque<std::packaged_task<void()>> wp_tasks;
+    bool wp_stopping{false};
+    std::vector<std::thread> wp_threads;
+};
+
+}  // namespace lnav
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "worker_pool.hh"
+
+#include "doctest/doctest.h"
+
+TEST_CASE("worker_pool submit")
+{
+    lnav::worker_pool wp("test", 2);
+    std::atomic<int> total{0};
+    std::vector<std::future<void>> futs;
+
+    CHECK(wp.size() == 2);
+    for (int lpc = 1; lpc <= 100; lpc++) {
+        futs.emplace_back(wp.submit([&total, lpc]() { total += lpc; }));
+    }
+    for (auto& fut : futs) {
+        fut.get();
+    }
+    CHECK(total == 5050);
+}
+
+TEST_CASE("worker_pool for_ranges")
+{
+    lnav::worker_pool wp("test", 3);
+    std::vector<int> hits(1000);
+
+    auto ranges = wp.for_ranges(hits.size(), 100, [&hits](size_t b, size_t e) {
+        for (auto lpc = b; lpc < e; lpc++) {
+            hits[lpc] += 1;
+        }
+    });
+    // Limited by the pool size plus the calling thread.
+    CHECK(ranges == 4);
+    for (const auto hit : hits) {
+        CHECK(hit == 1);
+    }
+
+    // Too little work to split.
+    ranges = wp.for_ranges(150, 100, [](size_t b, size_t e) {
+        CHECK(b == 0);
+        CHECK(e == 150);
+    });
+    CHECK(ranges == 1);
+
+    ranges = wp.for_ranges(0, 100, [](size_t b, size_t e) { CHECK(b == e); });
+    CHECK(ranges == 1);
+}
+
+TEST_CASE("worker_pool for_ranges error")
+{
+    lnav::worker_pool wp("test", 2);
+    std::atomic<int> finished{0};
+
+    CHECK_THROWS_AS(wp.for_ranges(300,
+                                  100,
+                                  [&finished](size_t b, size_t e) {
+                                      if (b == 0) {
+                                          throw std::runtime_error("fail");
+                                      }
+                                      finished += 1;
+                                  }),
+                    std::runtime_error);
+    // The other ranges were still waited on.
+    CHECK(finished == 2);
+}
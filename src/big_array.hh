@@ -32,39 +32,63 @@
 #ifndef lnav_big_array_hh
 #define lnav_big_array_hh
 
+#include <iterator>
+#include <vector>
+
 #include <sys/mman.h>
 #include <unistd.h>
 
 #include "base/lnav_log.hh"
 #include "base/math_util.hh"
 
+/**
+ * A growable array that is stored in fixed-size segments of anonymous
+ * memory.  Growing the array maps more segments and leaves the existing
+ * elements in place, so it never needs to copy or be rebuilt.
+ */
 template<typename T>
 struct big_array {
-    static const size_t DEFAULT_INCREMENT = 100 * 1000;
+    static constexpr size_t SEGMENT_SHIFT = 16;
+    static constexpr size_t SEGMENT_SIZE = 1UL << SEGMENT_SHIFT;
+    static constexpr size_t SEGMENT_MASK = SEGMENT_SIZE - 1;
 
-    bool reserve(size_t size)
+    big_array() = default;
+
+    big_array(const big_array&) = delete;
+
+    big_array& operator=(const big_array&) = delete;
+
+    ~big_array()
     {
-        if (size < this->ba_capacity) {
-            return false;
+        for (auto* seg : this->ba_segments) {
+            munmap(seg, segment_bytes());
         }
+    }
 
-        if (this->ba_ptr) {
-            munmap(this->ba_ptr,
-                   roundup_size(this->ba_capacity * sizeof(T), getpagesize()));
+    /**
+     * Make sure there is room for the given number of elements.
+     *
+     * @return True if more segments were mapped.
+     */
+    bool reserve(size_t size)
+    {
+        if (size <= this->ba_capacity) {
+            return false;
         }
 
-        this->ba_capacity = size + DEFAULT_INCREMENT;
-        void* result
-            = mmap(nullptr,
-                   roundup_size(this->ba_capacity * sizeof(T), getpagesize()),
-                   PROT_READ | PROT_WRITE,
-                   MAP_ANONYMOUS | MAP_PRIVATE,
-                   -1,
-                   0);
+        while (this->ba_capacity < size) {
+            void* result = mmap(nullptr,
+                                segment_bytes(),
+                                PROT_READ | PROT_WRITE,
+                                MAP_ANONYMOUS | MAP_PRIVATE,
+                                -1,
+                                0);
 
-        ensure(result != MAP_FAILED);
+            ensure(result != MAP_FAILED);
 
-        this->ba_ptr = (T*) result;
+            this->ba_segments.push_back((T*) result);
+            this->ba_capacity += SEGMENT_SIZE;
+        }
 
         return true;
     }
@@ -84,25 +108,155 @@ struct big_array {
 
     void push_back(const T& val)
     {
-        this->ba_ptr[this->ba_size] = val;
+        if (this->ba_size == this->ba_capacity) {
+            this->reserve(this->ba_size + 1);
+        }
+        (*this)[this->ba_size] = val;
         this->ba_size += 1;
     }
 
-    T& operator[](size_t index) { return this->ba_ptr[index]; }
+    T& operator[](size_t index)
+    {
+        return this->ba_segments[index >> SEGMENT_SHIFT][index & SEGMENT_MASK];
+    }
 
-    const T& operator[](size_t index) const { return this->ba_ptr[index]; }
+    const T& operator[](size_t index) const
+    {
+        return this->ba_segments[index >> SEGMENT_SHIFT][index & SEGMENT_MASK];
+    }
+
+    T& back() { return (*this)[this->ba_size - 1]; }
+
+    class iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
 
-    T& back() { return this->ba_ptr[this->ba_size - 1]; }
+        iterator() = default;
 
-    using iterator = T*;
+        iterator(big_array* array, difference_type index)
+            : i_array(array), i_index(index)
+        {
+        }
+
+        reference operator*() const { return (*this->i_array)[this->i_index]; }
 
-    iterator begin() { return this->ba_ptr; }
+        pointer operator->() const { return &(**this); }
+
+        reference operator[](difference_type off) const
+        {
+            return (*this->i_array)[this->i_index + off];
+        }
 
-    iterator end() { return this->ba_ptr + this->ba_size; }
+        iterator& operator++()
+        {
+            this->i_index += 1;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            auto retval = *this;
+            this->i_index += 1;
+            return retval;
+        }
+
+        iterator& operator--()
+        {
+            this->i_index -= 1;
+            return *this;
+        }
+
+        iterator operator--(int)
+        {
+            auto retval = *this;
+            this->i_index -= 1;
+            return retval;
+        }
 
-    T* ba_ptr{nullptr};
+        iterator& operator+=(difference_type off)
+        {
+            this->i_index += off;
+            return *this;
+        }
+
+        iterator& operator-=(difference_type off)
+        {
+            this->i_index -= off;
+            return *this;
+        }
+
+        iterator operator+(difference_type off) const
+        {
+            return iterator{this->i_array, this->i_index + off};
+        }
+
+        friend iterator operator+(difference_type off, const iterator& iter)
+        {
+            return iter + off;
+        }
+
+        iterator operator-(difference_type off) const
+        {
+            return iterator{this->i_array, this->i_index - off};
+        }
+
+        difference_type operator-(const iterator& rhs) const
+        {
+            return this->i_index - rhs.i_index;
+        }
+
+        bool operator==(const iterator& rhs) const
+        {
+            return this->i_index == rhs.i_index;
+        }
+
+        bool operator!=(const iterator& rhs) const
+        {
+            return this->i_index != rhs.i_index;
+        }
+
+        bool operator<(const iterator& rhs) const
+        {
+            return this->i_index < rhs.i_index;
+        }
+
+        bool operator>(const iterator& rhs) const
+        {
+            return this->i_index > rhs.i_index;
+        }
+
+        bool operator<=(const iterator& rhs) const
+        {
+            return this->i_index <= rhs.i_index;
+        }
+
+        bool operator>=(const iterator& rhs) const
+        {
+            return this->i_index >= rhs.i_index;
+        }
+
+    private:
+        big_array* i_array{nullptr};
+        difference_type i_index{0};
+    };
+
+    iterator begin() { return iterator{this, 0}; }
+
+    iterator end() { return iterator{this, (std::ptrdiff_t) this->ba_size}; }
+
+    std::vector<T*> ba_segments;
     size_t ba_size{0};
     size_t ba_capacity{0};
+
+private:
+    static size_t segment_bytes()
+    {
+        return roundup_size(SEGMENT_SIZE * sizeof(T), getpagesize());
+    }
 };
 
 #endif
@@ -1231,7 +1231,8 @@ com_open(exec_context& ec, std::string cmdline, std::vector<std::string>& args)
     if (prov) {
         loo.with_filename(prov->fo_name);
     }
-    loo.with_time_range(lnav_data.ld_default_time_range);
+    loo.with_time_range(lnav_data.ld_default_time_range)
+        .with_min_level(lnav_data.ld_default_min_level);
 
     CLI::App app{"open"};
     std::vector<std::string> file_args;
@@ -364,7 +364,8 @@ file_collection::watch_logfile(const std::string& user_req,
                     logfile_open_options()
                         .with_non_utf_visibility(false)
                         .with_visible_size_limit(256 * 1024)
-                        .with_time_range(loo.loo_time_range));
+                        .with_time_range(loo.loo_time_range)
+                        .with_min_level(loo.loo_min_level));
                 return lnav::futures::make_ready_future(std::move(retval));
             }
             return std::nullopt;
@@ -505,10 +506,6 @@ file_collection::watch_logfile(const std::string& user_req,
                 }
 
                 case file_format_t::ARCHIVE: {
-                    std::optional<
-                        std::list<archive_manager::extract_progress>::iterator>
-                        prog_iter_opt;
-
                     if (loo.loo_source == logfile_name_source::ARCHIVE) {
                         // Don't try to open nested archives
                         return retval;
@@ -516,42 +513,40 @@ file_collection::watch_logfile(const std::string& user_req,
 
                     auto res = archive_manager::walk_archive_files(
                         filename,
-                        [prog, &prog_iter_opt](const auto& path,
-                                               const auto total) {
+                        [prog](const auto& path, const auto total) {
                             safe::WriteAccess<safe_scan_progress> sp(*prog);
 
-                            prog_iter_opt | [&sp](auto prog_iter) {
-                                sp->sp_extractions.erase(prog_iter);
-                            };
                             auto prog_iter = sp->sp_extractions.emplace(
                                 sp->sp_extractions.begin(), path, total);
-                            prog_iter_opt = prog_iter;
 
-                            return &(*prog_iter);
+                            return std::shared_ptr<
+                                archive_manager::extract_progress>(
+                                &(*prog_iter), [prog, prog_iter](auto*) {
+                                    prog->writeAccess()->sp_extractions.erase(
+                                        prog_iter);
+                                });
                         },
-                        [&filename, &retval, &loo](const auto& tmp_path,
-                                                   const auto& entry) {
-                            auto arc_path = std::filesystem::relative(
-                                entry.path(), tmp_path);
-                            auto custom_name = filename / arc_path;
+                        [&filename, &retval, &loo](const auto& ef) {
+                            auto custom_name = filename / ef.ef_name;
                             bool is_visible = true;
 
-                            if (entry.file_size() == 0) {
+                            if (ef.ef_empty) {
                                 log_info("hiding empty archive file: %s",
-                                         entry.path().c_str());
+                                         ef.ef_path.c_str());
                                 is_visible = false;
                             }
 
                             log_info("adding file from archive: %s/%s",
                                      filename.c_str(),
-                                     entry.path().c_str());
-                            retval.fc_file_names[entry.path().string()]
+                                     ef.ef_path.c_str());
+                            retval.fc_file_names[ef.ef_path.string()]
                                 .with_filename(custom_name.string())
                                 .with_source(logfile_name_source::ARCHIVE)
                                 .with_visibility(is_visible)
                                 .with_non_utf_visibility(false)
                                 .with_visible_size_limit(256 * 1024)
-                                .with_time_range(loo.loo_time_range);
+                                .with_time_range(loo.loo_time_range)
+                                .with_min_level(loo.loo_min_level);
                         });
                     if (res.isErr()) {
                         log_error("archive extraction failed: %s",
@@ -569,17 +564,13 @@ file_collection::watch_logfile(const std::string& user_req,
                                 st.st_mtime,
                                 um.move(),
                             });
-                    } else {
+                    } else if (res.unwrap()
+                               == archive_manager::walk_status_t::complete)
+                    {
                         auto& ofd = retval.fc_other_files[filename];
                         ofd.ofd_format = ff_res.dffr_file_format;
                         ofd.ofd_details = ff_res.dffr_details;
                     }
-                    {
-                        prog_iter_opt | [&prog](auto prog_iter) {
-                            prog->writeAccess()->sp_extractions.erase(
-                                prog_iter);
-                        };
-                    }
                     break;
                 }
 
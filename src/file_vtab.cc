@@ -40,6 +40,7 @@
 #include "config.h"
 #include "file_collection.hh"
 #include "file_vtab.cfg.hh"
+#include "lnav.perf.hh"
 #include "log_format.hh"
 #include "logfile.hh"
 #include "session_data.hh"
@@ -372,6 +373,91 @@ CREATE TABLE lnav_db.lnav_file_metadata (
     file_collection& lfm_collection;
 };
 
+struct lnav_perf {
+    static constexpr const char* NAME = "lnav_perf";
+    static constexpr const char* CREATE_STMT = R"(
+-- Access lnav's measurements of its own performance.
+CREATE TABLE lnav_db.lnav_perf (
+    kind text,    -- The kind of thing measured: operation or file.
+    name text,    -- The name of the operation or the path to the file.
+    metric text,  -- The name of the measurement.
+    value real,   -- The value of the measurement.
+    unit text     -- The unit of the value.
+);
+)";
+
+    struct cursor {
+        sqlite3_vtab_cursor base;
+        lnav_perf& c_perf;
+        std::vector<lnav::perf::metric>::iterator c_iter;
+        std::vector<lnav::perf::metric> c_rows;
+
+        cursor(sqlite3_vtab* vt)
+            : base({vt}),
+              c_perf(((vtab_module<lnav_perf>::vtab*) vt)->v_impl),
+              c_rows(lnav::perf::collect(this->c_perf.lp_collection))
+        {
+        }
+
+        ~cursor() { this->c_iter = this->c_rows.end(); }
+
+        int next()
+        {
+            if (this->c_iter != this->c_rows.end()) {
+                ++this->c_iter;
+            }
+            return SQLITE_OK;
+        }
+
+        int eof() { return this->c_iter == this->c_rows.end(); }
+
+        int reset()
+        {
+            this->c_iter = this->c_rows.begin();
+            return SQLITE_OK;
+        }
+
+        int get_rowid(sqlite3_int64& rowid_out)
+        {
+            rowid_out = this->c_iter - this->c_rows.begin();
+
+            return SQLITE_OK;
+        }
+    };
+
+    explicit lnav_perf(file_collection& fc) : lp_collection(fc) {}
+
+    int get_column(const cursor& vc, sqlite3_context* ctx, int col)
+    {
+        const auto& m = *vc.c_iter;
+
+        switch (col) {
+            case 0:
+                to_sqlite(ctx, m.m_kind);
+                break;
+            case 1:
+                to_sqlite(ctx, m.m_name);
+                break;
+            case 2:
+                to_sqlite(ctx, m.m_metric);
+                break;
+            case 3:
+                to_sqlite(ctx, m.m_value);
+                break;
+            case 4:
+                to_sqlite(ctx, m.m_unit);
+                break;
+            default:
+                ensure(0);
+                break;
+        }
+
+        return SQLITE_OK;
+    }
+
+    file_collection& lp_collection;
+};
+
 struct injectable_lnav_file : vtab_module<lnav_file> {
     using vtab_module::vtab_module;
     using injectable = injectable_lnav_file(file_collection&);
@@ -383,10 +469,18 @@ struct injectable_lnav_file_metadata
     using injectable = injectable_lnav_file_metadata(file_collection&);
 };
 
+struct injectable_lnav_perf : vtab_module<tvt_no_update<lnav_perf>> {
+    using vtab_module::vtab_module;
+    using injectable = injectable_lnav_perf(file_collection&);
+};
+
 auto file_binder
     = injector::bind_multiple<vtab_module_base>().add<injectable_lnav_file>();
 
 auto file_meta_binder = injector::bind_multiple<vtab_module_base>()
                             .add<injectable_lnav_file_metadata>();
 
+auto perf_binder = injector::bind_multiple<vtab_module_base>()
+                       .add<injectable_lnav_perf>();
+
 }  // namespace
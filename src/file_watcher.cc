@@ -0,0 +1,298 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <chrono>
+
+#include "file_watcher.hh"
+
+#include <poll.h>
+
+#include "base/injector.bind.hh"
+#include "base/lnav_log.hh"
+#include "config.h"
+#include "service_tags.hh"
+
+#ifdef HAVE_SYS_INOTIFY_H
+#    include <sys/inotify.h>
+#    include <sys/vfs.h>
+#endif
+
+using namespace std::chrono_literals;
+
+static auto bound_file_watcher
+    = injector::bind_multiple<isc::service_base>()
+          .add_singleton<lnav::file_watcher, services::file_watcher_t>();
+
+namespace injector {
+template<>
+void
+force_linking(services::file_watcher_t anno)
+{
+}
+}  // namespace injector
+
+namespace lnav {
+
+#ifdef HAVE_SYS_INOTIFY_H
+static constexpr uint32_t WATCH_MASK = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE
+    | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF
+    | IN_MOVE_SELF | IN_ONLYDIR;
+
+static constexpr uint32_t ENTRIES_CHANGED_MASK = IN_CREATE | IN_DELETE
+    | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF
+    | IN_IGNORED;
+
+/**
+ * Check if the filesystem holding the given directory delivers events
+ * for changes made by other hosts or by the kernel itself.
+ */
+static bool
+has_reliable_events(const std::filesystem::path& dir)
+{
+    struct statfs sfs;
+
+    if (statfs(dir.c_str(), &sfs) == -1) {
+        return true;
+    }
+
+    switch ((uint32_t) sfs.f_type) {
+        case 0x6969: /* NFS */
+        case 0x517B: /* SMB */
+        case 0xFE534D42: /* SMB2 */
+        case 0xFF534D42: /* CIFS */
+        case 0x65735546: /* FUSE */
+        case 0x01021997: /* 9P */
+        case 0x00C36400: /* CEPH */
+        case 0x5346414F: /* AFS */
+        case 0x9FA0: /* PROC */
+        case 0x62656572: /* SYSFS */
+            return false;
+        default:
+            return true;
+    }
+}
+#endif
+
+file_watcher::file_watcher()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    this->fw_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->fw_fd.get() == -1) {
+        log_error("unable to create inotify instance, will poll -- %s",
+                  strerror(errno));
+    }
+#endif
+}
+
+void
+file_watcher::set_watched_dirs(std::set<std::filesystem::path> dirs)
+{
+    if (!this->is_supported()) {
+        return;
+    }
+
+    std::vector<int> to_remove;
+    for (const auto& pair : this->fw_wd_to_dir) {
+        if (dirs.count(pair.second) == 0) {
+            to_remove.emplace_back(pair.first);
+        }
+    }
+    for (const auto wd : to_remove) {
+        this->remove_watch(wd);
+    }
+
+    this->fw_wanted_dirs = std::move(dirs);
+    for (const auto& dir : this->fw_wanted_dirs) {
+        if (this->fw_dir_to_wd.count(dir) == 0) {
+            this->add_watch(dir);
+        }
+    }
+    this->fw_last_retry = getmstime();
+}
+
+file_watcher::changes
+file_watcher::take_changes()
+{
+    changes retval;
+
+    std::swap(retval, *this->fw_changes.writeAccess());
+    return retval;
+}
+
+void
+file_watcher::add_watch(const std::filesystem::path& dir)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    if (this->fw_unsupported_dirs.count(dir) > 0) {
+        return;
+    }
+    if (!has_reliable_events(dir)) {
+        log_info("polling for changes in directory on remote filesystem: %s",
+                 dir.c_str());
+        this->fw_unsupported_dirs.insert(dir);
+        return;
+    }
+
+    auto wd = inotify_add_watch(this->fw_fd.get(), dir.c_str(), WATCH_MASK);
+    if (wd == -1) {
+        if (errno != ENOENT) {
+            log_warning("unable to watch directory: %s -- %s",
+                        dir.c_str(),
+                        strerror(errno));
+        }
+        if (errno == ENOSPC || errno == ENOTDIR) {
+            this->fw_unsupported_dirs.insert(dir);
+        }
+        return;
+    }
+
+    log_debug("watching directory: %s (%d)", dir.c_str(), wd);
+    this->fw_wd_to_dir[wd] = dir;
+    this->fw_dir_to_wd[dir] = wd;
+    this->fw_active_dirs.writeAccess()->insert(dir);
+    this->fw_generation += 1;
+#endif
+}
+
+void
+file_watcher::remove_watch(int wd)
+{
+    auto iter = this->fw_wd_to_dir.find(wd);
+    if (iter == this->fw_wd_to_dir.end()) {
+        return;
+    }
+
+#ifdef HAVE_SYS_INOTIFY_H
+    inotify_rm_watch(this->fw_fd.get(), wd);
+#endif
+    log_debug("stopped watching directory: %s (%d)", iter->second.c_str(), wd);
+    this->fw_active_dirs.writeAccess()->erase(iter->second);
+    this->fw_dir_to_wd.erase(iter->second);
+    this->fw_wd_to_dir.erase(iter);
+    this->fw_generation += 1;
+}
+
+void
+file_watcher::read_events()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    alignas(inotify_event) char buffer[64 * 1024];
+
+    while (true) {
+        auto rc = read(this->fw_fd.get(), buffer, sizeof(buffer));
+        if (rc <= 0) {
+            if (rc == -1 && errno != EAGAIN && errno != EINTR) {
+                log_error("unable to read inotify events -- %s",
+                          strerror(errno));
+            }
+            break;
+        }
+
+        auto changes_wa = this->fw_changes.writeAccess();
+        std::vector<int> gone;
+        for (char* ptr = buffer; ptr < buffer + rc;) {
+            const auto* ev = reinterpret_cast<const inotify_event*>(ptr);
+
+            ptr += sizeof(inotify_event) + ev->len;
+            if (ev->mask & IN_Q_OVERFLOW) {
+                log_warning("inotify queue overflowed, checking all files");
+                changes_wa->c_overflowed = true;
+                continue;
+            }
+
+            auto iter = this->fw_wd_to_dir.find(ev->wd);
+            if (iter == this->fw_wd_to_dir.end()) {
+                continue;
+            }
+
+            if (ev->mask & ENTRIES_CHANGED_MASK) {
+                changes_wa->c_entries_changed = true;
+            }
+            if (ev->len > 0) {
+                changes_wa->c_paths.emplace(iter->second / ev->name);
+            }
+            if (ev->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                gone.emplace_back(ev->wd);
+            }
+        }
+        for (const auto wd : gone) {
+            this->remove_watch(wd);
+        }
+    }
+#endif
+}
+
+void
+file_watcher::loop_body()
+{
+    if (!this->is_supported()) {
+        return;
+    }
+
+    pollfd pfd[1];
+
+    pfd[0].fd = this->fw_fd.get();
+    pfd[0].events = POLLIN;
+    pfd[0].revents = 0;
+
+    auto rc = poll(pfd, 1, 100);
+    if (rc > 0) {
+        this->read_events();
+    }
+
+    // Directories that did not exist yet, or were removed and recreated,
+    // need to be retried since there is nothing to deliver an event.
+    auto now = getmstime();
+    if (now - this->fw_last_retry >= 1000) {
+        this->fw_last_retry = now;
+        for (const auto& dir : this->fw_wanted_dirs) {
+            if (this->fw_dir_to_wd.count(dir) == 0) {
+                this->add_watch(dir);
+            }
+        }
+    }
+}
+
+std::chrono::milliseconds
+file_watcher::compute_timeout(mstime_t current_time) const
+{
+    if (this->is_supported()) {
+        return 0ms;
+    }
+
+    return 1s;
+}
+
+void
+file_watcher::stopped()
+{
+    this->fw_fd.reset();
+}
+
+}  // namespace lnav
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef lnav_file_watcher_hh
+#define lnav_file_watcher_hh
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <set>
+
+#include "base/auto_fd.hh"
+#include "base/isc.hh"
+#include "safe/safe.h"
+
+namespace lnav {
+
+/**
+ * Service that watches the directories containing the files being viewed
+ * and collects the change events reported by the kernel.  The main loop
+ * consumes the events to decide which files need to be stat()'d and when
+ * the glob patterns need to be expanded again, instead of polling
+ * everything on a timer.  Directories on filesystems that do not deliver
+ * events, like network mounts, are never reported as watched so that
+ * their files continue to be polled.
+ */
+class file_watcher : public isc::service<file_watcher> {
+public:
+    struct changes {
+        /** Entries were created, deleted, or renamed in a directory. */
+        bool c_entries_changed{false};
+        /** The kernel dropped events, so everything needs to be checked. */
+        bool c_overflowed{false};
+        /** The paths of the directory entries that had an event. */
+        std::set<std::filesystem::path> c_paths;
+
+        bool empty() const
+        {
+            return !this->c_entries_changed && !this->c_overflowed
+                && this->c_paths.empty();
+        }
+    };
+
+    file_watcher();
+
+    /**
+     * @return True if this platform can deliver file change events.
+     */
+    bool is_supported() const { return this->fw_fd.get() != -1; }
+
+    /**
+     * Replace the set of directories to watch.  Needs to be called from
+     * the service thread, so use send().
+     */
+    void set_watched_dirs(std::set<std::filesystem::path> dirs);
+
+    /**
+     * @return True if events are being delivered for the given directory.
+     */
+    bool is_watched(const std::filesystem::path& dir) const
+    {
+        return this->fw_active_dirs.readAccess()->count(dir) > 0;
+    }
+
+    /**
+     * @return A counter that is incremented whenever the set of directories
+     *   that are actively being watched changes.
+     */
+    uint64_t get_generation() const { return this->fw_generation.load(); }
+
+    /**
+     * @return The changes collected since the last call.
+     */
+    changes take_changes();
+
+protected:
+    void loop_body() override;
+
+    std::chrono::milliseconds compute_timeout(
+        mstime_t current_time) const override;
+
+    void stopped() override;
+
+private:
+    void add_watch(const std::filesystem::path& dir);
+    void remove_watch(int wd);
+    void read_events();
+
+    auto_fd fw_fd;
+    std::set<std::filesystem::path> fw_wanted_dirs;
+    std::set<std::filesystem::path> fw_unsupported_dirs;
+    std::map<int, std::filesystem::path> fw_wd_to_dir;
+    std::map<std::filesystem::path, int> fw_dir_to_wd;
+    mstime_t fw_last_retry{0};
+    safe::Safe<std::set<std::filesystem::path>> fw_active_dirs;
+    std::atomic<uint64_t> fw_generation{0};
+    safe::Safe<changes> fw_changes;
+};
+
+}  // namespace lnav
+
+#endif
@@ -712,6 +712,14 @@ files_sub_source::text_selection_changed(textview_curses& tc)
                                 to_timeval(open_opts.loo_time_range.tr_end),
                                 'T')));
                 }
+                if (open_opts.loo_min_level != LEVEL_UNKNOWN) {
+                    details.emplace_back(
+                        attr_line_t()
+                            .append("Cutoff Level"_h3)
+                            .right_justify(NAME_WIDTH)
+                            .append(": ")
+                            .append(level_names[open_opts.loo_min_level]));
+                }
                 details.emplace_back(
                     attr_line_t()
                         .append("Duration"_h3)
@@ -28,11 +28,13 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <iterator>
 
 #include "filter_observer.hh"
 
 #include "base/lnav_log.hh"
+#include "base/worker_pool.hh"
 #include "config.h"
 #include "log_format.hh"
 #include "shared_buffer.hh"
@@ -56,7 +58,28 @@ line_filter_observer::logline_new_lines(const logfile& lf,
     auto retval = false;
 
     this->lfo_filter_state.resize(lf.size());
-    if (this->lfo_filter_stack.empty()) {
+    if (!this->logline_needs_content(lf)) {
+        return retval;
+    }
+
+    /*
+     * When re-observing after a filter change, only the filters that have
+     * not seen these lines yet need to be evaluated.  If they have all seen
+     * them, there is no need to prepare the content at all.
+     */
+    text_filter* pending[logfile_filter_state::MAX_FILTERS];
+    size_t pending_count = 0;
+    for (const auto& filter : this->lfo_filter_stack) {
+        if (filter->lf_deleted) {
+            continue;
+        }
+        if (offset >= (ssize_t) this->lfo_filter_state.filter_count(
+                filter->get_index()))
+        {
+            pending[pending_count++] = filter.get();
+        }
+    }
+    if (pending_count == 0) {
         return retval;
     }
 
@@ -68,21 +91,215 @@ line_filter_observer::logline_new_lines(const logfile& lf,
                 lf.get_format_file_state(), *ll_begin, sbr_copy);
         }
         sbr_copy.erase_ansi();
-        for (const auto& filter : this->lfo_filter_stack) {
-            if (filter->lf_deleted) {
+        for (size_t lpc = 0; lpc < pending_count; lpc++) {
+            retval = pending[lpc]->add_line(
+                         this->lfo_filter_state, ll_begin, sbr_copy)
+                || retval;
+        }
+    }
+
+    return retval;
+}
+
+void
+line_filter_observer::logline_new_messages(const logfile& lf,
+                                           std::vector<message_content>& msgs)
+{
+    static constexpr size_t MIN_LINES_PER_WORKER = 4 * 1024;
+
+    require(&lf == this->lfo_filter_state.tfs_logfile.get());
+
+    this->lfo_filter_state.resize(lf.size());
+    if (msgs.empty() || !this->logline_needs_content(lf)) {
+        return;
+    }
+
+    struct pending_filter {
+        text_filter* pf_filter;
+        const pcre_filter* pf_regex;
+        size_t pf_start;
+    };
+
+    std::vector<pending_filter> filters;
+    auto has_regex = false;
+    for (const auto& filter : this->lfo_filter_stack) {
+        if (filter->lf_deleted) {
+            continue;
+        }
+
+        const auto* regex = dynamic_cast<const pcre_filter*>(filter.get());
+        filters.emplace_back(pending_filter{
+            filter.get(),
+            regex,
+            this->lfo_filter_state.filter_count(filter->get_index()),
+        });
+        has_regex = has_regex || regex != nullptr;
+    }
+
+    struct line_content {
+        logfile::const_iterator lc_line;
+        size_t lc_msg_offset;
+        shared_buffer_ref lc_content;
+    };
+
+    std::vector<line_content> lines;
+    auto* format = lf.get_format_ptr();
+    for (auto& msg : msgs) {
+        const size_t offset = std::distance(lf.begin(), msg.mc_begin);
+        auto needed = std::any_of(
+            filters.begin(), filters.end(), [offset](const auto& pf) {
+                return offset >= pf.pf_start;
+            });
+        if (!needed) {
+            continue;
+        }
+
+        for (auto ll = msg.mc_begin; ll != msg.mc_end; ++ll) {
+            auto sbr_copy = msg.mc_content.clone();
+            if (format != nullptr) {
+                format->get_subline(lf.get_format_file_state(), *ll, sbr_copy);
+            }
+            sbr_copy.erase_ansi();
+            // The subline might be shared with the format, so take a copy
+            // before the next one is generated.
+            sbr_copy.take_ownership();
+            lines.emplace_back(line_content{ll, offset, std::move(sbr_copy)});
+        }
+    }
+
+    if (lines.empty()) {
+        return;
+    }
+
+    /*
+     * The regex filters are evaluated up front, possibly on worker
+     * threads, since they do not touch any shared state.  Each line gets
+     * hit_words words where bit N is the result for filters[N].
+     */
+    const auto hit_words = (filters.size() + filter_mask::WORD_BITS - 1)
+        / filter_mask::WORD_BITS;
+    std::vector<uint32_t> regex_hits(lines.size() * hit_words);
+    auto eval_range = [&filters, &lines, &regex_hits, hit_words](size_t begin,
+                                                                 size_t end) {
+        for (auto lpc = begin; lpc < end; lpc++) {
+            const auto& lc = lines[lpc];
+            auto sf = lc.lc_content.to_string_fragment();
+            auto valid_utf = lc.lc_content.get_metadata().m_valid_utf;
+            auto* hits = &regex_hits[lpc * hit_words];
+
+            for (size_t findex = 0; findex < filters.size(); findex++) {
+                const auto& pf = filters[findex];
+
+                if (pf.pf_regex == nullptr || lc.lc_msg_offset < pf.pf_start) {
+                    continue;
+                }
+                if (pf.pf_regex->matches_content(sf, valid_utf)) {
+                    hits[findex / filter_mask::WORD_BITS]
+                        |= 1U << (findex % filter_mask::WORD_BITS);
+                }
+            }
+        }
+    };
+
+    if (has_regex) {
+        auto ranges = lnav::worker_pool::shared().for_ranges(
+            lines.size(), MIN_LINES_PER_WORKER, eval_range);
+
+        log_debug("evaluated regex filters on %zu lines in %zu ranges",
+                  lines.size(),
+                  ranges);
+    }
+
+    // Feed the results through the filters in order so the per-message
+    // state ends up the same as when the lines are added one at a time.
+    for (size_t lpc = 0; lpc < lines.size(); lpc++) {
+        const auto& lc = lines[lpc];
+
+        for (size_t findex = 0; findex < filters.size(); findex++) {
+            const auto& pf = filters[findex];
+
+            if (lc.lc_msg_offset < pf.pf_start) {
                 continue;
             }
-            if (offset >= (ssize_t) this->lfo_filter_state
-                              .tfs_filter_count[filter->get_index()])
-            {
-                retval = filter->add_line(
-                             this->lfo_filter_state, ll_begin, sbr_copy)
-                    || retval;
+
+            bool matched;
+            if (pf.pf_regex != nullptr) {
+                matched = (regex_hits[lpc * hit_words
+                                      + findex / filter_mask::WORD_BITS]
+                           >> (findex % filter_mask::WORD_BITS))
+                    & 1U;
+            } else {
+                matched = pf.pf_filter->matches(
+                    text_filter::line_source{lf, lc.lc_line}, lc.lc_content);
             }
+            pf.pf_filter->add_line_result(
+                this->lfo_filter_state, lc.lc_line, matched);
         }
     }
+}
 
-    return retval;
+void
+line_filter_observer::excluded_lines(const filter_mask& filter_in_mask,
+                                     const filter_mask& filter_out_mask,
+                                     std::vector<uint64_t>& bits_out) const
+{
+    const auto& state = this->lfo_filter_state;
+    const auto& masks = state.tfs_mask;
+    const auto words = state.tfs_mask_words;
+    const auto lines = state.mask_lines();
+    const uint64_t in_enabled = !filter_in_mask.empty();
+
+    bits_out.resize((lines + 63) / 64);
+    if (words == 1) {
+        const auto in_word = filter_in_mask.word(0);
+        const auto out_word = filter_out_mask.word(0);
+
+        for (size_t base = 0; base < lines; base += 64) {
+            const auto* block = &masks[base];
+            const auto count = std::min(lines - base, size_t{64});
+            uint64_t word = 0;
+
+            // Keep this branch-free so the compiler can vectorize it.
+            for (size_t lpc = 0; lpc < count; lpc++) {
+                const auto mask = block[lpc];
+                const uint64_t filtered_out
+                    = (in_enabled & ((mask & in_word) == 0))
+                    | ((mask & out_word) != 0);
+
+                word |= filtered_out << lpc;
+            }
+            bits_out[base / 64] = word;
+        }
+        return;
+    }
+
+    std::array<uint32_t, filter_mask::MAX_WORDS> in_words{};
+    std::array<uint32_t, filter_mask::MAX_WORDS> out_words{};
+    for (size_t lpc = 0; lpc < words; lpc++) {
+        in_words[lpc] = filter_in_mask.word(lpc);
+        out_words[lpc] = filter_out_mask.word(lpc);
+    }
+    for (size_t base = 0; base < lines; base += 64) {
+        const auto count = std::min(lines - base, size_t{64});
+        uint64_t word = 0;
+
+        for (size_t lpc = 0; lpc < count; lpc++) {
+            const auto* row = &masks[(base + lpc) * words];
+            uint32_t in_hits = 0;
+            uint32_t out_hits = 0;
+
+            for (size_t windex = 0; windex < words; windex++) {
+                in_hits |= row[windex] & in_words[windex];
+                out_hits |= row[windex] & out_words[windex];
+            }
+
+            const uint64_t filtered_out
+                = (in_enabled & (in_hits == 0)) | (out_hits != 0);
+
+            word |= filtered_out << lpc;
+        }
+        bits_out[base / 64] = word;
+    }
 }
 
 void
@@ -97,6 +314,14 @@ line_filter_observer::logline_eof(const logfile& lf)
     }
 }
 
+bool
+line_filter_observer::logline_needs_content(const logfile& lf) const
+{
+    return std::any_of(this->lfo_filter_stack.begin(),
+                       this->lfo_filter_stack.end(),
+                       [](const auto& filter) { return !filter->lf_deleted; });
+}
+
 size_t
 line_filter_observer::get_min_count(size_t max) const
 {
@@ -108,7 +333,7 @@ line_filter_observer::get_min_count(size_t max) const
         }
         retval = std::min(
             retval,
-            this->lfo_filter_state.tfs_filter_count[filter->get_index()]);
+            this->lfo_filter_state.filter_count(filter->get_index()));
     }
 
     return retval;
@@ -117,7 +342,7 @@ line_filter_observer::get_min_count(size_t max) const
 void
 line_filter_observer::clear_deleted_filter_state()
 {
-    uint32_t used_mask = 0;
+    filter_mask used_mask;
 
     for (auto& filter : this->lfo_filter_stack) {
         if (filter->lf_deleted) {
@@ -127,7 +352,7 @@ line_filter_observer::clear_deleted_filter_state()
                       filter->get_lang());
             continue;
         }
-        used_mask |= (1UL << filter->get_index());
+        used_mask.set(filter->get_index());
     }
     this->lfo_filter_state.clear_deleted_filter_state(used_mask);
 }
@@ -32,6 +32,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "base/file_range.hh"
 #include "logfile.hh"
@@ -61,17 +62,40 @@ public:
 
     void logline_eof(const logfile& lf) override;
 
-    bool excluded(uint32_t filter_in_mask,
-                  uint32_t filter_out_mask,
+    void logline_new_messages(const logfile& lf,
+                              std::vector<message_content>& msgs) override;
+
+    bool logline_needs_content(const logfile& lf) const override;
+
+    bool excluded(const filter_mask& filter_in_mask,
+                  const filter_mask& filter_out_mask,
                   size_t offset) const
     {
-        bool filtered_in = (filter_in_mask == 0)
-            || (this->lfo_filter_state.tfs_mask[offset] & filter_in_mask) != 0;
-        bool filtered_out
-            = (this->lfo_filter_state.tfs_mask[offset] & filter_out_mask) != 0;
+        const auto& state = this->lfo_filter_state;
+        const auto* row = state.mask_row(offset);
+        const auto words
+            = std::min(state.tfs_mask_words, filter_mask::MAX_WORDS);
+        uint32_t in_hits = 0;
+        uint32_t out_hits = 0;
+
+        for (size_t lpc = 0; lpc < words; lpc++) {
+            in_hits |= row[lpc] & filter_in_mask.word(lpc);
+            out_hits |= row[lpc] & filter_out_mask.word(lpc);
+        }
+
+        bool filtered_in = filter_in_mask.empty() || in_hits != 0;
+        bool filtered_out = out_hits != 0;
         return !filtered_in || filtered_out;
     }
 
+    /**
+     * Compute the excluded() result for every line in the file as a bitmap
+     * with one bit per line.
+     */
+    void excluded_lines(const filter_mask& filter_in_mask,
+                        const filter_mask& filter_out_mask,
+                        std::vector<uint64_t>& bits_out) const;
+
     size_t get_min_count(size_t max) const;
 
     void clear_deleted_filter_state();
@@ -29,6 +29,9 @@
  * @file grep_proc.cc
  */
 
+#include <algorithm>
+#include <chrono>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -36,20 +39,11 @@
 
 #include <errno.h>
 #include <fcntl.h>
-#include <signal.h>
-#include <stdio.h>
-#include <string.h>
-#include <sys/wait.h>
 #include <unistd.h>
 
-#include "base/auto_pid.hh"
 #include "base/itertools.enumerate.hh"
 #include "base/lnav_log.hh"
-#include "base/opt_util.hh"
-#include "base/string_util.hh"
 #include "config.h"
-#include "lnav_util.hh"
-#include "scn/scan.h"
 #include "vis_line.hh"
 
 template<typename LineType>
@@ -111,24 +105,16 @@ template<typename LineType>
 void
 grep_proc<LineType>::start()
 {
-    static constexpr size_t MAX_CHILDREN = 8;
-
     require(this->invariant());
 
     log_info("grep_proc(%p): start with highest %d",
              this,
              (int) this->gp_highest_line);
-    if (this->children_active() || this->gp_queue.empty()) {
+    if (this->gp_queue.empty()) {
         log_debug("grep_proc(%p): nothing to do?", this);
         return;
     }
 
-    if (this->gp_sink) {
-        // XXX hack to make sure threads used by line_buffer are not active
-        // before the fork.
-        this->gp_sink->grep_quiesce();
-    }
-
     for (const auto& [index, elem] : lnav::itertools::enumerate(this->gp_queue))
     {
         log_info("  queue[%lu]: [%d:%d)",
@@ -137,208 +123,298 @@ grep_proc<LineType>::start()
                  (int) elem.second.ru_line);
     }
 
-    auto num_children = std::min({
+    if (!this->workers_active()) {
+        this->start_workers();
+    }
+
+    // The lines are gathered from the main loop so that this call does not
+    // block.
+    this->wakeup();
+}
+
+template<typename LineType>
+void
+grep_proc<LineType>::start_workers()
+{
+    static constexpr size_t MAX_WORKERS = 8;
+
+    if (this->gp_wakeup_pipe.read_end() == -1) {
+        if (this->gp_wakeup_pipe.open() < 0) {
+            throw error(errno);
+        }
+        this->gp_wakeup_pipe.read_end().non_blocking();
+        this->gp_wakeup_pipe.write_end().non_blocking();
+        log_perror(fcntl(this->gp_wakeup_pipe.read_end(), F_SETFD, FD_CLOEXEC));
+        log_perror(
+            fcntl(this->gp_wakeup_pipe.write_end(), F_SETFD, FD_CLOEXEC));
+    }
+
+    auto worker_count = std::clamp(
         static_cast<size_t>(std::thread::hardware_concurrency()),
-        this->gp_queue.size(),
-        MAX_CHILDREN,
-    });
-    if (num_children == 0) {
-        num_children = 1;
+        (size_t) 1,
+        MAX_WORKERS);
+
+    this->gp_stopping = false;
+    for (size_t lpc = 0; lpc < worker_count; lpc++) {
+        this->gp_workers.emplace_back(std::async(
+            std::launch::async, [this, lpc]() { this->worker_loop(lpc); }));
     }
+    log_debug("grep_proc(%p): started %zu workers", this, worker_count);
+}
 
-    // Distribute queue items round-robin across children.
-    std::vector<std::deque<std::pair<LineType, request_until_t>>> sub_queues(
-        num_children);
-    for (size_t i = 0; i < this->gp_queue.size(); i++) {
-        sub_queues[i % num_children].push_back(this->gp_queue[i]);
+template<typename LineType>
+void
+grep_proc<LineType>::wakeup()
+{
+    static const char BYTE = 0;
+
+    if (this->gp_wakeup_pipe.write_end() != -1) {
+        // The pipe is non-blocking, so a full pipe is fine since the main
+        // loop is going to wake up anyways.
+        (void) !write(this->gp_wakeup_pipe.write_end(), &BYTE, 1);
     }
+}
 
-    this->gp_child_queue_size = this->gp_queue.size();
+template<typename LineType>
+void
+grep_proc<LineType>::worker_loop(size_t index)
+{
+    log_set_thread_prefix(fmt::format(FMT_STRING("grep-{}"), index));
 
-    for (size_t i = 0; i < num_children; i++) {
-        if (sub_queues[i].empty()) {
-            continue;
-        }
+    while (true) {
+        std::unique_ptr<search_batch> batch;
 
-        auto_pipe in_pipe(STDIN_FILENO);
-        auto_pipe out_pipe(STDOUT_FILENO);
-        auto_pipe err_pipe(STDERR_FILENO);
+        {
+            std::unique_lock<std::mutex> lock(this->gp_mutex);
 
-        if (out_pipe.open() < 0) {
-            throw error(errno);
-        }
-        if (err_pipe.open() < 0) {
-            throw error(errno);
+            this->gp_cond.wait(lock, [this]() {
+                return this->gp_stopping || !this->gp_pending.empty();
+            });
+            if (this->gp_stopping) {
+                return;
+            }
+            batch = std::move(this->gp_pending.front());
+            this->gp_pending.pop_front();
         }
 
-        auto child_res = lnav::pid::from_fork();
-        if (child_res.isErr()) {
-            throw error(errno);
-        }
-        auto child = child_res.unwrap();
+        static auto op = lnav_operation{"grep_batch"};
+
+        auto op_guard = lnav_opid_guard::internal(op);
+        for (const auto& bl : batch->sb_lines) {
+            if (this->gp_stopping) {
+                return;
+            }
 
-        if (child.in_child()) {
-            // Need to do this before the after_fork() stuff below
-            lnav::pid::in_child = true;
-            signal(SIGINT, SIG_DFL);
-            signal(SIGTERM, SIG_DFL);
+            uint32_t re_opts = 0;
+            if (bl.bl_valid_utf) {
+                re_opts = PCRE2_NO_UTF_CHECK;
+            }
+            auto line_sf = string_fragment::from_str_range(
+                batch->sb_text, bl.bl_offset, bl.bl_offset + bl.bl_length);
+            auto match_res
+                = this->gp_pcre->find_in(line_sf, re_opts).ignore_error();
+            if (match_res) {
+                batch->sb_matches.emplace_back(bl.bl_line);
+            }
         }
 
-        in_pipe.after_fork(child.in());
-        out_pipe.after_fork(child.in());
-        err_pipe.after_fork(child.in());
+        {
+            std::lock_guard<std::mutex> lock(this->gp_mutex);
 
-        if (child.in_child()) {
-            this->gp_queue = std::move(sub_queues[i]);
-            this->child_init();
-            this->child_loop();
-            _exit(0);
+            auto seq = batch->sb_seq;
+            this->gp_completed.emplace(seq, std::move(batch));
         }
-
-        // Parent: store child state.
-        log_perror(fcntl(out_pipe.read_end(), F_SETFL, O_NONBLOCK));
-        log_perror(fcntl(out_pipe.read_end(), F_SETFD, 1));
-        log_perror(fcntl(err_pipe.read_end(), F_SETFL, O_NONBLOCK));
-        log_perror(fcntl(err_pipe.read_end(), F_SETFD, 1));
-
-        auto cs_ptr = std::make_unique<child_state>(std::move(child));
-        cs_ptr->cs_line_buffer.set_fd(out_pipe.read_end());
-        cs_ptr->cs_err_pipe = std::move(err_pipe.read_end());
-
-        log_debug("grep_proc(%p): started child[%zu] %d",
-                  this,
-                  i,
-                  cs_ptr->cs_child.in());
-        this->gp_children.emplace_back(std::move(cs_ptr));
+        this->wakeup();
     }
+}
 
-    this->gp_queue.clear();
+template<typename LineType>
+void
+grep_proc<LineType>::submit(std::unique_ptr<search_batch> batch)
+{
+    batch->sb_seq = this->gp_next_seq++;
+    {
+        std::lock_guard<std::mutex> lock(this->gp_mutex);
+
+        this->gp_pending.emplace_back(std::move(batch));
+    }
+    this->gp_cond.notify_one();
 }
 
 template<typename LineType>
 void
-grep_proc<LineType>::child_loop()
+grep_proc<LineType>::gather()
 {
-    auto md = lnav::pcre2pp::match_data::unitialized();
-    char outbuf[BUFSIZ * 2];
+    static constexpr size_t BATCH_LINES = 4 * 1024;
+    static constexpr size_t BATCH_BYTES = 1024 * 1024;
+    static constexpr auto GATHER_BUDGET = std::chrono::milliseconds(10);
+
+    const auto max_in_flight = this->gp_workers.size() * 2;
+    const auto deadline = std::chrono::steady_clock::now() + GATHER_BUDGET;
+    std::unique_ptr<search_batch> batch;
     std::string line_value;
+    size_t gathered = 0;
+    auto out_of_time = false;
 
-    /* Make sure buffering is on, not sure of the state in the parent. */
-    if (setvbuf(stdout, outbuf, _IOFBF, BUFSIZ * 2) < 0) {
-        perror("setvbuf");
-    }
-    lnav_log_file
-        = make_optional_from_nullable(fopen("/tmp/lnav.grep.err", "a"));
-    line_value.reserve(BUFSIZ * 2);
-    while (!this->gp_queue.empty()) {
-        LineType start_line = this->gp_queue.front().first;
-        auto stop_line = this->gp_queue.front().second;
-        bool done = false;
-        LineType line;
-
-        this->gp_queue.pop_front();
-        for (line = this->gp_source.grep_initial_line(start_line,
-                                                      this->gp_highest_line);
-             line != -1
-             && (stop_line.ru_type == until_type_t::eof
-                 || line < stop_line.ru_line)
-             && !done;
-             this->gp_source.grep_next_line(line))
+    while (this->gp_next_seq - this->gp_next_deliver_seq < max_in_flight) {
+        if (!this->gp_active) {
+            if (this->gp_queue.empty()) {
+                break;
+            }
+
+            auto [start_line, stop_line] = this->gp_queue.front();
+            this->gp_queue.pop_front();
+            this->gp_active = active_request{
+                this->gp_source.grep_initial_line(start_line,
+                                                  this->gp_highest_line),
+                stop_line,
+            };
+            this->gp_requests_started += 1;
+        }
+        if (!batch) {
+            batch = std::make_unique<search_batch>();
+        }
+
+        auto& ar = this->gp_active.value();
+        if (ar.ar_line != -1
+            && (ar.ar_stop.ru_type == until_type_t::eof
+                || ar.ar_line < ar.ar_stop.ru_line)
+            && !ar.ar_done)
         {
             line_value.clear();
             auto val_res
-                = this->gp_source.grep_value_for_line(line, line_value);
+                = this->gp_source.grep_value_for_line(ar.ar_line, line_value);
             if (!val_res) {
-                done = true;
+                ar.ar_done = true;
             } else {
-                auto li = val_res.value();
-                uint32_t re_opts = 0;
-                if (li.li_utf8_scan_result.is_valid()) {
-                    re_opts = PCRE2_NO_UTF_CHECK;
-                }
-                auto match_res = this->gp_pcre->capture_from(line_value)
-                                     .into(md)
-                                     .matches(re_opts)
-                                     .ignore_error();
-                if (match_res) {
-                    fmt::println(stdout, FMT_STRING("{}"), (int) line);
-                }
+                batch->sb_lines.emplace_back(batch_line{
+                    ar.ar_line,
+                    batch->sb_text.size(),
+                    line_value.size(),
+                    val_res->li_utf8_scan_result.is_valid(),
+                });
+                batch->sb_text.append(line_value);
+            }
+            this->gp_source.grep_next_line(ar.ar_line);
+
+            if (batch->sb_lines.size() >= BATCH_LINES
+                || batch->sb_text.size() >= BATCH_BYTES)
+            {
+                this->submit(std::move(batch));
             }
 
-            if (((line + 1) % 10000) == 0) {
-                /* Periodically flush the buffer so the parent sees progress */
-                this->child_batch();
+            gathered += 1;
+            if ((gathered % 128) == 0
+                && std::chrono::steady_clock::now() > deadline)
+            {
+                out_of_time = true;
+                break;
             }
+            continue;
         }
 
-        if (line > 0 && stop_line.ru_type == until_type_t::eof) {
-            // When scanning to the end of the source, we need to return the
-            // highest line that was seen so that the next request that
+        if (ar.ar_line > 0 && ar.ar_stop.ru_type == until_type_t::eof) {
+            // When scanning to the end of the source, we need to remember
+            // the highest line that was seen so that the next request that
             // continues from the end works properly.
-            fmt::println(stdout, FMT_STRING("h{}"), line - 1);
+            auto highest_line = ar.ar_line - LineType{1};
+            if (highest_line > this->gp_highest_line) {
+                this->gp_highest_line = highest_line;
+                log_debug("grep_proc(%p): highest line is now %d",
+                          this,
+                          (int) this->gp_highest_line);
+            }
         }
-        this->child_term();
+        batch->sb_ended_requests += 1;
+        this->gp_active = std::nullopt;
+    }
+
+    if (batch
+        && (!batch->sb_lines.empty() || batch->sb_ended_requests > 0))
+    {
+        this->submit(std::move(batch));
+    }
+
+    if (out_of_time) {
+        // Make sure the main loop comes back around to pick up where we
+        // left off.
+        this->wakeup();
     }
 }
 
 template<typename LineType>
 void
-grep_proc<LineType>::cleanup()
+grep_proc<LineType>::deliver()
 {
-    for (auto& cs_ptr : this->gp_children) {
-        log_warning("terminating grep child %d", cs_ptr->cs_child.in());
-        kill(cs_ptr->cs_child.in(), SIGTERM);
+    std::vector<std::unique_ptr<search_batch>> ready;
+
+    {
+        std::lock_guard<std::mutex> lock(this->gp_mutex);
+
+        while (true) {
+            auto iter = this->gp_completed.find(this->gp_next_deliver_seq);
+            if (iter == this->gp_completed.end()) {
+                break;
+            }
+            ready.emplace_back(std::move(iter->second));
+            this->gp_completed.erase(iter);
+            this->gp_next_deliver_seq += 1;
+        }
     }
-    for (auto& cs_ptr : this->gp_children) {
-        auto finished = std::move(cs_ptr->cs_child).wait_for_child();
-        log_info("cleaned up grep child %d", finished.in());
+
+    if (ready.empty()) {
+        return;
     }
-    this->gp_children.clear();
 
-    if (this->gp_sink) {
-        for (size_t lpc = 0; lpc < this->gp_child_queue_size; lpc++) {
-            this->gp_sink->grep_end(*this);
+    size_t ended_requests = 0;
+    for (const auto& batch : ready) {
+        if (this->gp_sink != nullptr) {
+            for (const auto& line : batch->sb_matches) {
+                this->gp_sink->grep_match(*this, line);
+            }
         }
+        ended_requests += batch->sb_ended_requests;
     }
-    this->gp_child_queue_size = 0;
 
-    ensure(this->invariant());
+    if (this->gp_sink != nullptr) {
+        this->gp_sink->grep_end_batch(*this);
+    }
 
-    if (!this->gp_queue.empty()) {
-        this->start();
+    ensure(ended_requests <= this->gp_requests_started);
+
+    this->gp_requests_started -= ended_requests;
+    if (this->gp_sink != nullptr) {
+        for (size_t lpc = 0; lpc < ended_requests; lpc++) {
+            this->gp_sink->grep_end(*this);
+        }
     }
 }
 
 template<typename LineType>
 void
-grep_proc<LineType>::dispatch_line(const string_fragment& line)
+grep_proc<LineType>::cleanup()
 {
-    require(line.is_valid());
-
-    auto sv = line.to_string_view();
-    auto h_scan_res = scn::scan<int>(sv, "h{}");
-    if (h_scan_res) {
-        auto highest_line = LineType{h_scan_res->value()};
-        if (highest_line > this->gp_highest_line) {
-            this->gp_highest_line = highest_line;
-            log_debug("grep_proc(%p): highest line is now %d",
-                      this,
-                      (int) this->gp_highest_line);
+    if (this->workers_active()) {
+        {
+            std::lock_guard<std::mutex> lock(this->gp_mutex);
+
+            this->gp_stopping = true;
         }
-    } else {
-        auto ll_scan_res = scn::scan<int>(sv, "{}");
-        if (ll_scan_res) {
-            auto last_line = LineType{ll_scan_res->value()};
-            /* Starting a new line with matches. */
-            /* Pass the match offsets to the sink delegate. */
-            if (this->gp_sink != nullptr) {
-                this->gp_sink->grep_match(*this, last_line);
-            }
-        } else {
-            log_error(
-                "bad line from child -- %.*s", line.length(), line.data());
+        this->gp_cond.notify_all();
+        for (auto& worker : this->gp_workers) {
+            worker.get();
         }
+        this->gp_workers.clear();
+        log_info("grep_proc(%p): stopped workers", this);
     }
+
+    this->gp_pending.clear();
+    this->gp_completed.clear();
+    this->gp_next_seq = 0;
+    this->gp_next_deliver_seq = 0;
+    this->gp_active = std::nullopt;
+
+    ensure(this->invariant());
 }
 
 template<typename LineType>
@@ -347,106 +423,26 @@ grep_proc<LineType>::check_poll_set(const std::vector<struct pollfd>& pollfds)
 {
     require(this->invariant());
 
-    bool any_finished = false;
-
-    for (auto& cs_ptr : this->gp_children) {
-        auto& cs = *cs_ptr;
-        if (cs.cs_err_pipe != -1 && pollfd_ready(pollfds, cs.cs_err_pipe)) {
-            char buffer[1024 + 1];
-            ssize_t rc;
-
-            rc = read(cs.cs_err_pipe, buffer, sizeof(buffer) - 1);
-            if (rc > 0) {
-                static const char* PREFIX = ": ";
-
-                buffer[rc] = '\0';
-                if (strncmp(buffer, PREFIX, strlen(PREFIX)) == 0) {
-                    char* lf;
-
-                    if ((lf = strchr(buffer, '\n')) != nullptr) {
-                        *lf = '\0';
-                    }
-                    if (this->gp_control != nullptr) {
-                        this->gp_control->grep_error(&buffer[strlen(PREFIX)]);
-                    }
-                }
-            } else if (rc == 0) {
-                cs.cs_err_pipe.reset();
-            }
-        }
+    if (!this->workers_active()) {
+        return;
+    }
 
-        if (cs.cs_line_buffer.get_fd() != -1
-            && pollfd_ready(pollfds, cs.cs_line_buffer.get_fd()))
+    if (pollfd_ready(pollfds, this->gp_wakeup_pipe.read_end())) {
+        char buffer[128];
+
+        while (read(this->gp_wakeup_pipe.read_end(), buffer, sizeof(buffer))
+               > 0)
         {
-            try {
-                static const int MAX_LOOPS = 100;
-
-                int loop_count = 0;
-                bool drained = false;
-
-                while (loop_count < MAX_LOOPS) {
-                    auto load_result
-                        = cs.cs_line_buffer.load_next_line(cs.cs_pipe_range);
-
-                    if (load_result.isErr()) {
-                        log_error("failed to read from grep_proc child: %s",
-                                  load_result.unwrapErr().c_str());
-                        break;
-                    }
-
-                    auto li = load_result.unwrap();
-
-                    if (li.li_file_range.empty()) {
-                        drained = true;
-                        break;
-                    }
-
-                    cs.cs_pipe_range = li.li_file_range;
-                    cs.cs_line_buffer.read_range(li.li_file_range)
-                        .then([this](auto sbr) {
-                            sbr.rtrim(is_line_ending);
-                            this->dispatch_line(sbr.to_string_fragment());
-                        });
-
-                    loop_count += 1;
-                }
-
-                if (this->gp_sink != nullptr) {
-                    this->gp_sink->grep_end_batch(*this);
-                }
-
-                if (drained && cs.cs_line_buffer.is_pipe_closed()) {
-                    cs.cs_pipe_range.clear();
-                    cs.cs_line_buffer.reset();
-                    auto finished = std::move(cs.cs_child).wait_for_child();
-                    log_info("grep child %d finished with %d",
-                             finished.in(),
-                             finished.status());
-                    any_finished = true;
-                }
-            } catch (line_buffer::error& e) {
-                cs.cs_pipe_range.clear();
-                cs.cs_line_buffer.reset();
-                auto finished = std::move(cs.cs_child).wait_for_child();
-                log_info("grep child %d finished (error)", finished.in());
-                any_finished = true;
-            }
         }
     }
 
-    if (any_finished) {
-        // Remove children that have been waited on (pid == -1 after move).
-        this->gp_children.erase(
-            std::remove_if(this->gp_children.begin(),
-                           this->gp_children.end(),
-                           [](const std::unique_ptr<child_state>& cs_ptr) {
-                               return cs_ptr->cs_child.in() == -1;
-                           }),
-            this->gp_children.end());
-
-        if (this->gp_children.empty()) {
-            this->cleanup();
-        }
+    this->deliver();
+    this->gather();
+
+    if (!this->gp_active && this->gp_queue.empty()
+        && this->gp_next_seq == this->gp_next_deliver_seq)
+    {
+        this->cleanup();
     }
 
     ensure(this->invariant());
@@ -457,14 +453,16 @@ grep_proc<LineType>&
 grep_proc<LineType>::invalidate()
 {
     log_debug("grep_proc(%p): invalidated", this);
+    this->cleanup();
     if (this->gp_sink) {
-        for (size_t lpc = 0; lpc < this->gp_queue.size(); lpc++) {
+        auto unfinished = this->gp_queue.size() + this->gp_requests_started;
+        for (size_t lpc = 0; lpc < unfinished; lpc++) {
             this->gp_sink->grep_end(*this);
         }
     }
     this->gp_queue.clear();
+    this->gp_requests_started = 0;
     this->gp_highest_line = LineType{0};
-    this->cleanup();
     return *this;
 }
 
@@ -472,14 +470,8 @@ template<typename LineType>
 void
 grep_proc<LineType>::update_poll_set(std::vector<pollfd>& pollfds)
 {
-    for (auto& cs_ptr : this->gp_children) {
-        if (cs_ptr->cs_line_buffer.get_fd() != -1) {
-            pollfds.push_back(
-                pollfd{cs_ptr->cs_line_buffer.get_fd(), POLLIN, 0});
-        }
-        if (cs_ptr->cs_err_pipe.get() != -1) {
-            pollfds.push_back(pollfd{cs_ptr->cs_err_pipe, POLLIN, 0});
-        }
+    if (this->workers_active()) {
+        pollfds.push_back(pollfd{this->gp_wakeup_pipe.read_end(), POLLIN, 0});
     }
 }
 
@@ -32,20 +32,22 @@
 #ifndef grep_proc_hh
 #define grep_proc_hh
 
+#include <atomic>
+#include <condition_variable>
 #include <deque>
 #include <exception>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
-#include <thread>
 #include <vector>
 
 #include <poll.h>
-#include <stdio.h>
 #include <sys/types.h>
-#include <unistd.h>
 
 #include "base/auto_fd.hh"
-#include "base/auto_pid.hh"
 #include "base/lnav_log.hh"
 #include "line_buffer.hh"
 #include "mapbox/variant.hpp"
@@ -110,8 +112,6 @@ class grep_proc_sink {
 public:
     virtual ~grep_proc_sink() = default;
 
-    virtual void grep_quiesce() {}
-
     /** Called at the start of a new grep run. */
     virtual void grep_begin(grep_proc<LineType>& gp,
                             LineType start,
@@ -137,11 +137,12 @@ public:
 };
 
 /**
- * "Grep" that runs in a separate process so it doesn't stall user-interaction.
- * This class manages the child process and any interactions between the parent
- * and child.  The source data to be matched comes from the grep_proc_source
- * delegate and the results are sent to the grep_proc_sink delegate in the
- * parent process.
+ * "Grep" that runs on a pool of worker threads so it doesn't stall
+ * user-interaction.  The values of the lines to be matched are pulled from
+ * the grep_proc_source delegate on the main thread in small batches, since
+ * the sources are not thread-safe, and handed off to the workers for
+ * matching.  The results are passed to the grep_proc_sink delegate on the
+ * main thread, in line order, as the batches are finished.
  *
  * Note: The "grep" executable is not actually used, instead we use the pcre(3)
  * library directly.
@@ -158,7 +159,7 @@ public:
 
     /**
      * Construct a grep_proc object.  You must call the start() method
-     * to fork off the child process and begin processing.
+     * to begin processing.
      *
      * @param code The pcre code to run over the lines of input.
      * @param gps The source of the data to match.
@@ -231,58 +232,88 @@ public:
      */
     void check_poll_set(const std::vector<struct pollfd>& pollfds) override;
 
-    bool children_active() const { return !this->gp_children.empty(); }
+    bool workers_active() const { return !this->gp_workers.empty(); }
 
     /** Check the invariants for this object. */
     bool invariant() { return true; }
 
-    struct child_state {
-        auto_pid<process_state::running> cs_child;
-        auto_fd cs_err_pipe;
-        line_buffer cs_line_buffer;
-        file_range cs_pipe_range;
+protected:
+    struct batch_line {
+        LineType bl_line;
+        size_t bl_offset;
+        size_t bl_length;
+        bool bl_valid_utf;
+    };
 
-        explicit child_state(auto_pid<process_state::running> child)
-            : cs_child(std::move(child))
-        {
-        }
+    /**
+     * A group of line values that is matched by a worker.
+     */
+    struct search_batch {
+        size_t sb_seq{0};
+        std::string sb_text;
+        std::vector<batch_line> sb_lines;
+        std::vector<LineType> sb_matches;
+        /** The number of requests that were finished by this batch. */
+        size_t sb_ended_requests{0};
+    };
+
+    /** The state of the request whose lines are being gathered. */
+    struct active_request {
+        LineType ar_line;
+        request_until_t ar_stop;
+        bool ar_done{false};
     };
 
-protected:
     /**
-     * Dispatch a line received from the child.
+     * Pull line values from the source and hand them off to the workers
+     * until there are enough batches in flight or the time budget runs out.
      */
-    void dispatch_line(const string_fragment& line);
+    void gather();
+
+    void submit(std::unique_ptr<search_batch> batch);
 
     /**
-     * Free any resources used by the object and make sure the child has been
-     * terminated.
+     * Pass the results of finished batches to the sink.
      */
-    void cleanup();
+    void deliver();
 
-    void child_loop();
+    void worker_loop(size_t index);
 
-    virtual void child_init() {};
+    void start_workers();
 
-    virtual void child_batch() { fflush(stdout); }
+    void wakeup();
 
-    virtual void child_term() { fflush(stdout); }
+    /**
+     * Stop the workers and drop any batches that have not been delivered.
+     */
+    void cleanup();
 
     std::shared_ptr<lnav::pcre2pp::code> gp_pcre;
     grep_proc_source<LineType>& gp_source; /*< The data source delegate. */
 
-    std::vector<std::unique_ptr<child_state>> gp_children;
-    size_t gp_child_queue_size{0};
-
     /** The queue of search requests. */
     std::deque<std::pair<LineType, request_until_t>> gp_queue;
+    std::optional<active_request> gp_active;
+    /** The number of requests taken off the queue that have not ended. */
+    size_t gp_requests_started{0};
     LineType gp_highest_line{0}; /*< The highest numbered line processed
-                                  * by the grep child process.  This
-                                  * value is used when the start line
-                                  * for a queued request is -1.
+                                  * by the search.  This value is used when
+                                  * the start line for a queued request is
+                                  * -1.
                                   */
     grep_proc_sink<LineType>* gp_sink{nullptr}; /*< The sink delegate. */
     grep_proc_control* gp_control{nullptr}; /*< The control delegate. */
+
+    auto_pipe gp_wakeup_pipe;
+    std::vector<std::future<void>> gp_workers;
+    size_t gp_next_seq{0};
+    size_t gp_next_deliver_seq{0};
+
+    std::mutex gp_mutex;
+    std::condition_variable gp_cond;
+    std::atomic_bool gp_stopping{false};
+    std::deque<std::unique_ptr<search_batch>> gp_pending;
+    std::map<size_t, std::unique_ptr<search_batch>> gp_completed;
 };
 
 #endif
@@ -42,7 +42,9 @@
 #endif
 
 #include <algorithm>
+#include <functional>
 #include <set>
+#include <thread>
 
 #include "base/auto_mem.hh"
 #include "base/auto_pid.hh"
@@ -146,6 +148,7 @@ line_buffer::gz_indexed::close()
 {
     // Release old stream, if we were open
     if (*this) {
+        this->save_index_cache();
         inflateEnd(&this->strm);
         ::close(this->gz_fd);
         this->syncpoints.clear();
@@ -259,6 +262,8 @@ line_buffer::gz_indexed::open(int fd, lnav::gzip::header& hd)
     } else {
         log_error("%d: unable to get gzip header", fd);
     }
+
+    this->load_index_cache();
 }
 
 int
@@ -373,6 +378,176 @@ line_buffer::gz_indexed::read(void* buf, size_t offset, size_t size)
     return bytes;
 }
 
+static constexpr char GZ_INDEX_CACHE_MAGIC[] = "lnav-gzi";
+static constexpr uint32_t GZ_INDEX_CACHE_VERSION = 1;
+
+static std::filesystem::path
+gzip_index_cache_path()
+{
+    return lnav::paths::workdir() / "gzip-index";
+}
+
+void
+line_buffer::gz_indexed::load_index_cache()
+{
+    struct stat st;
+
+    this->gz_index_cache_path = std::nullopt;
+    this->gz_index_cache_count = 0;
+    if (fstat(this->gz_fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+        return;
+    }
+
+    auto key = hasher()
+                   .update(st.st_dev)
+                   .update(st.st_ino)
+                   .update(st.st_size)
+                   .update(st.st_mtime)
+                   .to_string();
+    this->gz_index_cache_path
+        = gzip_index_cache_path() / key.substr(0, 2) / key;
+
+    auto read_res
+        = lnav::filesystem::read_file(this->gz_index_cache_path.value());
+    if (read_res.isErr()) {
+        return;
+    }
+
+    auto content = read_res.unwrap();
+    auto remaining = string_fragment::from_str(content);
+    auto read_bytes = [&remaining](void* dst, size_t len) {
+        if (remaining.length() < (ssize_t) len) {
+            return false;
+        }
+        memcpy(dst, remaining.data(), len);
+        remaining = remaining.substr(len);
+        return true;
+    };
+
+    char magic[sizeof(GZ_INDEX_CACHE_MAGIC)];
+    uint32_t version = 0;
+    uint64_t count = 0;
+    if (!read_bytes(magic, sizeof(magic))
+        || memcmp(magic, GZ_INDEX_CACHE_MAGIC, sizeof(magic)) != 0
+        || !read_bytes(&version, sizeof(version))
+        || version != GZ_INDEX_CACHE_VERSION
+        || !read_bytes(&count, sizeof(count)))
+    {
+        log_warning("%d: ignoring invalid gzip index cache -- %s",
+                    this->gz_fd,
+                    this->gz_index_cache_path->c_str());
+        return;
+    }
+
+    std::vector<indexDict> syncpoints;
+    syncpoints.reserve(count);
+    for (uint64_t lpc = 0; lpc < count; lpc++) {
+        auto& dict = syncpoints.emplace_back();
+        int64_t in = 0, out = 0;
+        uint32_t zlen = 0;
+
+        if (!read_bytes(&in, sizeof(in)) || !read_bytes(&out, sizeof(out))
+            || !read_bytes(&dict.bits, sizeof(dict.bits))
+            || !read_bytes(&dict.in_bits, sizeof(dict.in_bits))
+            || !read_bytes(&zlen, sizeof(zlen))
+            || remaining.length() < (ssize_t) zlen)
+        {
+            log_warning("%d: truncated gzip index cache", this->gz_fd);
+            return;
+        }
+        if (in >= st.st_size
+            || (lpc > 0
+                && (in <= syncpoints[lpc - 1].in
+                    || out <= syncpoints[lpc - 1].out)))
+        {
+            log_warning("%d: gzip index cache does not match the file",
+                        this->gz_fd);
+            return;
+        }
+        dict.in = in;
+        dict.out = out;
+
+        uLongf index_len = sizeof(dict.index);
+        auto rc = uncompress(
+            dict.index, &index_len, (const Bytef*) remaining.data(), zlen);
+        if (rc != Z_OK || index_len != sizeof(dict.index)) {
+            log_warning("%d: unable to decompress gzip index cache window",
+                        this->gz_fd);
+            return;
+        }
+        remaining = remaining.substr(zlen);
+    }
+
+    log_info("%d: loaded %zu syncpoints from gzip index cache -- %s",
+             this->gz_fd,
+             syncpoints.size(),
+             this->gz_index_cache_path->c_str());
+    this->syncpoints = std::move(syncpoints);
+    this->gz_index_cache_count = this->syncpoints.size();
+}
+
+void
+line_buffer::gz_indexed::save_index_cache()
+{
+    if (!this->gz_index_cache_path
+        || this->syncpoints.size() <= this->gz_index_cache_count)
+    {
+        return;
+    }
+
+    uint64_t count = this->syncpoints.size();
+    std::string content;
+    content.append(GZ_INDEX_CACHE_MAGIC, sizeof(GZ_INDEX_CACHE_MAGIC));
+    content.append((const char*) &GZ_INDEX_CACHE_VERSION,
+                   sizeof(GZ_INDEX_CACHE_VERSION));
+    content.append((const char*) &count, sizeof(count));
+
+    /*
+     * The windows are mostly plain text, so they are compressed to keep
+     * the cache for a large file down to a reasonable size.
+     */
+    auto zbuf = auto_mem<Bytef>::malloc(compressBound(GZ_WINSIZE));
+    for (const auto& dict : this->syncpoints) {
+        int64_t in = dict.in, out = dict.out;
+        uLongf zlen = compressBound(GZ_WINSIZE);
+
+        auto rc = compress2(
+            zbuf.in(), &zlen, dict.index, sizeof(dict.index), Z_BEST_SPEED);
+        if (rc != Z_OK) {
+            log_error("%d: unable to compress gzip index window: %d",
+                      this->gz_fd,
+                      rc);
+            return;
+        }
+
+        uint32_t zlen32 = zlen;
+        content.append((const char*) &in, sizeof(in));
+        content.append((const char*) &out, sizeof(out));
+        content.append((const char*) &dict.bits, sizeof(dict.bits));
+        content.append((const char*) &dict.in_bits, sizeof(dict.in_bits));
+        content.append((const char*) &zlen32, sizeof(zlen32));
+        content.append((const char*) zbuf.in(), zlen);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(
+        this->gz_index_cache_path->parent_path(), ec);
+    auto write_res = lnav::filesystem::write_file(
+        this->gz_index_cache_path.value(), string_fragment::from_str(content));
+    if (write_res.isErr()) {
+        log_error("%d: unable to write gzip index cache -- %s",
+                  this->gz_fd,
+                  write_res.unwrapErr().c_str());
+        return;
+    }
+
+    log_info("%d: saved %zu syncpoints to gzip index cache -- %s",
+             this->gz_fd,
+             this->syncpoints.size(),
+             this->gz_index_cache_path->c_str());
+    this->gz_index_cache_count = this->syncpoints.size();
+}
+
 line_buffer::line_buffer()
 {
     this->lb_gz_file.writeAccess()->parent = this;
@@ -1641,6 +1816,455 @@ line_buffer_cache_path()
     return lnav::paths::workdir() / "buffer-cache";
 }
 
+/**
+ * Files that are smaller than this are not worth the trouble of
+ * decompressing in parallel.
+ */
+static constexpr file_ssize_t PARALLEL_DECOMPRESS_MIN_SIZE = 32 * 1024 * 1024;
+static constexpr size_t MEMBER_IO_SIZE = 1024 * 1024;
+static constexpr file_ssize_t MEMBER_SCAN_LIMIT = 16 * 1024 * 1024;
+static constexpr size_t MEMBER_TRIAL_SIZE = 64 * 1024;
+
+/**
+ * Interface for decompressing a sequence of independently compressed
+ * members, like the ones in a concatenated gzip or bzip2 file.
+ */
+class member_decoder {
+public:
+    enum class step_result {
+        error,
+        ok,
+        member_end,
+    };
+
+    virtual ~member_decoder() = default;
+
+    /**
+     * @return True if the given data looks like the start of a member.
+     */
+    virtual bool is_header(const unsigned char* data, size_t len) const = 0;
+
+    /**
+     * Decompress some of the input, updating the lengths to reflect what
+     * was consumed and produced.
+     */
+    virtual step_result step(const unsigned char*& in,
+                             size_t& in_len,
+                             unsigned char* out,
+                             size_t& out_len)
+        = 0;
+
+    /** Prepare for the start of the next member. */
+    virtual bool reset() = 0;
+};
+
+class gzip_member_decoder : public member_decoder {
+public:
+    gzip_member_decoder()
+    {
+        this->gmd_valid = inflateInit2(&this->gmd_strm, 15 + 16) == Z_OK;
+    }
+
+    ~gzip_member_decoder() override
+    {
+        if (this->gmd_valid) {
+            inflateEnd(&this->gmd_strm);
+        }
+    }
+
+    bool is_header(const unsigned char* data, size_t len) const override
+    {
+        return len >= 10 && data[0] == 0x1f && data[1] == 0x8b
+            && data[2] == Z_DEFLATED && (data[3] & 0xe0) == 0;
+    }
+
+    step_result step(const unsigned char*& in,
+                     size_t& in_len,
+                     unsigned char* out,
+                     size_t& out_len) override
+    {
+        if (!this->gmd_valid) {
+            return step_result::error;
+        }
+
+        this->gmd_strm.next_in = const_cast<unsigned char*>(in);
+        this->gmd_strm.avail_in = in_len;
+        this->gmd_strm.next_out = out;
+        this->gmd_strm.avail_out = out_len;
+
+        auto rc = inflate(&this->gmd_strm, Z_NO_FLUSH);
+        in = this->gmd_strm.next_in;
+        in_len = this->gmd_strm.avail_in;
+        out_len = out_len - this->gmd_strm.avail_out;
+        switch (rc) {
+            case Z_OK:
+                return step_result::ok;
+            case Z_STREAM_END:
+                return step_result::member_end;
+            default:
+                return step_result::error;
+        }
+    }
+
+    bool reset() override { return inflateReset(&this->gmd_strm) == Z_OK; }
+
+private:
+    z_stream gmd_strm{};
+    bool gmd_valid{false};
+};
+
+#ifdef HAVE_BZLIB_H
+class bzip2_member_decoder : public member_decoder {
+public:
+    bzip2_member_decoder() { this->reset(); }
+
+    ~bzip2_member_decoder() override
+    {
+        if (this->bmd_valid) {
+            BZ2_bzDecompressEnd(&this->bmd_strm);
+        }
+    }
+
+    bool is_header(const unsigned char* data, size_t len) const override
+    {
+        static constexpr unsigned char BLOCK_MAGIC[]
+            = {0x31, 0x41, 0x59, 0x26, 0x53, 0x59};
+
+        return len >= 10 && data[0] == 'B' && data[1] == 'Z'
+            && data[2] == 'h' && '1' <= data[3] && data[3] <= '9'
+            && memcmp(&data[4], BLOCK_MAGIC, sizeof(BLOCK_MAGIC)) == 0;
+    }
+
+    step_result step(const unsigned char*& in,
+                     size_t& in_len,
+                     unsigned char* out,
+                     size_t& out_len) override
+    {
+        if (!this->bmd_valid) {
+            return step_result::error;
+        }
+
+        this->bmd_strm.next_in = (char*) in;
+        this->bmd_strm.avail_in = in_len;
+        this->bmd_strm.next_out = (char*) out;
+        this->bmd_strm.avail_out = out_len;
+
+        auto rc = BZ2_bzDecompress(&this->bmd_strm);
+        in = (const unsigned char*) this->bmd_strm.next_in;
+        in_len = this->bmd_strm.avail_in;
+        out_len = out_len - this->bmd_strm.avail_out;
+        switch (rc) {
+            case BZ_OK:
+                return step_result::ok;
+            case BZ_STREAM_END:
+                return step_result::member_end;
+            default:
+                return step_result::error;
+        }
+    }
+
+    bool reset() override
+    {
+        // There is no reset for bzip2 streams, so start over.
+        if (this->bmd_valid) {
+            BZ2_bzDecompressEnd(&this->bmd_strm);
+        }
+        this->bmd_strm = bz_stream{};
+        this->bmd_valid = BZ2_bzDecompressInit(&this->bmd_strm, 0, 0) == BZ_OK;
+        return this->bmd_valid;
+    }
+
+private:
+    bz_stream bmd_strm{};
+    bool bmd_valid{false};
+};
+#endif
+
+/**
+ * Decompress the members in the given range of the file.  The range must
+ * start at the beginning of a member and end exactly where a member ends.
+ *
+ * @param out_fd The file to write the decompressed data to or -1 to
+ *   discard it.
+ * @param max_out Stop successfully after this much data has been produced.
+ * @return True if the range was decompressed without error.
+ */
+static bool
+decompress_members(member_decoder& md,
+                   int in_fd,
+                   file_range range,
+                   int out_fd,
+                   size_t max_out = SIZE_MAX)
+{
+    auto inbuf = auto_mem<unsigned char>::malloc(MEMBER_IO_SIZE);
+    auto outbuf = auto_mem<unsigned char>::malloc(MEMBER_IO_SIZE);
+    const unsigned char* next_in = nullptr;
+    size_t avail_in = 0;
+    auto in_off = range.fr_offset;
+    size_t total_out = 0;
+    auto at_member_end = false;
+
+    if (inbuf == nullptr || outbuf == nullptr) {
+        return false;
+    }
+
+    while (true) {
+        if (avail_in == 0) {
+            if (in_off >= range.next_offset()) {
+                break;
+            }
+
+            auto to_read = std::min(static_cast<file_ssize_t>(MEMBER_IO_SIZE),
+                                    range.next_offset() - in_off);
+            auto rc = pread(in_fd, inbuf.in(), to_read, in_off);
+            if (rc <= 0) {
+                return false;
+            }
+            in_off += rc;
+            next_in = inbuf.in();
+            avail_in = rc;
+        }
+
+        size_t out_len = MEMBER_IO_SIZE;
+        auto step_res = md.step(next_in, avail_in, outbuf.in(), out_len);
+        switch (step_res) {
+            case member_decoder::step_result::error:
+                return false;
+            case member_decoder::step_result::ok:
+                at_member_end = false;
+                break;
+            case member_decoder::step_result::member_end:
+                at_member_end = true;
+                if (!md.reset()) {
+                    return false;
+                }
+                break;
+        }
+
+        if (out_fd != -1) {
+            const auto* out_data = outbuf.in();
+            while (out_len > 0) {
+                auto rc = write(out_fd, out_data, out_len);
+                if (rc == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                out_data += rc;
+                out_len -= rc;
+                total_out += rc;
+            }
+        } else {
+            total_out += out_len;
+        }
+        if (total_out >= max_out) {
+            return true;
+        }
+    }
+
+    return at_member_end;
+}
+
+/**
+ * Find the offsets of members in the file that can be used to split the
+ * decompression work into roughly equal parts.  Candidate offsets are
+ * confirmed by decompressing a little bit of data from them since the
+ * header bytes can show up inside compressed data as well.
+ */
+static std::vector<file_off_t>
+find_member_boundaries(const std::function<std::unique_ptr<member_decoder>()>&
+                           decoder_factory,
+                       int fd,
+                       file_ssize_t size,
+                       size_t max_parts)
+{
+    std::vector<file_off_t> retval = {0};
+    auto probe = decoder_factory();
+    auto buf = auto_mem<unsigned char>::malloc(MEMBER_IO_SIZE);
+    auto chunk_size = size / max_parts;
+
+    for (size_t part = 1; part < max_parts; part++) {
+        auto scan_off = std::max(static_cast<file_off_t>(part * chunk_size),
+                                 retval.back() + 1);
+        auto scan_end = std::min(scan_off + MEMBER_SCAN_LIMIT, size);
+        auto found = false;
+
+        while (!found && scan_off < scan_end) {
+            auto rc = pread(fd, buf.in(), MEMBER_IO_SIZE, scan_off);
+            if (rc <= 0) {
+                break;
+            }
+            for (ssize_t lpc = 0; lpc + 10 <= rc; lpc++) {
+                if (!probe->is_header(&buf[lpc], rc - lpc)) {
+                    continue;
+                }
+
+                auto trial = decoder_factory();
+                auto cand_off = scan_off + lpc;
+                if (decompress_members(*trial,
+                                       fd,
+                                       file_range{cand_off, size - cand_off},
+                                       -1,
+                                       MEMBER_TRIAL_SIZE))
+                {
+                    retval.emplace_back(cand_off);
+                    found = true;
+                    break;
+                }
+            }
+            // overlap the windows a little so a header is not split
+            scan_off += std::max(rc - 10, ssize_t{1});
+        }
+    }
+
+    return retval;
+}
+
+std::function<std::unique_ptr<member_decoder>()>
+line_buffer::member_decoder_factory() const
+{
+    if (!this->lb_seekable || !this->lb_compressed) {
+        return nullptr;
+    }
+#ifdef HAVE_BZLIB_H
+    if (this->lb_bz_file) {
+        return [] { return std::make_unique<bzip2_member_decoder>(); };
+    }
+#endif
+    return [] { return std::make_unique<gzip_member_decoder>(); };
+}
+
+bool
+line_buffer::has_independent_members() const
+{
+    struct stat st;
+
+    if (std::thread::hardware_concurrency() < 2 || fstat(this->lb_fd, &st) == -1
+        || st.st_size < PARALLEL_DECOMPRESS_MIN_SIZE)
+    {
+        return false;
+    }
+
+    auto factory = this->member_decoder_factory();
+    if (!factory) {
+        return false;
+    }
+
+    return find_member_boundaries(factory, this->lb_fd, st.st_size, 2).size()
+        > 1;
+}
+
+bool
+line_buffer::decompress_in_parallel(const std::filesystem::path& tmp_pattern,
+                                    int write_fd)
+{
+    struct stat st;
+
+    if (fstat(this->lb_fd, &st) == -1
+        || st.st_size < PARALLEL_DECOMPRESS_MIN_SIZE)
+    {
+        return false;
+    }
+
+    auto factory = this->member_decoder_factory();
+    if (!factory) {
+        return false;
+    }
+
+    auto starts = find_member_boundaries(
+        factory, this->lb_fd, st.st_size, std::thread::hardware_concurrency());
+    if (starts.size() < 2) {
+        return false;
+    }
+    starts.emplace_back(st.st_size);
+
+    log_info("%d: decompressing %zu parts in parallel",
+             this->lb_fd.get(),
+             starts.size() - 1);
+
+    std::vector<std::future<std::optional<auto_fd>>> workers;
+    for (size_t lpc = 0; lpc + 1 < starts.size(); lpc++) {
+        auto range = file_range{starts[lpc], starts[lpc + 1] - starts[lpc]};
+
+        workers.emplace_back(std::async(
+            std::launch::async,
+            [factory, range, tmp_pattern, in_fd = this->lb_fd.get()]()
+                -> std::optional<auto_fd> {
+                log_set_thread_prefix("decompress");
+
+                auto tmp_res = lnav::filesystem::open_temp_file(tmp_pattern);
+                if (tmp_res.isErr()) {
+                    log_error("unable to create temp file for decompression: "
+                              "%s",
+                              tmp_res.unwrapErr().c_str());
+                    return std::nullopt;
+                }
+
+                auto [tmp_path, tmp_fd] = tmp_res.unwrap();
+                std::error_code ec;
+                std::filesystem::remove(tmp_path, ec);
+
+                auto decoder = factory();
+                if (!decompress_members(*decoder, in_fd, range, tmp_fd.get())) {
+                    log_warning("failed to decompress range %lld-%lld",
+                                range.fr_offset,
+                                range.next_offset());
+                    return std::nullopt;
+                }
+                return std::move(tmp_fd);
+            }));
+    }
+
+    std::vector<auto_fd> parts;
+    for (auto& worker : workers) {
+        auto part_opt = worker.get();
+        if (part_opt) {
+            parts.emplace_back(std::move(part_opt.value()));
+        }
+    }
+    if (parts.size() != workers.size()) {
+        return false;
+    }
+
+    auto buf = auto_mem<char>::malloc(MEMBER_IO_SIZE);
+    for (auto& part_fd : parts) {
+        file_off_t part_off = 0;
+
+        while (true) {
+            auto rc = pread(part_fd, buf.in(), MEMBER_IO_SIZE, part_off);
+            if (rc == -1 && errno == EINTR) {
+                continue;
+            }
+            if (rc < 0) {
+                return false;
+            }
+            if (rc == 0) {
+                break;
+            }
+            part_off += rc;
+
+            const auto* data = buf.in();
+            while (rc > 0) {
+                auto wrc = write(write_fd, data, rc);
+                if (wrc == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    log_error("%d: unable to write to cache -- %s",
+                              this->lb_fd.get(),
+                              strerror(errno));
+                    return false;
+                }
+                data += wrc;
+                rc -= wrc;
+            }
+        }
+    }
+
+    return true;
+}
+
 void
 line_buffer::enable_cache()
 {
@@ -1701,6 +2325,18 @@ line_buffer::enable_cache()
     auto write_fd = create_res.unwrap();
     auto done = false;
 
+    auto tmp_pattern = cache_dir / fmt::format(FMT_STRING("{}.part.XXXXXX"),
+                                               cached_base_name);
+    if (this->decompress_in_parallel(tmp_pattern, write_fd)) {
+        log_info("%d: parallel decompression finished", this->lb_fd.get());
+        done = true;
+    } else if (ftruncate(write_fd, 0) == -1
+               || lseek(write_fd, 0, SEEK_SET) == -1)
+    {
+        log_error("%d: unable to reset cache file", this->lb_fd.get());
+        return;
+    }
+
     static constexpr ssize_t FILL_LENGTH = 1024 * 1024;
     auto off = file_off_t{0};
     while (!done) {
@@ -1736,23 +2372,33 @@ line_buffer::cleanup_cache()
     return std::async(
         std::launch::async, +[]() {
             auto now = std::filesystem::file_time_type::clock::now();
-            auto cache_path = line_buffer_cache_path();
+            // The gzip indexes are much smaller than the decompressed
+            // content, so they can stick around longer.
+            const std::pair<std::filesystem::path,
+                            std::filesystem::file_time_type::duration>
+                cache_paths[] = {
+                    {line_buffer_cache_path(), 1h},
+                    {gzip_index_cache_path(), 24h * 7},
+                };
             std::vector<std::filesystem::path> to_remove;
             std::error_code ec;
 
-            for (const auto& cache_subdir :
-                 std::filesystem::directory_iterator(cache_path, ec))
-            {
-                for (const auto& entry :
-                     std::filesystem::directory_iterator(cache_subdir, ec))
+            for (const auto& [cache_path, ttl] : cache_paths) {
+                for (const auto& cache_subdir :
+                     std::filesystem::directory_iterator(cache_path, ec))
                 {
-                    auto mtime = std::filesystem::last_write_time(entry.path());
-                    auto exp_time = mtime + 1h;
-                    if (now < exp_time) {
-                        continue;
+                    for (const auto& entry :
+                         std::filesystem::directory_iterator(cache_subdir, ec))
+                    {
+                        auto mtime
+                            = std::filesystem::last_write_time(entry.path());
+                        auto exp_time = mtime + ttl;
+                        if (now < exp_time) {
+                            continue;
+                        }
+
+                        to_remove.emplace_back(entry.path());
                     }
-
-                    to_remove.emplace_back(entry.path());
                 }
             }
 
@@ -34,7 +34,11 @@
 
 #include <array>
 #include <exception>
+#include <filesystem>
+#include <functional>
 #include <future>
+#include <memory>
+#include <optional>
 #include <vector>
 
 #include <errno.h>
@@ -55,6 +59,8 @@
 #include "safe/safe.h"
 #include "shared_buffer.hh"
 
+class member_decoder;
+
 struct line_info {
     file_range li_file_range;
     timeval li_timestamp{0, 0};
@@ -120,12 +126,25 @@ public:
          */
         int read(void* buf, size_t offset, size_t size);
 
+        /**
+         * Load the syncpoints that were found during a previous run from
+         * the cache directory.
+         */
+        void load_index_cache();
+
+        /**
+         * Write out the syncpoints if any new ones were discovered since
+         * the file was opened.
+         */
+        void save_index_cache();
+
         struct indexDict {
             off_t in = 0;
             off_t out = 0;
             unsigned char bits = 0;
             unsigned char in_bits = 0;
             Bytef index[GZ_WINSIZE];
+            indexDict() = default;
             indexDict(z_stream const& s, const file_size_t size);
 
             int apply(z_streamp s);
@@ -137,6 +156,9 @@ public:
             syncpoints; /*< indexed dictionaries as discovered */
         auto_mem<Bytef> inbuf; /*< Compressed data buffer */
         int gz_fd = -1; /*< The file to read data from. */
+        std::optional<std::filesystem::path>
+            gz_index_cache_path; /*< Where the syncpoints are persisted. */
+        size_t gz_index_cache_count{0}; /*< Syncpoints already persisted. */
     };
 
     /** Construct an empty line_buffer. */
@@ -263,6 +285,18 @@ public:
                 && this->s_used_preloads == 0;
         }
 
+        stats& operator+=(const stats& rhs)
+        {
+            this->s_decompressions += rhs.s_decompressions;
+            this->s_preads += rhs.s_preads;
+            this->s_requested_preloads += rhs.s_requested_preloads;
+            this->s_used_preloads += rhs.s_used_preloads;
+            for (size_t lpc = 0; lpc < this->s_hist.size(); lpc++) {
+                this->s_hist[lpc] += rhs.s_hist[lpc];
+            }
+            return *this;
+        }
+
         uint32_t s_decompressions{0};
         uint32_t s_preads{0};
         uint32_t s_requested_preloads{0};
@@ -272,6 +306,8 @@ public:
 
     struct stats consume_stats() { return std::exchange(this->lb_stats, {}); }
 
+    const struct stats& get_stats() const { return this->lb_stats; }
+
     size_t get_buffer_size() const { return this->lb_buffer.size(); }
 
     using file_header_t
@@ -281,6 +317,12 @@ public:
 
     void enable_cache();
 
+    /**
+     * @return True if the file is large and made up of several compressed
+     * members that can be decompressed in parallel.
+     */
+    bool has_independent_members() const;
+
     file_ssize_t get_piper_header_size() const
     {
         return this->lb_piper_header_size;
@@ -313,6 +355,20 @@ private:
 
     void resize_buffer(size_t new_max);
 
+    std::function<std::unique_ptr<member_decoder>()>
+    member_decoder_factory() const;
+
+    /**
+     * Decompress the members of the file on several threads and write the
+     * result to the given file.
+     *
+     * @param tmp_pattern The pattern for the temporary files that hold the
+     * output of each thread.
+     * @return True if the whole file was decompressed.
+     */
+    bool decompress_in_parallel(const std::filesystem::path& tmp_pattern,
+                                int write_fd);
+
     /**
      * Ensure there is enough room in the buffer to cache a range of data from
      * the file.  First, this method will check to see if there is enough room
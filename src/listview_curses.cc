@@ -533,6 +533,12 @@ listview_curses::do_update()
         return retval;
     }
 
+    static auto op = lnav_operation{"listview_redraw"};
+
+    std::optional<lnav_opid_guard> op_guard;
+    if (this->vc_needs_update) {
+        op_guard = lnav_opid_guard::internal(op);
+    }
     this->update_top_from_selection();
     while (this->vc_needs_update) {
         vis_line_t row;
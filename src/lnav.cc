@@ -347,7 +347,8 @@ append_default_files()
             if (realpath_res.isOk()) {
                 auto abspath = realpath_res.unwrap();
                 lnav_data.ld_active_files.fc_file_names[abspath.string()]
-                    .with_time_range(lnav_data.ld_default_time_range);
+                    .with_time_range(lnav_data.ld_default_time_range)
+                    .with_min_level(lnav_data.ld_default_min_level);
             } else {
                 log_error("realpath() failed: %s -- %s",
                           full_path.c_str(),
@@ -557,6 +558,12 @@ make it easier to navigate through files quickly.
         .append(" ")
         .append("Only index log content until this time.\n")
         .append("  ")
+        .append("-L"_symbol)
+        .append(",")
+        .append("--min-level"_symbol)
+        .append(" ")
+        .append("Only index log messages at or above this level.\n")
+        .append("  ")
         .append("-r"_symbol)
         .append("         ")
         .append(
@@ -1239,6 +1246,7 @@ static void
 run_cleanup_tasks()
 {
     CLEANUP_TASKS.emplace_back("line_buffer", line_buffer::cleanup_cache());
+    CLEANUP_TASKS.emplace_back("logfile", logfile::cleanup_index_cache());
     CLEANUP_TASKS.emplace_back("archive_manager",
                                archive_manager::cleanup_cache());
     CLEANUP_TASKS.emplace_back("tailer", tailer::cleanup_cache());
@@ -1927,6 +1935,9 @@ VALUES ('org.lnav.mouse-support', -1, DATETIME('now', '+1 minute'),
                                false);
 
     auto rescan_needed = false;
+    auto files_event_driven = false;
+    auto watch_rescan_pending = false;
+    auto watch_rebuild_pending = false;
     auto ui_start_time = ui_clock::now();
     auto next_rebuild_time = ui_start_time;
     auto next_status_update_time = ui_start_time;
@@ -1967,6 +1978,28 @@ VALUES ('org.lnav.mouse-support', -1, DATETIME('now', '+1 minute'),
 
         layout_views();
 
+        {
+            auto watch_res = update_file_watches();
+
+            files_event_driven = watch_res.fwr_event_driven;
+            watch_rescan_pending |= watch_res.fwr_rescan_needed;
+            watch_rebuild_pending |= watch_res.fwr_rebuild_needed;
+            // Changes are held while the prompt is active so the views do
+            // not move around while the user is typing.
+            if (!prompt.p_editor.is_enabled()) {
+                if (std::exchange(watch_rescan_pending, false)) {
+                    if (rescan_future.valid()) {
+                        rescan_needed = true;
+                    } else {
+                        next_rescan_time = ui_now;
+                    }
+                }
+                if (std::exchange(watch_rebuild_pending, false)) {
+                    next_rebuild_time = ui_now;
+                }
+            }
+        }
+
         auto scan_timeout = exec_phase.scanning() ? 10ms : 0ms;
         if (rescan_future.valid()
             && rescan_future.wait_for(scan_timeout)
@@ -2027,8 +2060,19 @@ VALUES ('org.lnav.mouse-support', -1, DATETIME('now', '+1 minute'),
             }
 
             rescan_future = std::future<file_collection>{};
-            next_rescan_time
-                = ui_now + (std::exchange(rescan_needed, false) ? 0ms : 333ms);
+            if (std::exchange(rescan_needed, false)) {
+                next_rescan_time = ui_now;
+            } else if (files_event_driven
+                       && !archive_manager::is_extracting())
+            {
+                // The file watcher will trigger a rescan when a directory
+                // changes, this is just a fallback.  Archives being unpacked
+                // in the background are not watched, so they still need to
+                // be polled for new files.
+                next_rescan_time = ui_now + 10s;
+            } else {
+                next_rescan_time = ui_now + 333ms;
+            }
         }
 
         if (!opened_files && exec_phase.scanning()
@@ -2314,6 +2358,22 @@ VALUES ('org.lnav.mouse-support', -1, DATETIME('now', '+1 minute'),
             }
         }
 
+        if (exec_phase.interactive() && !changes
+            && lnav_data.ld_view_stack.top().value_or(nullptr)
+                == &lnav_data.ld_views[LNV_LOG])
+        {
+            // Use the idle time to render the pages around the viewport
+            // so that scrolling does not have to wait on the formats.
+            ui_now = ui_clock::now();
+            if (ui_now < loop_deadline
+                && lnav_data.ld_log_source.prefetch_rendered_lines(
+                    lnav_data.ld_views[LNV_LOG],
+                    std::min(loop_deadline, ui_now + 5ms)))
+            {
+                loop_deadline = ui_clock::now();
+            }
+        }
+
         ps->update_poll_set(pollfds);
         ui_now = ui_clock::now();
         auto poll_to
@@ -2821,6 +2881,7 @@ main(int argc, char* argv[])
     mode_flags_t mode_flags;
     std::string since_time;
     std::string until_time;
+    std::string min_level;
     const char* LANG = getenv("LANG");
     winsize term_size{};
 
@@ -3189,6 +3250,7 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
 
         app.add_option("-S,--since", since_time, "since");
         app.add_option("-U,--until", until_time, "until");
+        app.add_option("-L,--min-level", min_level, "min-level");
 
         auto wait_cb = [](size_t count) {
             fprintf(stderr, "PID %d waiting for attachment\n", getpid());
@@ -3824,6 +3886,24 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
                 = to_us(from_res.unwrap().get_point());
         }
 
+        if (!min_level.empty()) {
+            log_info("setting default min level: %s", min_level.c_str());
+            auto level = string2level(min_level.c_str(), min_level.size());
+            if (level == LEVEL_UNKNOWN) {
+                auto um
+                    = lnav::console::user_message::error(
+                          attr_line_t("invalid 'min-level' value ")
+                              .append_quoted(min_level))
+                          .with_help(attr_line_t("expecting a log level like ")
+                                         .append_quoted("warning"_symbol)
+                                         .append(" or ")
+                                         .append_quoted("error"_symbol));
+                lnav::console::print(stderr, um);
+                return EXIT_FAILURE;
+            }
+            lnav_data.ld_default_min_level = level;
+        }
+
         if (lnav_data.ld_default_time_range.tr_end
             < lnav_data.ld_default_time_range.tr_begin)
         {
@@ -3911,7 +3991,8 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
 
             lnav_data.ld_active_files.fc_file_names[ul->get_path()]
                 .with_filename(file_path)
-                .with_time_range(lnav_data.ld_default_time_range);
+                .with_time_range(lnav_data.ld_default_time_range)
+                .with_min_level(lnav_data.ld_default_min_level);
             isc::to<curl_looper&, services::curl_streamer_t>().send(
                 [ul](auto& clooper) { clooper.add_request(ul); });
         } else if (file_path_str.find("://") != std::string::npos) {
@@ -3924,13 +4005,15 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
         {
             lnav_data.ld_active_files.fc_file_names[file_path]
                 .with_follow(!lnav_data.ld_flags.is_set<lnav_flags::headless>())
-                .with_time_range(lnav_data.ld_default_time_range);
+                .with_time_range(lnav_data.ld_default_time_range)
+                .with_min_level(lnav_data.ld_default_min_level);
         } else if (lnav::filesystem::statp(file_path, &st) == -1) {
             if (file_path_type == lnav::filesystem::path_type::remote) {
                 lnav_data.ld_active_files.fc_file_names[file_path]
                     .with_follow(
                         !lnav_data.ld_flags.is_set<lnav_flags::headless>())
-                    .with_time_range(lnav_data.ld_default_time_range);
+                    .with_time_range(lnav_data.ld_default_time_range)
+                    .with_min_level(lnav_data.ld_default_min_level);
             } else {
                 lnav::console::print(
                     stderr,
@@ -3969,7 +4052,8 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
                 if (create_piper_res.isOk()) {
                     lnav_data.ld_active_files.fc_file_names[desc]
                         .with_piper(create_piper_res.unwrap())
-                        .with_time_range(lnav_data.ld_default_time_range);
+                        .with_time_range(lnav_data.ld_default_time_range)
+                        .with_min_level(lnav_data.ld_default_min_level);
                 }
             }
         } else if ((abspath = realpath(file_path.c_str(), nullptr)) == nullptr)
@@ -3982,8 +4066,10 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
             if (dir_wild[dir_wild.size() - 1] == '/') {
                 dir_wild.resize(dir_wild.size() - 1);
             }
-            auto loo = logfile_open_options().with_time_range(
-                lnav_data.ld_default_time_range);
+            auto loo
+                = logfile_open_options()
+                      .with_time_range(lnav_data.ld_default_time_range)
+                      .with_min_level(lnav_data.ld_default_min_level);
             lnav_data.ld_active_files.fc_file_names.insert2(dir_wild + "/*",
                                                             loo);
         } else {
@@ -3993,7 +4079,8 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
                     .with_init_location(file_loc)
                     .with_follow(
                         !lnav_data.ld_flags.is_set<lnav_flags::headless>())
-                    .with_time_range(lnav_data.ld_default_time_range));
+                    .with_time_range(lnav_data.ld_default_time_range)
+                    .with_min_level(lnav_data.ld_default_min_level));
             if (file_loc.valid()) {
                 lnav_data.ld_files_to_front.emplace_back(abspath.in());
             }
@@ -4133,7 +4220,8 @@ SELECT tbl_name FROM sqlite_master WHERE sql LIKE 'CREATE VIRTUAL TABLE%'
                     loo.with_piper(stdin_piper)
                         .with_include_in_session(
                             lnav_data.ld_treat_stdin_as_log)
-                        .with_time_range(lnav_data.ld_default_time_range);
+                        .with_time_range(lnav_data.ld_default_time_range)
+                        .with_min_level(lnav_data.ld_default_min_level);
                     if (lnav_data.ld_treat_stdin_as_log) {
                         loo.with_text_format(text_format_t::TF_LOG);
                     }
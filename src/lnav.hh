@@ -230,6 +230,7 @@ struct lnav_data_t {
     std::filesystem::file_time_type ld_last_dot_lnav_time;
 
     time_range ld_default_time_range{time_range::unbounded()};
+    log_level_t ld_default_min_level{LEVEL_UNKNOWN};
 };
 
 struct static_service {};
@@ -27,12 +27,19 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <filesystem>
 #include <optional>
+#include <set>
+#include <tuple>
 #include <unordered_map>
 
 #include "lnav.indexing.hh"
 
+#include "archive_manager.hh"
+#include "base/fs_util.hh"
 #include "bound_tags.hh"
+#include "file_watcher.hh"
 #include "lnav.events.hh"
 #include "lnav.exec-phase.hh"
 #include "lnav.hh"
@@ -669,10 +676,13 @@ rescan_files(bool req)
         {
             return false;
         }
-        if (!all_synced) {
+        // Archives are unpacked in the background, so keep scanning until
+        // all of their files have been picked up.
+        auto extracting = archive_manager::is_extracting();
+        if (!all_synced || extracting) {
             delay = 30ms;
         }
-        done = fc.fc_file_names.empty() && all_synced;
+        done = fc.fc_file_names.empty() && all_synced && !extracting;
         if (!done && !lnav_data.ld_flags.is_set<lnav_flags::headless>()) {
             lnav_data.ld_files_view.set_needs_update();
             lnav_data.ld_files_view.do_update();
@@ -681,3 +691,123 @@ rescan_files(bool req)
     } while (!done && lnav_data.ld_looping);
     return true;
 }
+
+static std::optional<std::filesystem::path>
+watch_dir_for_pattern(const std::string& pattern,
+                      const logfile_open_options& loo)
+{
+    auto path = loo.loo_piper ? loo.loo_piper->get_out_pattern()
+                              : std::filesystem::path{pattern};
+    auto dir = path.parent_path();
+
+    if (!path.is_absolute() || lnav::filesystem::is_url(pattern)
+        || dir.string().find_first_of("*?[") != std::string::npos)
+    {
+        return std::nullopt;
+    }
+
+    return dir;
+}
+
+file_watch_result_t
+update_file_watches()
+{
+    static constexpr auto SWEEP_INTERVAL = 10s;
+    static auto& fwatcher
+        = injector::get<lnav::file_watcher&, services::file_watcher_t>();
+    static auto last_fc_state = std::make_tuple(-1, size_t{0}, size_t{0});
+    static uint64_t last_watch_generation = 0;
+    static std::set<std::filesystem::path> last_dirs;
+    static std::vector<std::optional<std::filesystem::path>> pattern_dirs;
+    static auto patterns_covered = false;
+    static auto last_sweep = ui_clock::now();
+
+    file_watch_result_t retval;
+
+    if (!fwatcher.is_supported()) {
+        return retval;
+    }
+
+    auto& fc = lnav_data.ld_active_files;
+    auto fc_state = std::make_tuple(
+        fc.fc_files_generation, fc.fc_files.size(), fc.fc_file_names.size());
+    auto files_changed = fc_state != last_fc_state;
+    if (files_changed) {
+        std::set<std::filesystem::path> dirs;
+
+        last_fc_state = fc_state;
+        pattern_dirs.clear();
+        for (const auto& pair : fc.fc_file_names) {
+            auto dir_opt = watch_dir_for_pattern(pair.first, pair.second);
+
+            if (dir_opt) {
+                dirs.insert(dir_opt.value());
+            }
+            pattern_dirs.emplace_back(std::move(dir_opt));
+        }
+        for (const auto& lf : fc.fc_files) {
+            auto actual_path = lf->get_actual_path();
+
+            if (actual_path) {
+                dirs.insert(actual_path->parent_path());
+            }
+        }
+        if (dirs != last_dirs) {
+            last_dirs = dirs;
+            fwatcher.send([dirs = std::move(dirs)](auto& fw) {
+                fw.set_watched_dirs(dirs);
+            });
+        }
+    }
+
+    auto watch_generation = fwatcher.get_generation();
+    if (files_changed || watch_generation != last_watch_generation) {
+        if (watch_generation != last_watch_generation) {
+            // Entries could have been created before the watch was added.
+            retval.fwr_rescan_needed = true;
+            last_watch_generation = watch_generation;
+        }
+        patterns_covered = std::all_of(
+            pattern_dirs.begin(), pattern_dirs.end(), [](const auto& dir) {
+                return dir && fwatcher.is_watched(dir.value());
+            });
+        for (const auto& lf : fc.fc_files) {
+            auto actual_path = lf->get_actual_path();
+            auto watched = actual_path
+                && fwatcher.is_watched(actual_path->parent_path());
+
+            if (watched != lf->is_event_driven()) {
+                lf->set_event_driven(watched);
+            }
+        }
+    }
+    retval.fwr_event_driven = patterns_covered;
+
+    auto changes = fwatcher.take_changes();
+    auto now = ui_clock::now();
+    if (now - last_sweep >= SWEEP_INTERVAL) {
+        // Check everything once in a while in case an event was missed.
+        last_sweep = now;
+        changes.c_overflowed = true;
+    }
+    if (changes.c_entries_changed || changes.c_overflowed) {
+        retval.fwr_rescan_needed = true;
+    }
+    if (changes.c_overflowed || !changes.c_paths.empty()) {
+        for (const auto& lf : fc.fc_files) {
+            if (!lf->is_event_driven()) {
+                continue;
+            }
+
+            auto actual_path = lf->get_actual_path();
+            if (changes.c_overflowed || !actual_path
+                || changes.c_paths.count(actual_path.value()) > 0)
+            {
+                lf->notify_changed();
+                retval.fwr_rebuild_needed = true;
+            }
+        }
+    }
+
+    return retval;
+}
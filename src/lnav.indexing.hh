@@ -46,6 +46,20 @@ rebuild_indexes_result_t rebuild_indexes(
 void rebuild_indexes_repeatedly();
 bool rescan_files(bool required = false);
 bool update_active_files(file_collection& new_files);
+
+struct file_watch_result_t {
+    /** The file name patterns need to be expanded again. */
+    bool fwr_rescan_needed{false};
+    /** Some files had events and need to be checked for new lines. */
+    bool fwr_rebuild_needed{false};
+    /**
+     * All of the file name patterns are in watched directories, so they
+     * only need to be expanded again when there is an event.
+     */
+    bool fwr_event_driven{false};
+};
+
+file_watch_result_t update_file_watches();
 lnav::progress_result_t do_observer_update(const logfile* lf);
 
 #endif
@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include "lnav.perf.hh"
+
+#include "base/humanize.hh"
+#include "base/lnav_log.hh"
+#include "fmt/format.h"
+#include "logfile.hh"
+
+namespace lnav::perf {
+
+static constexpr const char* KIND_OPERATION = "operation";
+static constexpr const char* KIND_FILE = "file";
+
+static std::string
+duration_str(uint64_t us)
+{
+    if (us < 1000) {
+        return fmt::format(FMT_STRING("{}us"), us);
+    }
+    if (us < 1000 * 1000) {
+        return fmt::format(FMT_STRING("{:.1f}ms"), us / 1000.0);
+    }
+    return fmt::format(FMT_STRING("{:.2f}s"), us / (1000.0 * 1000.0));
+}
+
+static std::vector<const lnav_operation*>
+completed_operations()
+{
+    std::vector<const lnav_operation*> retval;
+
+    for (const auto* op = lnav_operation::head(); op != nullptr;
+         op = op->lo_next)
+    {
+        if (op->completed() > 0) {
+            retval.emplace_back(op);
+        }
+    }
+    std::stable_sort(
+        retval.begin(), retval.end(), [](const auto* lhs, const auto* rhs) {
+            return lhs->lo_total_us.load() > rhs->lo_total_us.load();
+        });
+
+    return retval;
+}
+
+std::vector<metric>
+collect(const file_collection& fc)
+{
+    std::vector<metric> retval;
+
+    for (const auto* op : completed_operations()) {
+        const auto count = op->completed();
+        const auto total_us = op->lo_total_us.load();
+        auto add = [&retval, op](std::string name, double value, auto unit) {
+            retval.emplace_back(metric{
+                KIND_OPERATION, op->lo_name, std::move(name), value, unit});
+        };
+
+        add("count", count, "runs");
+        add("total", total_us, "us");
+        add("mean", (double) total_us / count, "us");
+        add("p50", op->percentile(0.50), "us");
+        add("p90", op->percentile(0.90), "us");
+        add("p99", op->percentile(0.99), "us");
+        add("max", op->lo_max_us.load(), "us");
+        for (size_t index = 0; index < lnav_operation::HISTOGRAM_SIZE;
+             index++)
+        {
+            const auto bucket = op->lo_histogram[index].load();
+
+            if (bucket == 0) {
+                continue;
+            }
+            if (index == lnav_operation::HISTOGRAM_SIZE - 1) {
+                add(fmt::format(FMT_STRING("ge_{}us"), 1ULL << (index - 1)),
+                    bucket,
+                    "runs");
+            } else {
+                add(fmt::format(FMT_STRING("lt_{}us"), 1ULL << index),
+                    bucket,
+                    "runs");
+            }
+        }
+    }
+
+    for (const auto& lf : fc.fc_files) {
+        const auto& act = lf->get_activity();
+        const auto buf_stats = lf->get_buffer_stats();
+        const auto secs = act.la_index_time.count() / (1000.0 * 1000.0);
+        auto add = [&retval, &lf](const char* name, double value, auto unit) {
+            retval.emplace_back(
+                metric{KIND_FILE, lf->get_filename(), name, value, unit});
+        };
+
+        add("indexed_bytes", act.la_indexed_bytes, "bytes");
+        add("indexed_lines", act.la_indexed_lines, "lines");
+        add("index_time", act.la_index_time.count(), "us");
+        if (secs > 0.0) {
+            add("index_byte_rate", act.la_indexed_bytes / secs, "bytes/s");
+            add("index_line_rate", act.la_indexed_lines / secs, "lines/s");
+        }
+        add("polls", act.la_polls, "count");
+        add("reads", act.la_reads, "count");
+        add("preads", buf_stats.s_preads, "count");
+        add("decompressions", buf_stats.s_decompressions, "count");
+        add("requested_preloads", buf_stats.s_requested_preloads, "count");
+        add("used_preloads", buf_stats.s_used_preloads, "count");
+    }
+
+    return retval;
+}
+
+std::string
+report(const file_collection& fc)
+{
+    std::string retval;
+    auto out = std::back_inserter(retval);
+    const auto ops = completed_operations();
+
+    fmt::format_to(out,
+                   FMT_STRING("{:<28} {:>8} {:>9} {:>9} {:>9} {:>9} {:>9} "
+                              "{:>9}\n"),
+                   "Operation",
+                   "Runs",
+                   "Total",
+                   "Mean",
+                   "P50",
+                   "P90",
+                   "P99",
+                   "Max");
+    for (const auto* op : ops) {
+        const auto count = op->completed();
+        const auto total_us = op->lo_total_us.load();
+
+        fmt::format_to(out,
+                       FMT_STRING("{:<28} {:>8} {:>9} {:>9} {:>9} {:>9} {:>9} "
+                                  "{:>9}\n"),
+                       op->lo_name,
+                       count,
+                       duration_str(total_us),
+                       duration_str(total_us / count),
+                       duration_str(op->percentile(0.50)),
+                       duration_str(op->percentile(0.90)),
+                       duration_str(op->percentile(0.99)),
+                       duration_str(op->lo_max_us.load()));
+    }
+
+    fmt::format_to(out,
+                   FMT_STRING("\n{:>9} {:>10} {:>9} {:>9} {:>10} {:>8} "
+                              "{:>8} {}\n"),
+                   "Indexed",
+                   "Lines",
+                   "Time",
+                   "Bytes/s",
+                   "Lines/s",
+                   "Preads",
+                   "Decomp",
+                   "File");
+    for (const auto& lf : fc.fc_files) {
+        const auto& act = lf->get_activity();
+        const auto buf_stats = lf->get_buffer_stats();
+        const auto secs = act.la_index_time.count() / (1000.0 * 1000.0);
+        auto byte_rate = std::string("-");
+        auto line_rate = std::string("-");
+
+        if (secs > 0.0) {
+            byte_rate = fmt::format(
+                FMT_STRING("{}/s"),
+                humanize::file_size(act.la_indexed_bytes / secs,
+                                    humanize::alignment::none));
+            line_rate = fmt::format(FMT_STRING("{:.0f}"),
+                                    act.la_indexed_lines / secs);
+        }
+        fmt::format_to(
+            out,
+            FMT_STRING("{:>9} {:>10} {:>9} {:>9} {:>10} {:>8} {:>8} {}\n"),
+            humanize::file_size(act.la_indexed_bytes,
+                                humanize::alignment::none),
+            act.la_indexed_lines,
+            duration_str(act.la_index_time.count()),
+            byte_rate,
+            line_rate,
+            buf_stats.s_preads,
+            buf_stats.s_decompressions,
+            lf->get_filename());
+    }
+
+    return retval;
+}
+
+}  // namespace lnav::perf
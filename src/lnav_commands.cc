@@ -61,6 +61,7 @@
 #include "field_overlay_source.hh"
 #include "hasher.hh"
 #include "lnav.indexing.hh"
+#include "lnav.perf.hh"
 #include "lnav.prompt.hh"
 #include "lnav_commands.hh"
 #include "lnav_config.hh"
@@ -748,6 +749,33 @@ com_current_time(exec_context& ec,
     return Ok(retval);
 }
 
+static Result<std::string, lnav::console::user_message>
+com_perf_report(exec_context& ec,
+                std::string cmdline,
+                std::vector<std::string>& args)
+{
+    if (ec.ec_dry_run) {
+        return Ok(std::string());
+    }
+
+    auto retval = lnav::perf::report(lnav_data.ld_active_files);
+    auto ec_out = ec.get_output();
+    if (ec_out) {
+        FILE* outfile = *ec_out;
+
+        if (outfile == stdout) {
+            lnav_data.ld_stdout_used = true;
+        }
+
+        fprintf(outfile, "%s", retval.c_str());
+        fflush(outfile);
+
+        retval.clear();
+    }
+
+    return Ok(retval);
+}
+
 static Result<std::string, lnav::console::user_message>
 com_goto(exec_context& ec, std::string cmdline, std::vector<std::string>& args)
 {
@@ -3330,6 +3358,12 @@ readline_context::command_t STD_COMMANDS[] = {
      help_text(":current-time")
          .with_summary("Print the current time in human-readable form and "
                        "seconds since the epoch")},
+    {"perf-report",
+     com_perf_report,
+
+     help_text(":perf-report")
+         .with_summary(
+             "Print timings for internal operations and file indexing")},
     {
         "goto",
         com_goto,
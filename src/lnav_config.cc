@@ -1380,6 +1380,13 @@ static const struct json_path_container archive_handlers = {
         .with_example("12h"_frag)
         .for_field(&_lnav_config::lc_archive_manager,
                    &archive_manager::config::amc_cache_ttl),
+    yajlpp::property_handler("compress-cache")
+        .with_synopsis("<bool>")
+        .with_description(
+            "Store the files unpacked from archives as gzip files in the "
+            "cache to use less disk space")
+        .for_field(&_lnav_config::lc_archive_manager,
+                   &archive_manager::config::amc_compress_cache),
 };
 
 static const typed_json_path_container<lnav::piper::demux_json_def>
@@ -1487,6 +1494,21 @@ static const struct json_path_container logfile_handlers = {
         .with_min_value(1)
         .for_field(&_lnav_config::lc_logfile,
                    &lnav::logfile::config::lc_max_unrecognized_lines),
+    yajlpp::property_handler("indexing-threads")
+        .with_synopsis("<count>")
+        .with_description(
+            "The number of threads to use when several large files need to "
+            "be indexed at once.  A value of zero uses the number of CPUs.")
+        .for_field(&_lnav_config::lc_logfile,
+                   &lnav::logfile::config::lc_indexing_threads),
+    yajlpp::property_handler("column-cache-size")
+        .with_synopsis("<bytes>")
+        .with_description(
+            "The maximum amount of memory to use for caching the values "
+            "extracted from log messages for SQL queries and charts")
+        .with_min_value(0)
+        .for_field(&_lnav_config::lc_logfile,
+                   &lnav::logfile::config::lc_column_cache_size),
 };
 
 static const struct json_path_container ssh_config_handlers = {
@@ -1536,6 +1558,23 @@ static const struct json_path_container ssh_handlers = {
         .with_children(ssh_config_handlers),
 };
 
+static const struct json_path_container remote_filter_handlers = {
+    yajlpp::pattern_property_handler("(?<host>[\\w\\-\\.]+)")
+        .with_synopsis("<regex>")
+        .with_description(
+            "A regular expression for the lines the tailer on the host "
+            "should transfer.  Lines that do not match are not sent.  The "
+            "tailer is either written in C and uses POSIX extended regular "
+            "expressions or in Python and uses the re module, so only the "
+            "syntax that both have in common is allowed: literals, '.', "
+            "bracket expressions without backslashes or classes, groups "
+            "that do not start with '?', alternation, anchors, the '*', "
+            "'+', '?', and '{m,n}' quantifiers, and backslash escapes of "
+            "punctuation.")
+        .with_pattern(R"(^(?:[^\\\[\]{}(]|\\[\\^$.|?*+()\[\]{}/-]|\[\^?\]?[^\]\\\[]*\]|\{\d+(?:,\d*)?\}|\((?!\?))*$)")
+        .for_field(&_lnav_config::lc_tailer, &tailer::config::c_filters),
+};
+
 static const struct json_path_container remote_handlers = {
     yajlpp::property_handler("cache-ttl")
         .with_synopsis("<duration>")
@@ -1550,6 +1589,11 @@ static const struct json_path_container remote_handlers = {
             "Settings related to the ssh command used to contact remote "
             "machines")
         .with_children(ssh_handlers),
+    yajlpp::property_handler("filters")
+        .with_description(
+            "Regular expressions, keyed by hostname, for the lines that "
+            "should be transferred from remote hosts")
+        .with_children(remote_filter_handlers),
 };
 
 static const struct json_path_container sysclip_impl_cmd_handlers = json_path_container{
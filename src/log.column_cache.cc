@@ -0,0 +1,393 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <tuple>
+
+#include "log.column_cache.hh"
+
+#include <string.h>
+
+#include "base/injector.hh"
+#include "base/lnav_log.hh"
+#include "log_format.hh"
+#include "logfile.cfg.hh"
+
+namespace lnav::log {
+
+namespace {
+
+std::atomic<size_t> TOTAL_MEMORY_USAGE{0};
+
+/**
+ * The clock shared by all of the caches so that the least-recently-used
+ * pages can be found across all of them.
+ */
+uint64_t LRU_TICK{0};
+
+struct cache_registry {
+    std::mutex cr_mutex;
+    std::set<column_cache*> cr_caches;
+};
+
+cache_registry&
+registry()
+{
+    static cache_registry retval;
+
+    return retval;
+}
+
+// A rough guess at the cost of the string object and the index entry.
+constexpr size_t DICTIONARY_ENTRY_OVERHEAD = sizeof(std::string) + 32;
+
+}  // namespace
+
+column_cache::column_cache()
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lg(reg.cr_mutex);
+
+    reg.cr_caches.insert(this);
+}
+
+column_cache::~column_cache()
+{
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lg(reg.cr_mutex);
+
+        reg.cr_caches.erase(this);
+    }
+    this->clear();
+}
+
+size_t
+column_cache::total_memory_usage()
+{
+    return TOTAL_MEMORY_USAGE.load();
+}
+
+void
+column_cache::update_memory_usage(ssize_t amount)
+{
+    this->cc_memory_usage += amount;
+    TOTAL_MEMORY_USAGE.fetch_add(static_cast<size_t>(amount));
+}
+
+column_cache::page*
+column_cache::page_for(column& col, uint32_t line_number, bool create)
+{
+    auto page_index = line_number >> PAGE_SHIFT;
+
+    if (page_index >= col.c_pages.size()) {
+        if (!create) {
+            return nullptr;
+        }
+        col.c_pages.resize(page_index + 1);
+    }
+
+    auto& pg = col.c_pages[page_index];
+    if (!pg) {
+        if (!create) {
+            return nullptr;
+        }
+        pg = std::make_unique<page>();
+        this->update_memory_usage(sizeof(page));
+    }
+    LRU_TICK += 1;
+    pg->p_last_used = LRU_TICK;
+
+    return pg.get();
+}
+
+std::optional<uint32_t>
+column_cache::intern(column& col, string_fragment sf)
+{
+    auto iter = col.c_dictionary_index.find(sf);
+    if (iter != col.c_dictionary_index.end()) {
+        return iter->second;
+    }
+
+    // Columns with too many distinct values are not worth caching, the
+    // message will just be parsed again.
+    if (col.c_dictionary.size() >= MAX_DICTIONARY_SIZE) {
+        return std::nullopt;
+    }
+
+    uint32_t retval = col.c_dictionary.size();
+    const auto& str = col.c_dictionary.emplace_back(sf.to_string());
+    col.c_dictionary_index.emplace(string_fragment::from_str(str), retval);
+    this->update_memory_usage(str.size() + DICTIONARY_ENTRY_OVERHEAD);
+
+    return retval;
+}
+
+void
+column_cache::store(uint32_t line_number, const logline_value_vector& values)
+{
+    const auto slot = line_number & (PAGE_SIZE - 1);
+    std::vector<bool> seen(this->cc_columns.size());
+
+    for (auto& col : this->cc_columns) {
+        auto* pg = this->page_for(col, line_number, true);
+
+        pg->p_kinds[slot] = cell_kind::null;
+        pg->p_values[slot] = 0;
+    }
+
+    for (const auto& lv : values.lvv_values) {
+        if (!lv.lv_meta.lvm_column.is<logline_value_meta::table_column>()) {
+            continue;
+        }
+
+        auto col_index
+            = lv.lv_meta.lvm_column.get<logline_value_meta::table_column>()
+                  .value;
+        if (col_index >= this->cc_columns.size()) {
+            this->cc_columns.resize(col_index + 1);
+        }
+        if (col_index >= seen.size()) {
+            seen.resize(col_index + 1);
+        }
+        // Only the first value for a column is used by the consumers.
+        if (seen[col_index]) {
+            continue;
+        }
+        seen[col_index] = true;
+
+        auto& col = this->cc_columns[col_index];
+        auto* pg = this->page_for(col, line_number, true);
+        auto kind = cell_kind::unknown;
+        uint64_t value = 0;
+
+        if (lv.lv_meta.lvm_struct_name.empty()) {
+            this->cc_name_to_column.emplace(lv.lv_meta.lvm_name, col_index);
+            switch (lv.lv_meta.lvm_kind) {
+                case value_kind_t::VALUE_NULL:
+                    kind = cell_kind::null;
+                    break;
+                case value_kind_t::VALUE_BOOLEAN:
+                    kind = cell_kind::boolean;
+                    value = lv.lv_value.i;
+                    break;
+                case value_kind_t::VALUE_INTEGER:
+                    kind = cell_kind::integer;
+                    value = lv.lv_value.i;
+                    break;
+                case value_kind_t::VALUE_FLOAT:
+                    kind = cell_kind::real;
+                    memcpy(&value, &lv.lv_value.d, sizeof(value));
+                    break;
+                case value_kind_t::VALUE_ANY:
+                case value_kind_t::VALUE_TEXT:
+                case value_kind_t::VALUE_XML:
+                case value_kind_t::VALUE_JSON: {
+                    auto code = this->intern(col, lv.text_value_fragment());
+                    if (code) {
+                        kind = lv.lv_meta.lvm_kind == value_kind_t::VALUE_JSON
+                            ? cell_kind::json
+                            : cell_kind::text;
+                        value = code.value();
+                    }
+                    break;
+                }
+                default:
+                    // Quoted strings and timestamps need more work to turn
+                    // into an SQL value, so leave those to the slow path.
+                    break;
+            }
+        }
+
+        pg->p_kinds[slot] = kind;
+        pg->p_values[slot] = value;
+    }
+
+    static const auto& cfg = injector::get<const lnav::logfile::config&>();
+
+    if (TOTAL_MEMORY_USAGE.load() > cfg.lc_column_cache_size) {
+        evict();
+    }
+}
+
+std::optional<column_cache::cell>
+column_cache::lookup(uint32_t line_number, size_t column)
+{
+    if (column >= this->cc_columns.size()) {
+        return std::nullopt;
+    }
+
+    auto& col = this->cc_columns[column];
+    const auto* pg = this->page_for(col, line_number, false);
+    if (pg == nullptr) {
+        return std::nullopt;
+    }
+
+    const auto slot = line_number & (PAGE_SIZE - 1);
+    const auto value = pg->p_values[slot];
+    cell retval;
+
+    retval.c_kind = pg->p_kinds[slot];
+    switch (retval.c_kind) {
+        case cell_kind::unknown:
+            return std::nullopt;
+        case cell_kind::null:
+            break;
+        case cell_kind::boolean:
+        case cell_kind::integer:
+            retval.c_integer = static_cast<int64_t>(value);
+            break;
+        case cell_kind::real:
+            memcpy(&retval.c_real, &value, sizeof(retval.c_real));
+            break;
+        case cell_kind::text:
+        case cell_kind::json:
+            retval.c_text = string_fragment::from_str(col.c_dictionary[value]);
+            break;
+    }
+
+    return retval;
+}
+
+std::optional<column_cache::cell>
+column_cache::lookup(uint32_t line_number, intern_string_t name)
+{
+    auto iter = this->cc_name_to_column.find(name);
+    if (iter == this->cc_name_to_column.end()) {
+        return std::nullopt;
+    }
+
+    return this->lookup(line_number, iter->second);
+}
+
+void
+column_cache::invalidate_from(uint32_t line_number)
+{
+    const auto first_page = line_number >> PAGE_SHIFT;
+    const auto slot = line_number & (PAGE_SIZE - 1);
+
+    for (auto& col : this->cc_columns) {
+        for (auto page_index = first_page; page_index < col.c_pages.size();
+             page_index++)
+        {
+            auto& pg = col.c_pages[page_index];
+
+            if (!pg) {
+                continue;
+            }
+            if (page_index == first_page && slot > 0) {
+                std::fill(pg->p_kinds.begin() + slot,
+                          pg->p_kinds.end(),
+                          cell_kind::unknown);
+                continue;
+            }
+            pg.reset();
+            this->update_memory_usage(-static_cast<ssize_t>(sizeof(page)));
+        }
+    }
+}
+
+void
+column_cache::clear()
+{
+    this->update_memory_usage(-static_cast<ssize_t>(this->cc_memory_usage));
+    this->cc_columns.clear();
+    this->cc_name_to_column.clear();
+}
+
+void
+column_cache::evict()
+{
+    static const auto& cfg = injector::get<const lnav::logfile::config&>();
+
+    // Evict down to a bit below the budget so that the next few stores
+    // do not immediately trigger another round.
+    const auto target = cfg.lc_column_cache_size - cfg.lc_column_cache_size / 4;
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lg(reg.cr_mutex);
+    std::vector<std::tuple<uint64_t, column_cache*, size_t, size_t>> pages;
+
+    for (auto* cache : reg.cr_caches) {
+        for (size_t col_index = 0; col_index < cache->cc_columns.size();
+             col_index++)
+        {
+            const auto& col = cache->cc_columns[col_index];
+
+            for (size_t page_index = 0; page_index < col.c_pages.size();
+                 page_index++)
+            {
+                if (col.c_pages[page_index]) {
+                    pages.emplace_back(col.c_pages[page_index]->p_last_used,
+                                       cache,
+                                       col_index,
+                                       page_index);
+                }
+            }
+        }
+    }
+    std::sort(pages.begin(), pages.end());
+
+    auto evicted = size_t{0};
+    for (const auto& [last_used, cache, col_index, page_index] : pages) {
+        if (TOTAL_MEMORY_USAGE.load() <= target) {
+            break;
+        }
+        cache->cc_columns[col_index].c_pages[page_index].reset();
+        cache->update_memory_usage(-static_cast<ssize_t>(sizeof(page)));
+        evicted += 1;
+    }
+
+    log_debug("column cache evicted %zu of %zu pages, %zu bytes in use",
+              evicted,
+              pages.size(),
+              TOTAL_MEMORY_USAGE.load());
+    if (TOTAL_MEMORY_USAGE.load() > target) {
+        // Only the dictionaries are left, so start over with the biggest
+        // ones.
+        std::vector<column_cache*> by_size(reg.cr_caches.begin(),
+                                           reg.cr_caches.end());
+
+        std::sort(by_size.begin(),
+                  by_size.end(),
+                  [](const auto* lhs, const auto* rhs) {
+                      return lhs->cc_memory_usage > rhs->cc_memory_usage;
+                  });
+        for (auto* cache : by_size) {
+            if (TOTAL_MEMORY_USAGE.load() <= target) {
+                break;
+            }
+            cache->clear();
+        }
+    }
+}
+
+}  // namespace lnav::log
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2026, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef lnav_log_column_cache_hh
+#define lnav_log_column_cache_hh
+
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+
+#include "base/intern_string.hh"
+#include "log_format_fwd.hh"
+
+namespace lnav::log {
+
+/**
+ * A cache of the values extracted from the messages in a log file.  The
+ * values are stored by table column in pages of fixed-size arrays that
+ * are filled in as messages are annotated.  Numbers are packed into the
+ * pages directly and strings are stored as codes into a per-column
+ * dictionary.  Pages are evicted, least-recently-used first across all of
+ * the caches, when the memory used by all of the caches exceeds the
+ * configured budget.  The caches are only meant to be used from the main
+ * thread.
+ */
+class column_cache {
+public:
+    static constexpr size_t PAGE_SHIFT = 12;
+    static constexpr size_t PAGE_SIZE = 1UL << PAGE_SHIFT;
+    static constexpr size_t MAX_DICTIONARY_SIZE = 64 * 1024;
+
+    enum class cell_kind : uint8_t {
+        /** The line has not been cached for this column. */
+        unknown,
+        null,
+        boolean,
+        integer,
+        real,
+        text,
+        json,
+    };
+
+    struct cell {
+        cell_kind c_kind{cell_kind::unknown};
+        int64_t c_integer{0};
+        double c_real{0.0};
+        string_fragment c_text;
+
+        bool is_numeric() const
+        {
+            return this->c_kind == cell_kind::integer
+                || this->c_kind == cell_kind::real;
+        }
+
+        double to_double() const
+        {
+            return this->c_kind == cell_kind::real ? this->c_real
+                                                   : this->c_integer;
+        }
+    };
+
+    column_cache();
+    column_cache(const column_cache&) = delete;
+    column_cache& operator=(const column_cache&) = delete;
+
+    ~column_cache();
+
+    /**
+     * Record the values of the message that starts at the given line.
+     * Columns that are not in the values are recorded as null.
+     */
+    void store(uint32_t line_number, const logline_value_vector& values);
+
+    std::optional<cell> lookup(uint32_t line_number, size_t column);
+
+    std::optional<cell> lookup(uint32_t line_number, intern_string_t name);
+
+    /**
+     * Drop the cached values for the given line and all those after it.
+     */
+    void invalidate_from(uint32_t line_number);
+
+    void clear();
+
+    size_t memory_usage() const { return this->cc_memory_usage; }
+
+    static size_t total_memory_usage();
+
+private:
+    struct page {
+        std::array<cell_kind, PAGE_SIZE> p_kinds{};
+        std::array<uint64_t, PAGE_SIZE> p_values{};
+        uint64_t p_last_used{0};
+    };
+
+    struct column {
+        std::vector<std::unique_ptr<page>> c_pages;
+        std::deque<std::string> c_dictionary;
+        std::unordered_map<string_fragment, uint32_t, frag_hasher>
+            c_dictionary_index;
+    };
+
+    page* page_for(column& col, uint32_t line_number, bool create);
+    std::optional<uint32_t> intern(column& col, string_fragment sf);
+    void update_memory_usage(ssize_t amount);
+    static void evict();
+
+    std::deque<column> cc_columns;
+    std::map<intern_string_t, size_t> cc_name_to_column;
+    size_t cc_memory_usage{0};
+};
+
+}  // namespace lnav::log
+
+#endif
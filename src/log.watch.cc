@@ -112,13 +112,19 @@ struct expressions : public lnav_config_listener {
 
 static expressions exprs;
 
+bool
+has_enabled_exprs()
+{
+    return std::any_of(
+        exprs.e_watch_exprs.begin(),
+        exprs.e_watch_exprs.end(),
+        [](const auto& elem) { return elem.second.cwe_enabled; });
+}
+
 void
 eval_with(logfile& lf, logfile::iterator ll)
 {
-    if (std::none_of(exprs.e_watch_exprs.begin(),
-                     exprs.e_watch_exprs.end(),
-                     [](const auto& elem) { return elem.second.cwe_enabled; }))
-    {
+    if (!has_enabled_exprs()) {
         return;
     }
 
@@ -34,6 +34,13 @@
 
 namespace lnav::log::watch {
 
+/**
+ * @return True if any of the configured watch expressions are enabled.  The
+ * expressions are evaluated using the main database connection, so indexing
+ * must stay on the main thread when this is true.
+ */
+bool has_enabled_exprs();
+
 void eval_with(logfile& lf, logfile::iterator ll);
 
 }
@@ -214,6 +214,7 @@ log_thread_id_state::insert_tid(ArenaAlloc::Alloc<char>& alloc,
     } else {
         retval->second.titr_range.extend_to(us);
     }
+    this->ltis_last_tid = retval->first;
 
     return retval;
 }
@@ -246,6 +247,46 @@ log_opid_state::insert_op(ArenaAlloc::Alloc<char>& alloc,
         }
         retval->second.otr_range.extend_to(other_us);
     }
+    this->los_last_opid = retval->first;
+
+    return retval;
+}
+
+void
+log_line_postings::add_line(uint32_t line_number,
+                            const string_fragment& opid,
+                            const string_fragment& tid)
+{
+    if (!opid.empty()) {
+        this->llp_opids[opid].push_back(line_number);
+    }
+    if (!tid.empty()) {
+        this->llp_tids[tid].push_back(line_number);
+    }
+}
+
+void
+log_line_postings::merge(const log_line_postings& other)
+{
+    for (const auto& [opid, lines] : other.llp_opids) {
+        this->llp_opids[opid].append(lines);
+    }
+    for (const auto& [tid, lines] : other.llp_tids) {
+        this->llp_tids[tid].append(lines);
+    }
+}
+
+size_t
+log_line_postings::memory_size() const
+{
+    size_t retval = 0;
+
+    for (const auto& pair : this->llp_opids) {
+        retval += pair.second.memory_size();
+    }
+    for (const auto& pair : this->llp_tids) {
+        retval += pair.second.memory_size();
+    }
 
     return retval;
 }
@@ -1713,6 +1754,170 @@ static const json_path_container json_log_rewrite_handlers = {
         .add_cb(rewrite_json_field),
 };
 
+bool
+external_log_format::might_match_line(string_fragment line) const
+{
+    if (this->elf_type != elf_type_t::ELF_TYPE_TEXT) {
+        return true;
+    }
+
+    for (const auto& pat : this->elf_pattern_order) {
+        const auto* pcre = pat->p_pcre.pp_value.get();
+
+        if (pcre == nullptr || pcre->might_match(line)) {
+            return true;
+        }
+    }
+
+    return this->elf_pattern_order.empty();
+}
+
+static bool
+is_combinable_pattern(const std::string& pattern)
+{
+    // Group numbers shift and control verbs escape their branch when a
+    // pattern is embedded in an alternation, so leave anything that
+    // refers to groups by number, backtracks across branches, or could
+    // comment out the rest of the combined pattern to the slow path.
+    static constexpr const char* UNSAFE[] = {
+        "(*",
+        "(?R",
+        "(?(",
+        "(?&",
+        "(?P>",
+        "(?+",
+        "\\g",
+        "\\Q",
+    };
+
+    for (const auto* unsafe : UNSAFE) {
+        if (pattern.find(unsafe) != std::string::npos) {
+            return false;
+        }
+    }
+
+    for (auto pos = pattern.find("(?"); pos != std::string::npos;
+         pos = pattern.find("(?", pos + 2))
+    {
+        for (auto lpc = pos + 2; lpc < pattern.size(); lpc++) {
+            auto ch = pattern[lpc];
+
+            if (isdigit(ch) || ch == 'x') {
+                return false;
+            }
+            if (ch != '-' && ch != '^' && !isalpha(ch)) {
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+void
+external_log_format::build_combined_pattern()
+{
+    this->elf_combined_pattern = nullptr;
+    if (this->elf_type != elf_type_t::ELF_TYPE_TEXT
+        || this->elf_pattern_order.size() < 2)
+    {
+        return;
+    }
+
+    // The leftmost match wins in an alternation, so the branches are only
+    // tried in the same order as the sequential scan when every pattern is
+    // anchored to the start of the line.
+    std::string combined = "(?:";
+    std::vector<size_t> capture_offsets;
+    size_t capture_count = 0;
+    for (const auto& [index, pat] : lnav::itertools::enumerate(
+             this->elf_pattern_order))
+    {
+        const auto* pcre = pat->p_pcre.pp_value.get();
+
+        if (pcre == nullptr || !pcre->is_anchored()
+            || pcre->has_back_references()
+            || !is_combinable_pattern(pcre->get_pattern()))
+        {
+            log_debug("%s: not combining patterns, %s cannot be combined",
+                      this->elf_name.get(),
+                      pat->p_config_path.c_str());
+            return;
+        }
+
+        if (index > 0) {
+            combined.append("|");
+        }
+        fmt::format_to(std::back_inserter(combined),
+                       FMT_STRING("(?:{})(*MARK:{})"),
+                       pcre->get_pattern(),
+                       index);
+        // The branch's captures are numbered after the earlier branches'.
+        capture_offsets.emplace_back(capture_count);
+        capture_count += pcre->get_capture_count();
+    }
+    combined.append(")");
+
+    auto compile_res = lnav::pcre2pp::code::from(
+        combined, PCRE2_DOTALL | PCRE2_DUPNAMES);
+    if (compile_res.isErr()) {
+        auto ce = compile_res.unwrapErr();
+
+        log_warning("%s: unable to combine patterns -- %s",
+                    this->elf_name.get(),
+                    ce.get_message().c_str());
+        return;
+    }
+
+    this->elf_combined_pattern = compile_res.unwrap().to_shared();
+    this->elf_combined_capture_offsets = std::move(capture_offsets);
+}
+
+std::optional<int>
+external_log_format::first_matching_pattern(string_fragment line) const
+{
+    thread_local auto md = lnav::pcre2pp::match_data::unitialized();
+
+    return this->first_matching_pattern(line, md);
+}
+
+std::optional<int>
+external_log_format::first_matching_pattern(
+    string_fragment line, lnav::pcre2pp::match_data& md) const
+{
+    if (!this->elf_combined_pattern) {
+        return std::nullopt;
+    }
+
+    auto match_res = this->elf_combined_pattern->capture_from(line)
+                         .into(md)
+                         .matches(PCRE2_NO_UTF_CHECK);
+
+    return match_res.match(
+        [this, &md](lnav::pcre2pp::matcher::found) -> std::optional<int> {
+            auto mark = md.get_mark();
+            auto scan_res = scn::scan_value<int>(mark.to_string_view());
+
+            if (!scan_res
+                || scan_res->value()
+                    >= (int) this->elf_combined_capture_offsets.size())
+            {
+                return std::nullopt;
+            }
+            md.set_capture_offset(
+                this->elf_combined_capture_offsets[scan_res->value()]);
+            return scan_res->value();
+        },
+        [](lnav::pcre2pp::matcher::not_found) -> std::optional<int> {
+            return -1;
+        },
+        [](lnav::pcre2pp::matcher::error) -> std::optional<int> {
+            // Probably hit a match limit, let the individual patterns
+            // sort it out.
+            return std::nullopt;
+        });
+}
+
 bool
 external_log_format::scan_for_partial(const log_format_file_state& lffs,
                                       shared_buffer_ref& sbr,
@@ -2054,12 +2259,31 @@ external_log_format::scan(logfile& lf,
     thread_local auto md = lnav::pcre2pp::match_data::unitialized();
     char tmp_opid_buf[hasher::STRING_SIZE];
 
+    auto tried_combined = false;
+
     while (::next_format(this->elf_pattern_order, curr_fmt, pat_index)) {
+        // Set when md already holds the captures for curr_fmt from the
+        // combined pattern, so the pattern does not need to be run again.
+        auto combined_match = false;
+
+        if (pat_index == -1 && !tried_combined) {
+            tried_combined = true;
+
+            auto first_res = this->first_matching_pattern(line_sf, md);
+            if (first_res) {
+                if (first_res.value() == -1) {
+                    break;
+                }
+                combined_match = first_res.value() >= curr_fmt;
+                curr_fmt = std::max(curr_fmt, first_res.value());
+            }
+        }
+
         auto* fpat = this->elf_pattern_order[curr_fmt].get();
         auto* pat = fpat->p_pcre.pp_value.get();
 
-        auto found_match
-            = pat->capture_from(line_sf).into(md).found_p(PCRE2_NO_UTF_CHECK);
+        auto found_match = combined_match
+            || pat->capture_from(line_sf).into(md).found_p(PCRE2_NO_UTF_CHECK);
         if (!found_match) {
             if (!sbc.sbc_pattern_locks.empty() && pat_index != -1) {
                 curr_fmt = -1;
@@ -2329,8 +2553,8 @@ external_log_format::scan(logfile& lf,
                     if (scaling != nullptr) {
                         scaling->scale(dvalue);
                     }
-                    sbc.sbc_value_stats[vd.vd_meta.lvm_values_index.value()]
-                        .add_value(dvalue);
+                    sbc.add_value(vd.vd_meta.lvm_values_index.value(),
+                                  dvalue);
                 }
             }
         }
@@ -4570,6 +4794,7 @@ external_log_format::build(std::vector<lnav::console::user_message>& errors)
 
         this->elf_pattern_order.push_back(elf_pattern.second);
     }
+    this->build_combined_pattern();
     if (this->elf_type == elf_type_t::ELF_TYPE_TEXT
         && !this->elf_src_file_field.empty() && src_file_found == 0)
     {
@@ -5423,7 +5648,7 @@ external_log_format::value_line_count(scan_batch_context& sbc,
             lvs.lvs_width = len;
         }
         if (val) {
-            lvs.add_value(val.value());
+            sbc.add_value(vd->vd_meta.lvm_values_index.value(), val.value());
         }
     }
 
@@ -5741,6 +5966,7 @@ external_log_format::hide_field(const intern_string_t field_name, bool val)
     }
 
     vd_iter->second->vd_meta.lvm_user_hidden = val;
+    *this->lf_display_generation += 1;
     if (this->elf_type == elf_type_t::ELF_TYPE_JSON) {
         bool found = false;
 
@@ -191,6 +191,15 @@ public:
                                shared_buffer_ref& sbr,
                                scan_batch_context& sbc) = 0;
 
+    /**
+     * A cheap check that is done before calling scan() while detecting the
+     * format of a file.
+     *
+     * @param line The contents of the line.
+     * @return False if scan() would definitely not match the line.
+     */
+    virtual bool might_match_line(string_fragment line) const { return true; }
+
     virtual bool scan_for_partial(const log_format_file_state& lffs,
                                   shared_buffer_ref& sbr,
                                   size_t& len_out) const
@@ -261,6 +270,16 @@ public:
         return false;
     }
 
+    /**
+     * @return A number that changes whenever something that affects how
+     *   the messages in this format are displayed, like a hidden field, has
+     *   changed.
+     */
+    virtual size_t get_display_generation() const
+    {
+        return *this->lf_display_generation;
+    }
+
     virtual std::map<intern_string_t, logline_value_meta> get_field_states()
     {
         return {};
@@ -342,6 +361,9 @@ public:
     bool lf_time_ordered{true};
     bool lf_specialized{false};
     bool lf_level_hideable{true};
+    /** Shared with the specialized copies of this format. */
+    std::shared_ptr<size_t> lf_display_generation{
+        std::make_shared<size_t>(0)};
     std::optional<uint64_t> lf_max_unrecognized_lines;
     std::map<const intern_string_t, std::shared_ptr<format_tag_def>>
         lf_tag_defs;
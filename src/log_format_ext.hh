@@ -153,6 +153,8 @@ public:
                        shared_buffer_ref& sbr,
                        scan_batch_context& sbc) override;
 
+    bool might_match_line(string_fragment line) const override;
+
     bool scan_for_partial(const log_format_file_state& lffs,
                           shared_buffer_ref& sbr,
                           size_t& len_out) const override;
@@ -176,6 +178,12 @@ public:
 
     bool hide_field(const intern_string_t field_name, bool val) override;
 
+    size_t get_display_generation() const override
+    {
+        return log_format::get_display_generation()
+            + this->elf_value_defs_state->vds_generation;
+    }
+
     std::map<intern_string_t, logline_value_meta> get_field_states() override
     {
         std::map<intern_string_t, logline_value_meta> retval;
@@ -332,6 +340,18 @@ public:
     factory_container<lnav::pcre2pp::code> elf_filename_pcre;
     std::map<std::string, std::shared_ptr<pattern>> elf_patterns;
     std::vector<std::shared_ptr<pattern>> elf_pattern_order;
+    /**
+     * All of the patterns in elf_pattern_order joined into a single
+     * alternation, with each branch tagged by a (*MARK) of its index.  This
+     * is only built when the result is equivalent to trying the patterns
+     * one after the other, see build_combined_pattern().
+     */
+    std::shared_ptr<lnav::pcre2pp::code> elf_combined_pattern;
+    /**
+     * The number of captures in the combined pattern that come before the
+     * ones for each pattern in elf_pattern_order.
+     */
+    std::vector<size_t> elf_combined_capture_offsets;
     std::vector<sample_t> elf_samples;
     std::unordered_map<const intern_string_t, std::shared_ptr<value_def>>
         elf_value_defs;
@@ -410,6 +430,25 @@ public:
 
     elf_type_t elf_type{elf_type_t::ELF_TYPE_TEXT};
 
+    void build_combined_pattern();
+
+    /**
+     * Use the combined pattern to find the first pattern that matches the
+     * given line.
+     *
+     * @return The index of the pattern, -1 if no pattern matches, or
+     *   std::nullopt if the combined pattern could not be used.
+     */
+    std::optional<int> first_matching_pattern(string_fragment line) const;
+
+    /**
+     * Like first_matching_pattern(), but the match is captured into the
+     * given match data.  When a pattern matches, the capture offset is set
+     * so the captures can be read with that pattern's group numbers.
+     */
+    std::optional<int> first_matching_pattern(
+        string_fragment line, lnav::pcre2pp::match_data& md) const;
+
     scan_result_t scan_json(std::vector<logline>& dst,
                             const line_info& li,
                             shared_buffer_ref& sbr,
@@ -47,6 +47,7 @@
 #include "base/intern_string.hh"
 #include "base/log_level_enum.hh"
 #include "base/map_util.hh"
+#include "base/posting_list.hh"
 #include "base/small_string_map.hh"
 #include "base/string_attr_type.hh"
 #include "base/time_util.hh"
@@ -125,6 +126,8 @@ using sub_opid_map = robin_hood::unordered_map<string_fragment,
 struct log_opid_state {
     log_opid_map los_opid_ranges;
     sub_opid_map los_sub_in_use;
+    /** The opid passed to the most recent insert_op() call. */
+    string_fragment los_last_opid;
 
     log_opid_map::iterator insert_op(ArenaAlloc::Alloc<char>& alloc,
                                      const string_fragment& opid,
@@ -143,6 +146,7 @@ struct log_opid_state {
     {
         this->los_opid_ranges.clear();
         this->los_sub_in_use.clear();
+        this->los_last_opid = string_fragment{};
     }
 };
 
@@ -168,12 +172,47 @@ using log_thread_id_map
 
 struct log_thread_id_state {
     log_thread_id_map ltis_tid_ranges;
+    /** The thread ID passed to the most recent insert_tid() call. */
+    string_fragment ltis_last_tid;
 
     log_thread_id_map::iterator insert_tid(ArenaAlloc::Alloc<char>& alloc,
                                            const string_fragment& tid,
                                            const std::chrono::microseconds& us);
 
-    void clear() { this->ltis_tid_ranges.clear(); }
+    void clear()
+    {
+        this->ltis_tid_ranges.clear();
+        this->ltis_last_tid = string_fragment{};
+    }
+};
+
+using log_posting_map
+    = robin_hood::unordered_map<string_fragment,
+                                lnav::posting_list,
+                                frag_hasher,
+                                std::equal_to<string_fragment>>;
+
+/**
+ * Inverted indexes from opids and thread IDs to the lines of the messages
+ * that have them, so that lookups by ID do not need to scan the file.
+ */
+struct log_line_postings {
+    log_posting_map llp_opids;
+    log_posting_map llp_tids;
+
+    void add_line(uint32_t line_number,
+                  const string_fragment& opid,
+                  const string_fragment& tid);
+
+    void merge(const log_line_postings& other);
+
+    size_t memory_size() const;
+
+    void clear()
+    {
+        this->llp_opids.clear();
+        this->llp_tids.clear();
+    }
 };
 
 struct logline_value_stats {
@@ -214,11 +253,25 @@ struct pattern_locks {
 };
 
 struct scan_batch_context {
+    /**
+     * Add a numeric value from the line being scanned to the stats.  The
+     * value is also kept in sbc_line_values until the logfile adds it to
+     * the time rollups, since the time of the message may not be known
+     * yet when the value is found.
+     */
+    void add_value(size_t index, double value)
+    {
+        this->sbc_value_stats[index].add_value(value);
+        this->sbc_line_values.emplace_back(index, value);
+    }
+
     ArenaAlloc::Alloc<char>& sbc_allocator;
     pattern_locks& sbc_pattern_locks;
     std::vector<logline_value_stats> sbc_value_stats;
+    std::vector<std::pair<size_t, double>> sbc_line_values;
     log_opid_state sbc_opids;
     log_thread_id_state sbc_tids;
+    log_line_postings sbc_postings;
     lnav::small_string_map sbc_level_cache;
 };
 
@@ -368,14 +368,17 @@ public:
     {
         if (field_name == TS_META.lvm_name) {
             TS_META.lvm_user_hidden = val;
+            *this->lf_display_generation += 1;
             return true;
         }
         if (field_name == LEVEL_META.lvm_name) {
             LEVEL_META.lvm_user_hidden = val;
+            *this->lf_display_generation += 1;
             return true;
         }
         if (field_name == OPID_META.lvm_name) {
             OPID_META.lvm_user_hidden = val;
+            *this->lf_display_generation += 1;
             return true;
         }
         return false;
@@ -715,8 +718,8 @@ public:
                         const auto sv = (*iter).to_string_view();
                         auto scan_float_res = scn::scan_value<double>(sv);
                         if (scan_float_res) {
-                            sbc.sbc_value_stats[fd.fd_numeric_index.value()]
-                                .add_value(scan_float_res->value());
+                            sbc.add_value(fd.fd_numeric_index.value(),
+                                          scan_float_res->value());
                         }
                         break;
                     }
@@ -1014,6 +1017,7 @@ public:
         }
 
         fd_iter->second.lvm_user_hidden = val;
+        *this->lf_display_generation += 1;
 
         return true;
     }
@@ -1548,8 +1552,8 @@ public:
                             = scn::scan_value<double>(sf.to_string_view());
 
                         if (scan_float_res) {
-                            sbc.sbc_value_stats[fd.fd_numeric_index.value()]
-                                .add_value(scan_float_res->value());
+                            sbc.add_value(fd.fd_numeric_index.value(),
+                                          scan_float_res->value());
                         }
                         break;
                     }
@@ -1845,6 +1849,7 @@ public:
             }
             date_iter->second.lvm_user_hidden = val;
             time_iter->second.lvm_user_hidden = val;
+            *this->lf_display_generation += 1;
             return true;
         }
 
@@ -1854,6 +1859,7 @@ public:
         }
 
         fd_iter->second.lvm_user_hidden = val;
+        *this->lf_display_generation += 1;
 
         return true;
     }
@@ -51,6 +51,7 @@
 #include "file_format.hh"
 #include "fmt/format.h"
 #include "format.scripts.hh"
+#include "hasher.hh"
 #include "lnav_config.hh"
 #include "log_format.hh"
 #include "log_format_ext.hh"
@@ -1496,6 +1497,126 @@ load_from_path(const std::filesystem::path& path,
     }
 }
 
+/**
+ * The collisions between formats only depend on the patterns and the
+ * samples, so they are hashed to get the key for the cached collisions.
+ */
+static std::string
+format_collisions_key()
+{
+    auto h = hasher();
+
+    h.update(VCS_PACKAGE_STRING);
+    for (const auto& pair : LOG_FORMATS) {
+        const auto& elf = pair.second;
+
+        h.update(elf->get_name().to_string_fragment());
+        h.update(static_cast<int64_t>(elf->elf_pattern_order.size()));
+        for (const auto& pat : elf->elf_pattern_order) {
+            if (pat->p_pcre.pp_value) {
+                h.update(pat->p_pcre.pp_value->get_pattern());
+            }
+            h.update(static_cast<int64_t>(0));
+        }
+        h.update(static_cast<int64_t>(elf->elf_samples.size()));
+        for (const auto& sample : elf->elf_samples) {
+            h.update(sample.s_line.pp_value);
+            h.update(static_cast<int64_t>(0));
+        }
+    }
+
+    return h.to_string();
+}
+
+static std::filesystem::path
+format_collisions_cache_dir()
+{
+    return lnav::paths::workdir() / "format-cache";
+}
+
+/**
+ * Load the format collisions from the cache.  Each line in the file has
+ * the name of a format followed by the names of the formats with samples
+ * that it matches, separated by tabs.
+ */
+static bool
+load_format_collisions(const std::filesystem::path& path)
+{
+    auto read_res = lnav::filesystem::read_file(path);
+    if (read_res.isErr()) {
+        return false;
+    }
+
+    auto content = read_res.unwrap();
+    std::map<intern_string_t, std::list<intern_string_t>> collisions;
+    for (const auto& line : string_fragment{content}.split_lines()) {
+        auto remaining = line.trim("\n");
+        if (remaining.empty()) {
+            continue;
+        }
+
+        auto name_split = remaining.split_when(string_fragment::tag1{'\t'});
+        auto name = intern_string_t{intern_string::lookup(name_split.first)};
+        if (LOG_FORMATS.count(name) == 0) {
+            log_warning("format collision cache is stale: %s", path.c_str());
+            return false;
+        }
+
+        auto& coll = collisions[name];
+        remaining = name_split.second;
+        while (!remaining.empty()) {
+            auto coll_split
+                = remaining.split_when(string_fragment::tag1{'\t'});
+
+            coll.emplace_back(intern_string::lookup(coll_split.first));
+            remaining = coll_split.second;
+        }
+    }
+    if (collisions.size() != LOG_FORMATS.size()) {
+        log_warning("format collision cache is incomplete: %s", path.c_str());
+        return false;
+    }
+
+    for (auto& pair : collisions) {
+        LOG_FORMATS[pair.first]->elf_collision = std::move(pair.second);
+    }
+
+    return true;
+}
+
+static void
+save_format_collisions(const std::filesystem::path& path)
+{
+    std::string content;
+
+    for (const auto& pair : LOG_FORMATS) {
+        content.append(pair.first.get());
+        for (const auto& coll : pair.second->elf_collision) {
+            content.push_back('\t');
+            content.append(coll.get());
+        }
+        content.push_back('\n');
+    }
+
+    std::error_code ec;
+    auto cache_dir = path.parent_path();
+
+    // Only one entry is kept since older ones are for formats that have
+    // since been changed.
+    for (const auto& entry :
+         std::filesystem::directory_iterator(cache_dir, ec))
+    {
+        std::filesystem::remove(entry.path(), ec);
+    }
+    std::filesystem::create_directories(cache_dir, ec);
+    auto write_res = lnav::filesystem::write_file(path, content);
+    if (write_res.isErr()) {
+        log_warning("unable to write format collision cache: %s -- %s",
+                    path.c_str(),
+                    write_res.unwrapErr().c_str());
+    }
+}
+
 void
 load_formats(const std::vector<std::filesystem::path>& extra_paths,
              std::vector<lnav::console::user_message>& errors)
@@ -1506,6 +1627,10 @@ load_formats(const std::vector<std::filesystem::path>& extra_paths,
     std::vector<intern_string_t> retval;
     loader_userdata ud;
     yajl_handle handle;
+    // Most formats will never be a candidate for the files being viewed,
+    // so the cost of JIT-compiling their patterns is deferred until they
+    // are actually used.
+    lnav::pcre2pp::code::deferred_jit_guard jit_guard;
 
     write_sample_file();
 
@@ -1532,26 +1657,41 @@ load_formats(const std::vector<std::filesystem::path>& extra_paths,
     }
 
     std::vector<std::shared_ptr<external_log_format>> alpha_ordered_formats;
-    for (auto iter = LOG_FORMATS.begin(); iter != LOG_FORMATS.end(); ++iter) {
-        auto& elf = iter->second;
-        elf->build(errors);
+    for (auto& pair : LOG_FORMATS) {
+        pair.second->build(errors);
+        alpha_ordered_formats.push_back(pair.second);
+    }
 
-        for (auto& check_iter : LOG_FORMATS) {
-            if (iter->first == check_iter.first) {
-                continue;
-            }
+    // Checking every format against the samples of every other format is
+    // quadratic, so the result is cached until the formats change.
+    auto collisions_path
+        = format_collisions_cache_dir() / format_collisions_key();
+    if (load_format_collisions(collisions_path)) {
+        log_info("loaded format collisions from cache: %s",
+                 collisions_path.c_str());
+    } else {
+        for (auto iter = LOG_FORMATS.begin(); iter != LOG_FORMATS.end();
+             ++iter)
+        {
+            auto& elf = iter->second;
+
+            for (auto& check_iter : LOG_FORMATS) {
+                if (iter->first == check_iter.first) {
+                    continue;
+                }
 
-            auto& check_elf = check_iter.second;
-            if (elf->match_samples(check_elf->elf_samples)) {
-                log_warning(
-                    "Format collision, format '%s' matches sample from '%s'",
-                    elf->get_name().get(),
-                    check_elf->get_name().get());
-                elf->elf_collision.push_back(check_elf->get_name());
+                auto& check_elf = check_iter.second;
+                if (elf->match_samples(check_elf->elf_samples)) {
+                    log_warning(
+                        "Format collision, format '%s' matches sample from "
+                        "'%s'",
+                        elf->get_name().get(),
+                        check_elf->get_name().get());
+                    elf->elf_collision.push_back(check_elf->get_name());
+                }
             }
         }
-
-        alpha_ordered_formats.push_back(elf);
+        save_format_collisions(collisions_path);
     }
 
     // Prioritize formats that have a filename pattern over those that don't so
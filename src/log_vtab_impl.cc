@@ -657,7 +657,18 @@ vt_next(sqlite3_vtab_cursor* cur)
         while (vc->log_cursor.lc_curr_line != -1_vl && !vc->log_cursor.is_eof()
                && !vt->vi->is_valid(vc->log_cursor, *vt->lss))
         {
-            vc->log_cursor.lc_curr_line += vc->log_cursor.lc_direction;
+            // Lines in the indexed range that are not in the index do not
+            // match, so skip ahead to the next indexed line.
+            if (!vc->log_cursor.lc_indexed_lines.empty()
+                && vc->log_cursor.lc_indexed_lines_range.contains(
+                    vc->log_cursor.lc_curr_line))
+            {
+                vc->log_cursor.lc_curr_line
+                    = vc->log_cursor.lc_indexed_lines.back();
+                vc->log_cursor.lc_indexed_lines.pop_back();
+            } else {
+                vc->log_cursor.lc_curr_line += vc->log_cursor.lc_direction;
+            }
             vc->log_cursor.lc_sub_index = 0;
         }
         if (vc->log_cursor.is_eof()) {
@@ -768,6 +779,44 @@ vt_next_no_rowid(sqlite3_vtab_cursor* cur)
     return SQLITE_OK;
 }
 
+static bool
+uses_column_cache(const log_vtab* vt, logfile* lf)
+{
+    // The cache is indexed by the columns of the format's own table.
+    return vt->vi->vi_provenance == log_vtab_impl::provenance_t::format
+        && vt->vi->get_name() == lf->get_format_name();
+}
+
+static void
+cached_cell_to_sqlite(sqlite3_context* ctx,
+                      const lnav::log::column_cache::cell& ce)
+{
+    using cell_kind = lnav::log::column_cache::cell_kind;
+
+    switch (ce.c_kind) {
+        case cell_kind::unknown:
+        case cell_kind::null:
+            sqlite3_result_null(ctx);
+            break;
+        case cell_kind::boolean:
+        case cell_kind::integer:
+            sqlite3_result_int64(ctx, ce.c_integer);
+            break;
+        case cell_kind::real:
+            sqlite3_result_double(ctx, ce.c_real);
+            break;
+        case cell_kind::text:
+            sqlite3_result_text(
+                ctx, ce.c_text.data(), ce.c_text.length(), SQLITE_TRANSIENT);
+            break;
+        case cell_kind::json:
+            sqlite3_result_text(
+                ctx, ce.c_text.data(), ce.c_text.length(), SQLITE_TRANSIENT);
+            sqlite3_result_subtype(ctx, JSON_SUBTYPE);
+            break;
+    }
+}
+
 static int
 vt_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int col)
 {
@@ -992,10 +1041,10 @@ vt_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int col)
                         break;
                     }
                     case log_footer_columns::filters: {
-                        const auto& filter_mask
-                            = (*ld)->ld_filter_state.lfo_filter_state.tfs_mask;
+                        const auto& filter_state
+                            = (*ld)->ld_filter_state.lfo_filter_state;
 
-                        if (!filter_mask[line_number]) {
+                        if (!filter_state.any_mask(line_number)) {
                             sqlite3_result_null(ctx);
                         } else {
                             const auto& filters = vt->lss->get_filters();
@@ -1011,10 +1060,9 @@ vt_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int col)
                                         continue;
                                     }
 
-                                    uint32_t mask
-                                        = (1UL << filter->get_index());
-
-                                    if (filter_mask[line_number] & mask) {
+                                    if (filter_state.test_mask(
+                                            line_number, filter->get_index()))
+                                    {
                                         arr.gen(filter->get_index());
                                     }
                                 }
@@ -1277,11 +1325,26 @@ vt_column(sqlite3_vtab_cursor* cur, sqlite3_context* ctx, int col)
                     }
                 }
             } else {
+                const auto use_cache = uses_column_cache(vt, lf);
+
+                if (use_cache && vc->line_values.lvv_values.empty()) {
+                    auto cell_opt = lf->get_column_cache().lookup(
+                        line_number, (size_t) (col - VT_COL_MAX));
+
+                    if (cell_opt) {
+                        cached_cell_to_sqlite(ctx, cell_opt.value());
+                        break;
+                    }
+                }
                 if (vc->line_values.lvv_values.empty()) {
                     vc->cache_msg(lf, ll);
                     require(vc->line_values.lvv_sbr.get_data() != nullptr);
                     vt->vi->extract(
                         lf, line_number, vc->attrs, vc->line_values);
+                    if (use_cache) {
+                        lf->get_column_cache().store(line_number,
+                                                     vc->line_values);
+                    }
                 }
 
                 auto sub_col = logline_value_meta::table_column{
@@ -1634,6 +1697,91 @@ struct vtab_time_range {
     }
 };
 
+/**
+ * Use the opid/thread-ID postings that are kept by the log files to visit
+ * only the messages with the given ID instead of scanning every line in
+ * the cursor's range.
+ */
+static void
+populate_lines_from_postings(log_vtab* vt,
+                             log_cursor& lc,
+                             const std::optional<std::string>& opid,
+                             const std::optional<std::string>& tid)
+{
+    // The postings are only worth it when they skip most of the range.
+    static constexpr size_t MIN_SKIP_RATIO = 4;
+
+    if (lc.lc_direction > 0 ? lc.lc_curr_line >= lc.lc_end_line
+                            : lc.lc_curr_line <= lc.lc_end_line)
+    {
+        return;
+    }
+
+    auto scan_range
+        = msg_range::empty()
+              .expand_to(lc.lc_curr_line)
+              .expand_to(lc.lc_end_line
+                         - (lc.lc_direction > 0 ? 1_vl : -1_vl));
+    auto scan_valid = scan_range.get_valid().value();
+    auto range_size
+        = (size_t) (scan_valid.v_max_line - scan_valid.v_min_line);
+
+    std::vector<std::pair<content_line_t, std::vector<uint32_t>>> file_lines;
+    size_t candidate_count = 0;
+    for (auto iter = vt->lss->begin(); iter != vt->lss->end(); ++iter) {
+        auto* lf = (*iter)->get_file_ptr();
+
+        if (lf == nullptr || !(*iter)->is_visible()) {
+            continue;
+        }
+
+        auto lines_opt = opid ? lf->lines_for_opid(opid.value())
+                              : lf->lines_for_thread_id(tid.value());
+        if (!lines_opt) {
+            log_debug("postings are not usable for file: %s",
+                      lf->get_filename_as_string().c_str());
+            return;
+        }
+
+        candidate_count += lines_opt->size();
+        if (candidate_count * MIN_SKIP_RATIO > range_size) {
+            log_debug("too many lines in postings to skip scanning");
+            return;
+        }
+        file_lines.emplace_back(vt->lss->get_file_base_content_line(iter),
+                                std::move(lines_opt.value()));
+    }
+
+    std::vector<vis_line_t> indexed_lines;
+    indexed_lines.reserve(candidate_count + 1);
+    for (const auto& [base_cl, lines] : file_lines) {
+        for (const auto line_number : lines) {
+            auto vl_opt = vt->lss->find_from_content(
+                content_line_t{base_cl + line_number});
+
+            if (vl_opt && scan_valid.contains(vl_opt.value())) {
+                indexed_lines.emplace_back(vl_opt.value());
+            }
+        }
+    }
+
+    log_info("using postings to visit %zu of %zu lines",
+             indexed_lines.size(),
+             range_size);
+    // Add a line past the end of the range so the cursor hits EOF after
+    // the last indexed line.
+    if (lc.lc_direction < 0) {
+        indexed_lines.emplace_back(scan_valid.v_min_line - 1_vl);
+        std::sort(indexed_lines.begin(), indexed_lines.end(), std::less<>());
+    } else {
+        indexed_lines.emplace_back(scan_valid.v_max_line);
+        std::sort(
+            indexed_lines.begin(), indexed_lines.end(), std::greater<>());
+    }
+    lc.lc_indexed_lines = std::move(indexed_lines);
+    lc.lc_indexed_lines_range = scan_range;
+}
+
 static int
 vt_filter(sqlite3_vtab_cursor* p_vtc,
           int idxNum,
@@ -1698,6 +1846,8 @@ vt_filter(sqlite3_vtab_cursor* p_vtc,
     std::optional<vtab_time_range> log_time_range;
     std::optional<uint64_t> opid_val;
     std::optional<uint64_t> tid_val;
+    std::optional<std::string> posting_opid;
+    std::optional<std::string> posting_tid;
     std::vector<log_cursor::string_constraint> log_path_constraints;
     std::vector<log_cursor::string_constraint> log_unique_path_constraints;
 
@@ -1861,6 +2011,7 @@ vt_filter(sqlite3_vtab_cursor* p_vtc,
                             }
 
                             opid_val = opid.bloom_bits();
+                            posting_opid = opid.to_string();
                             break;
                         }
                         case log_footer_columns::path: {
@@ -2003,6 +2154,7 @@ vt_filter(sqlite3_vtab_cursor* p_vtc,
                             }
 
                             tid_val = tid.bloom_bits();
+                            posting_tid = tid.to_string();
                             break;
                         }
                     }
@@ -2249,6 +2401,13 @@ vt_filter(sqlite3_vtab_cursor* p_vtc,
         }
     }
 
+    if (p_cur->log_cursor.lc_indexed_columns.empty()
+        && (posting_opid || posting_tid))
+    {
+        populate_lines_from_postings(
+            vt, p_cur->log_cursor, posting_opid, posting_tid);
+    }
+
     p_cur->log_cursor.lc_opid_bloom_bits = opid_val;
     p_cur->log_cursor.lc_tid_bloom_bits = tid_val;
     p_cur->log_cursor.lc_log_path = std::move(log_path_constraints);
@@ -54,6 +54,7 @@
 #include "base/injector.hh"
 #include "base/intern_string.hh"
 #include "base/is_utf8.hh"
+#include "base/paths.hh"
 #include "base/result.h"
 #include "base/snippet_highlighters.hh"
 #include "base/string_util.hh"
@@ -234,6 +235,12 @@ logfile::open(std::filesystem::path filename,
     lf->file_options_have_changed();
     lf->lf_content_id = hasher().update(lf->lf_filename_as_string).to_string();
 
+    if (lf->lf_line_buffer.has_independent_members()) {
+        // We're on a background thread, so take the opportunity to
+        // decompress everything in parallel before indexing starts.
+        lf->lf_line_buffer.enable_cache();
+    }
+
     lf->lf_line_buffer.set_do_preloading(true);
     lf->lf_line_buffer.send_initial_load();
 
@@ -321,19 +328,710 @@ logfile::reset_internal_state_for_reindex()
     this->lf_index_size = 0;
     this->lf_level_stats = {};
     this->lf_partial_line = false;
+    this->lf_skipping_message = false;
     this->lf_longest_line = 0;
     this->lf_sort_needed = true;
+    this->lf_index_caught_up = false;
     this->lf_out_of_time_order_count = 0;
     this->lf_pattern_locks.pl_lines.clear();
     this->lf_value_stats.clear();
+    this->lf_value_rollups.clear();
     this->lf_opids.writeAccess()->clear();
     this->lf_thread_ids.writeAccess()->clear();
+    this->lf_line_postings.writeAccess()->clear();
     this->lf_allocator.reset();
+    this->lf_index_cache_size = 0;
+    this->lf_column_cache.clear();
     if (this->lf_logline_observer) {
         this->lf_logline_observer->logline_clear(*this);
     }
 }
 
+namespace {
+
+constexpr char INDEX_CACHE_MAGIC[] = "lnav-idx";
+constexpr uint32_t INDEX_CACHE_VERSION = 2;
+
+/**
+ * Files with less content than this are quick enough to index that
+ * it is not worth the trouble of caching them.
+ */
+constexpr file_ssize_t INDEX_CACHE_MIN_SIZE = 1024 * 1024;
+
+static_assert(std::is_trivially_copyable_v<logline>);
+static_assert(std::is_trivially_copyable_v<log_level_stats>);
+
+class index_cache_writer {
+public:
+    template<typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        this->icw_buffer.append((const char*) &value, sizeof(value));
+    }
+
+    void write(const std::chrono::microseconds& us)
+    {
+        this->write(static_cast<int64_t>(us.count()));
+    }
+
+    void write(const time_range& tr)
+    {
+        this->write(tr.tr_begin);
+        this->write(tr.tr_end);
+    }
+
+    void write(const string_fragment& sf)
+    {
+        this->write(static_cast<uint32_t>(sf.length()));
+        this->icw_buffer.append(sf.data(), sf.length());
+    }
+
+    void write(const std::string& str)
+    {
+        this->write(string_fragment::from_str(str));
+    }
+
+    std::string icw_buffer;
+};
+
+class index_cache_reader {
+public:
+    explicit index_cache_reader(string_fragment sf) : icr_remaining(sf) {}
+
+    template<typename T>
+    bool read(T& value_out)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        if (this->icr_remaining.length() < (int) sizeof(value_out)) {
+            return false;
+        }
+        memcpy(&value_out, this->icr_remaining.data(), sizeof(value_out));
+        this->icr_remaining = this->icr_remaining.substr(sizeof(value_out));
+        return true;
+    }
+
+    bool read(std::chrono::microseconds& us_out)
+    {
+        int64_t count;
+
+        if (!this->read(count)) {
+            return false;
+        }
+        us_out = std::chrono::microseconds(count);
+        return true;
+    }
+
+    bool read(time_range& tr_out)
+    {
+        return this->read(tr_out.tr_begin) && this->read(tr_out.tr_end);
+    }
+
+    bool read(string_fragment& sf_out)
+    {
+        uint32_t len;
+
+        if (!this->read(len) || this->icr_remaining.length() < (int) len) {
+            return false;
+        }
+        sf_out = this->icr_remaining.sub_range(0, len);
+        this->icr_remaining = this->icr_remaining.substr(len);
+        return true;
+    }
+
+    bool read(std::string& str_out)
+    {
+        string_fragment sf;
+
+        if (!this->read(sf)) {
+            return false;
+        }
+        str_out = sf.to_string();
+        return true;
+    }
+
+    /**
+     * Read a count of elements that are at least min_elem_size bytes each
+     * and make sure the buffer is large enough to hold them.
+     */
+    bool read_count(uint64_t& count_out, size_t min_elem_size)
+    {
+        return this->read(count_out)
+            && count_out <= this->icr_remaining.length() / min_elem_size;
+    }
+
+    string_fragment icr_remaining;
+};
+
+void
+write_postings(index_cache_writer& icw, const log_posting_map& postings)
+{
+    icw.write(static_cast<uint64_t>(postings.size()));
+    for (const auto& [key, lines] : postings) {
+        icw.write(key);
+        icw.write(lines.to_bytes());
+    }
+}
+
+/**
+ * Read postings written by write_postings().  The keys refer to the
+ * reader's buffer and need to be copied before the buffer goes away.
+ */
+bool
+read_postings(index_cache_reader& icr, log_posting_map& postings_out)
+{
+    uint64_t count = 0;
+
+    if (!icr.read_count(count, sizeof(uint32_t) * 2)) {
+        return false;
+    }
+    for (uint64_t lpc = 0; lpc < count; lpc++) {
+        string_fragment key;
+        string_fragment bytes;
+
+        if (!icr.read(key) || !icr.read(bytes)) {
+            return false;
+        }
+
+        auto lines = lnav::posting_list::from_bytes(bytes);
+        if (!lines) {
+            return false;
+        }
+        postings_out.emplace(key, std::move(lines.value()));
+    }
+
+    return true;
+}
+
+std::filesystem::path
+index_cache_dir()
+{
+    return lnav::paths::workdir() / "index-cache";
+}
+
+}  // namespace
+
+std::optional<std::filesystem::path>
+logfile::index_cache_path() const
+{
+    if (this->lf_format == nullptr || this->lf_content_id.empty()) {
+        return std::nullopt;
+    }
+
+    /*
+     * The key covers everything that has an effect on the contents of the
+     * index, so a change in the format definitions or time zone settings
+     * will naturally miss the old entry.
+     */
+    auto h = hasher();
+    h.update(this->lf_content_id);
+    h.update(this->lf_format->get_name().to_string_fragment());
+    h.update(VCS_PACKAGE_STRING);
+    for (const auto& src_path : this->lf_format->get_source_path()) {
+        std::error_code ec;
+        auto mtime = std::filesystem::last_write_time(src_path, ec);
+
+        h.update(src_path);
+        if (!ec) {
+            h.update(static_cast<int64_t>(mtime.time_since_epoch().count()));
+        }
+    }
+    h.update(static_cast<int64_t>(this->lf_zoned_to_local_state));
+    if (this->lf_file_options) {
+        const auto* tz = this->lf_file_options->second.fo_default_zone.pp_value;
+        if (tz != nullptr) {
+            h.update(tz->name());
+        }
+    }
+
+    auto key = h.to_string();
+    return index_cache_dir() / key.substr(0, 2) / key;
+}
+
+bool
+logfile::load_index_cache(const struct stat& st)
+{
+    if (this->lf_line_buffer.is_compressed() || this->lf_line_buffer.is_piper()
+        || st.st_size < INDEX_CACHE_MIN_SIZE
+        || this->lf_options.loo_time_range.has_bounds()
+        || this->lf_options.loo_min_level != LEVEL_UNKNOWN
+        || !this->lf_applicable_taggers.empty()
+        || !this->lf_applicable_partitioners.empty()
+        || lnav::log::watch::has_enabled_exprs())
+    {
+        return false;
+    }
+
+    auto path_opt = this->index_cache_path();
+    if (!path_opt) {
+        return false;
+    }
+
+    auto read_res = lnav::filesystem::read_file(path_opt.value());
+    if (read_res.isErr()) {
+        return false;
+    }
+
+    auto content = read_res.unwrap();
+    auto icr = index_cache_reader{string_fragment::from_str(content)};
+    char magic[sizeof(INDEX_CACHE_MAGIC)];
+    uint32_t version = 0;
+    file_off_t index_size = 0;
+    uint64_t longest_line = 0;
+    string_fragment tail_hash;
+
+    if (!icr.read(magic)
+        || memcmp(magic, INDEX_CACHE_MAGIC, sizeof(magic)) != 0
+        || !icr.read(version) || version != INDEX_CACHE_VERSION
+        || !icr.read(index_size) || !icr.read(longest_line)
+        || !icr.read(tail_hash))
+    {
+        log_warning("%s: ignoring invalid index cache -- %s",
+                    this->lf_filename_as_string.c_str(),
+                    path_opt->c_str());
+        return false;
+    }
+
+    if (index_size > st.st_size) {
+        log_info("%s: file is smaller than the cached index",
+                 this->lf_filename_as_string.c_str());
+        return false;
+    }
+
+    uint64_t line_count = 0;
+    if (!icr.read_count(line_count, sizeof(logline)) || line_count == 0
+        || line_count < this->lf_index.size())
+    {
+        return false;
+    }
+
+    std::vector<logline> lines(
+        line_count, logline{0, std::chrono::microseconds{0}, LEVEL_UNKNOWN});
+    for (auto& ll : lines) {
+        icr.read(ll);
+    }
+
+    // The lines we just scanned should agree with what was cached.
+    for (size_t lpc = 0; lpc < this->lf_index.size(); lpc++) {
+        if (lines[lpc].get_offset() != this->lf_index[lpc].get_offset()
+            || lines[lpc].get_time<std::chrono::microseconds>()
+                != this->lf_index[lpc].get_time<std::chrono::microseconds>())
+        {
+            log_info("%s: cached index does not match the file",
+                     this->lf_filename_as_string.c_str());
+            return false;
+        }
+    }
+
+    // Check that the end of the file has not been rewritten.
+    auto tail_range = file_range{
+        lines.back().get_offset(),
+        index_size - lines.back().get_offset(),
+    };
+    auto tail_res = this->lf_line_buffer.read_range(tail_range);
+    if (tail_res.isErr()) {
+        return false;
+    }
+    auto tail_sbr = tail_res.unwrap();
+    auto curr_tail_hash
+        = hasher().update(tail_sbr.get_data(), tail_sbr.length()).to_string();
+    if (tail_hash != curr_tail_hash) {
+        log_info("%s: cached index is out-of-date",
+                 this->lf_filename_as_string.c_str());
+        return false;
+    }
+
+    pattern_locks locks;
+    uint64_t count = 0;
+    if (!icr.read_count(count, sizeof(uint32_t) * 2)) {
+        return false;
+    }
+    for (uint64_t lpc = 0; lpc < count; lpc++) {
+        uint32_t line_number;
+        uint32_t pat_index;
+
+        icr.read(line_number);
+        icr.read(pat_index);
+        locks.pl_lines.emplace_back(line_number, pat_index);
+    }
+
+    std::vector<logline_value_stats> value_stats;
+    if (!icr.read_count(count, sizeof(int64_t) * 6)) {
+        return false;
+    }
+    value_stats.resize(count);
+    for (auto& lvs : value_stats) {
+        uint64_t centroid_count = 0;
+
+        if (!icr.read(lvs.lvs_width) || !icr.read(lvs.lvs_count)
+            || !icr.read(lvs.lvs_total) || !icr.read(lvs.lvs_min_value)
+            || !icr.read(lvs.lvs_max_value)
+            || !icr.read_count(centroid_count, sizeof(double)))
+        {
+            return false;
+        }
+        for (uint64_t lpc = 0; lpc < centroid_count; lpc++) {
+            double mean;
+            unsigned weight;
+
+            if (!icr.read(mean) || !icr.read(weight)) {
+                return false;
+            }
+            lvs.lvs_tdigest.insert(mean, weight);
+        }
+        lvs.lvs_tdigest.merge();
+    }
+
+    /*
+     * The opids and thread IDs are loaded into a temporary allocator
+     * first since the index might still turn out to be invalid.
+     */
+    log_opid_state opids;
+    if (!icr.read_count(count, sizeof(uint32_t))) {
+        return false;
+    }
+    for (uint64_t lpc = 0; lpc < count; lpc++) {
+        string_fragment opid;
+        opid_time_range otr;
+        uint8_t has_index = 0;
+        uint64_t desc_index = 0;
+        uint64_t elem_count = 0;
+        uint64_t sub_count = 0;
+
+        if (!icr.read(opid) || !icr.read(otr.otr_range)
+            || !icr.read(otr.otr_level_stats) || !icr.read(has_index)
+            || !icr.read(desc_index)
+            || !icr.read_count(elem_count, sizeof(uint64_t)))
+        {
+            return false;
+        }
+        if (has_index) {
+            otr.otr_description.lod_index = desc_index;
+        }
+        for (uint64_t elem_index = 0; elem_index < elem_count; elem_index++) {
+            uint64_t key;
+            std::string value;
+
+            if (!icr.read(key) || !icr.read(value)) {
+                return false;
+            }
+            otr.otr_description.lod_elements.insert(key, std::move(value));
+        }
+        if (!icr.read_count(sub_count, sizeof(uint32_t))) {
+            return false;
+        }
+        for (uint64_t sub_index = 0; sub_index < sub_count; sub_index++) {
+            opid_sub_time_range ostr;
+            uint8_t open = 0;
+
+            if (!icr.read(ostr.ostr_subid) || !icr.read(ostr.ostr_range)
+                || !icr.read(open) || !icr.read(ostr.ostr_level_stats)
+                || !icr.read(ostr.ostr_description))
+            {
+                return false;
+            }
+            ostr.ostr_open = open;
+            otr.otr_sub_ops.emplace_back(std::move(ostr));
+        }
+        opids.los_opid_ranges.emplace(opid, std::move(otr));
+    }
+
+    log_thread_id_state tids;
+    if (!icr.read_count(count, sizeof(uint32_t))) {
+        return false;
+    }
+    for (uint64_t lpc = 0; lpc < count; lpc++) {
+        string_fragment tid;
+        thread_id_time_range titr;
+
+        if (!icr.read(tid) || !icr.read(titr.titr_range)
+            || !icr.read(titr.titr_level_stats))
+        {
+            return false;
+        }
+        tids.ltis_tid_ranges.emplace(tid, titr);
+    }
+
+    log_line_postings postings;
+    if (!read_postings(icr, postings.llp_opids)
+        || !read_postings(icr, postings.llp_tids))
+    {
+        return false;
+    }
+
+    invalid_line_info ili;
+    if (!icr.read(ili.ili_total) || !icr.read_count(count, sizeof(size_t))) {
+        return false;
+    }
+    for (uint64_t lpc = 0; lpc < count; lpc++) {
+        size_t line_number;
+
+        icr.read(line_number);
+        ili.ili_lines.emplace_back(line_number);
+    }
+
+    if (!icr.icr_remaining.empty()) {
+        log_warning("%s: index cache has trailing data",
+                    this->lf_filename_as_string.c_str());
+        return false;
+    }
+
+    // Everything checks out, swap in the cached state.
+    {
+        auto writable_opids = this->lf_opids.writeAccess();
+
+        writable_opids->clear();
+        for (auto& [opid, otr] : opids.los_opid_ranges) {
+            for (auto& ostr : otr.otr_sub_ops) {
+                ostr.ostr_subid = ostr.ostr_subid.to_owned(this->lf_allocator);
+            }
+            writable_opids->los_opid_ranges.emplace(
+                opid.to_owned(this->lf_allocator), std::move(otr));
+        }
+    }
+    {
+        auto writable_tids = this->lf_thread_ids.writeAccess();
+
+        writable_tids->clear();
+        for (const auto& [tid, titr] : tids.ltis_tid_ranges) {
+            writable_tids->ltis_tid_ranges.emplace(
+                tid.to_owned(this->lf_allocator), titr);
+        }
+    }
+    {
+        auto writable_postings = this->lf_line_postings.writeAccess();
+
+        writable_postings->clear();
+        for (auto& [opid, opid_lines] : postings.llp_opids) {
+            writable_postings->llp_opids.emplace(
+                opid.to_owned(this->lf_allocator), std::move(opid_lines));
+        }
+        for (auto& [tid, tid_lines] : postings.llp_tids) {
+            writable_postings->llp_tids.emplace(
+                tid.to_owned(this->lf_allocator), std::move(tid_lines));
+        }
+    }
+    this->lf_index = std::move(lines);
+    this->lf_level_stats = {};
+    for (auto& ll : this->lf_index) {
+        // Marks are user state that is restored from the session.
+        ll.set_mark(false);
+        ll.set_meta_mark(false);
+        ll.set_expr_mark(false);
+        if (ll.get_sub_offset() == 0 && !ll.is_continued()) {
+            this->lf_level_stats.update_msg_count(ll.get_msg_level());
+        }
+    }
+    this->lf_pattern_locks = std::move(locks);
+    this->lf_value_stats = std::move(value_stats);
+    this->lf_value_rollups.clear();
+    this->lf_invalid_lines = std::move(ili);
+    this->lf_longest_line = std::max(this->lf_longest_line, longest_line);
+    this->lf_input_lines = this->lf_index.size();
+    this->lf_index_size = index_size;
+    this->lf_index_cache_size = index_size;
+    this->lf_partial_line = false;
+
+    // Caches are cleaned up when they have not been modified in a while,
+    // so bump the time since this one is still in use.
+    std::error_code ec;
+    std::filesystem::last_write_time(
+        path_opt.value(), std::filesystem::file_time_type::clock::now(), ec);
+
+    log_info("%s: loaded %zu lines from index cache -- %s",
+             this->lf_filename_as_string.c_str(),
+             this->lf_index.size(),
+             path_opt->c_str());
+
+    return true;
+}
+
+void
+logfile::save_index_cache()
+{
+    if (this->lf_index.empty() || this->lf_partial_line
+        || this->lf_line_buffer.is_compressed()
+        || this->lf_line_buffer.is_piper() || this->is_time_adjusted()
+        || this->lf_options.loo_time_range.has_bounds()
+        || this->lf_options.loo_min_level != LEVEL_UNKNOWN
+        || !this->lf_applicable_taggers.empty()
+        || !this->lf_applicable_partitioners.empty()
+        || this->lf_index_size != this->get_content_size())
+    {
+        return;
+    }
+
+    /*
+     * Only write out the cache when a decent chunk of new content has been
+     * indexed so a file that is being tailed is not rewritten constantly.
+     */
+    auto min_growth = std::max(INDEX_CACHE_MIN_SIZE,
+                               (file_ssize_t) this->lf_index_cache_size / 4);
+    if (this->lf_index_size - this->lf_index_cache_size < min_growth) {
+        return;
+    }
+
+    auto path_opt = this->index_cache_path();
+    if (!path_opt) {
+        return;
+    }
+
+    const auto& last_line = this->lf_index.back();
+    auto tail_range = file_range{
+        last_line.get_offset(),
+        this->lf_index_size - last_line.get_offset(),
+    };
+    auto tail_res = this->lf_line_buffer.read_range(tail_range);
+    if (tail_res.isErr()) {
+        return;
+    }
+    auto tail_sbr = tail_res.unwrap();
+
+    index_cache_writer icw;
+    icw.icw_buffer.reserve(this->lf_index.size() * sizeof(logline) + 4096);
+    icw.write(INDEX_CACHE_MAGIC);
+    icw.write(INDEX_CACHE_VERSION);
+    icw.write(this->lf_index_size);
+    icw.write(static_cast<uint64_t>(this->lf_longest_line));
+    icw.write(
+        hasher().update(tail_sbr.get_data(), tail_sbr.length()).to_string());
+    icw.write(static_cast<uint64_t>(this->lf_index.size()));
+    icw.icw_buffer.append((const char*) this->lf_index.data(),
+                          this->lf_index.size() * sizeof(logline));
+
+    icw.write(static_cast<uint64_t>(this->lf_pattern_locks.pl_lines.size()));
+    for (const auto& pfl : this->lf_pattern_locks.pl_lines) {
+        icw.write(pfl.pfl_line);
+        icw.write(static_cast<uint32_t>(pfl.pfl_pat_index));
+    }
+
+    icw.write(static_cast<uint64_t>(this->lf_value_stats.size()));
+    for (const auto& lvs : this->lf_value_stats) {
+        auto centroids = lvs.lvs_tdigest.get();
+
+        icw.write(lvs.lvs_width);
+        icw.write(lvs.lvs_count);
+        icw.write(lvs.lvs_total);
+        icw.write(lvs.lvs_min_value);
+        icw.write(lvs.lvs_max_value);
+        icw.write(static_cast<uint64_t>(centroids.size()));
+        for (const auto& [mean, weight] : centroids) {
+            icw.write(mean);
+            icw.write(weight);
+        }
+    }
+
+    {
+        auto opids = this->lf_opids.readAccess();
+
+        icw.write(static_cast<uint64_t>(opids->los_opid_ranges.size()));
+        for (const auto& [opid, otr] : opids->los_opid_ranges) {
+            const auto& desc = otr.otr_description;
+
+            icw.write(opid);
+            icw.write(otr.otr_range);
+            icw.write(otr.otr_level_stats);
+            icw.write(static_cast<uint8_t>(desc.lod_index.has_value()));
+            icw.write(static_cast<uint64_t>(desc.lod_index.value_or(0)));
+            icw.write(static_cast<uint64_t>(desc.lod_elements.size()));
+            for (const auto& elem : desc.lod_elements) {
+                icw.write(static_cast<uint64_t>(elem.first));
+                icw.write(elem.second);
+            }
+            icw.write(static_cast<uint64_t>(otr.otr_sub_ops.size()));
+            for (const auto& ostr : otr.otr_sub_ops) {
+                icw.write(ostr.ostr_subid);
+                icw.write(ostr.ostr_range);
+                icw.write(static_cast<uint8_t>(ostr.ostr_open));
+                icw.write(ostr.ostr_level_stats);
+                icw.write(ostr.ostr_description);
+            }
+        }
+    }
+    {
+        auto tids = this->lf_thread_ids.readAccess();
+
+        icw.write(static_cast<uint64_t>(tids->ltis_tid_ranges.size()));
+        for (const auto& [tid, titr] : tids->ltis_tid_ranges) {
+            icw.write(tid);
+            icw.write(titr.titr_range);
+            icw.write(titr.titr_level_stats);
+        }
+    }
+
+    {
+        auto postings = this->lf_line_postings.readAccess();
+
+        write_postings(icw, postings->llp_opids);
+        write_postings(icw, postings->llp_tids);
+    }
+
+    icw.write(this->lf_invalid_lines.ili_total);
+    icw.write(static_cast<uint64_t>(this->lf_invalid_lines.ili_lines.size()));
+    for (const auto line_number : this->lf_invalid_lines.ili_lines) {
+        icw.write(line_number);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path_opt->parent_path(), ec);
+    if (ec) {
+        log_error("unable to create index cache directory: %s -- %s",
+                  path_opt->parent_path().c_str(),
+                  ec.message().c_str());
+        return;
+    }
+
+    auto write_res = lnav::filesystem::write_file(
+        path_opt.value(), string_fragment::from_str(icw.icw_buffer));
+    if (write_res.isErr()) {
+        log_error("%s: unable to write index cache -- %s",
+                  this->lf_filename_as_string.c_str(),
+                  write_res.unwrapErr().c_str());
+        return;
+    }
+
+    log_info("%s: saved %zu lines to index cache -- %s",
+             this->lf_filename_as_string.c_str(),
+             this->lf_index.size(),
+             path_opt->c_str());
+    this->lf_index_cache_size = this->lf_index_size;
+}
+
+std::future<void>
+logfile::cleanup_index_cache()
+{
+    return std::async(
+        std::launch::async, +[]() {
+            auto now = std::filesystem::file_time_type::clock::now();
+            auto cache_path = index_cache_dir();
+            std::vector<std::filesystem::path> to_remove;
+            std::error_code ec;
+
+            for (const auto& cache_subdir :
+                 std::filesystem::directory_iterator(cache_path, ec))
+            {
+                for (const auto& entry :
+                     std::filesystem::directory_iterator(cache_subdir, ec))
+                {
+                    auto mtime = std::filesystem::last_write_time(
+                        entry.path(), ec);
+                    if (ec || now < mtime + std::chrono::hours(48)) {
+                        continue;
+                    }
+
+                    to_remove.emplace_back(entry.path());
+                }
+            }
+
+            for (auto& entry : to_remove) {
+                log_debug("removing index cache: %s", entry.c_str());
+                std::filesystem::remove(entry, ec);
+            }
+        });
+}
+
 logfile::map_entry_result
 logfile::find_content_map_entry(file_off_t offset, map_read_requirement req)
 {
@@ -749,9 +1447,12 @@ logfile::build_content_map()
             auto tids = this->lf_thread_ids.writeAccess();
             tids->ltis_tid_ranges.clear();
         }
+        this->lf_line_postings.writeAccess()->clear();
         this->lf_pattern_locks.pl_lines.clear();
         this->lf_value_stats.clear();
+        this->lf_value_rollups.clear();
         this->lf_index.clear();
+        this->lf_skipping_message = false;
         this->lf_upper_bound_size = std::nullopt;
     }
 
@@ -768,6 +1469,14 @@ logfile::in_range() const
     return !this->lf_index.empty() || this->lf_lower_bound_entry.has_value();
 }
 
+bool
+logfile::is_detecting_format() const
+{
+    return this->lf_options.loo_detect_format
+        && (this->lf_format == nullptr
+            || this->lf_index.size() < RETRY_MATCH_SIZE);
+}
+
 bool
 logfile::exists() const
 {
@@ -779,6 +1488,12 @@ logfile::exists() const
         return true;
     }
 
+    if (this->lf_event_driven
+        && !std::exchange(this->lf_exists_check_pending, false))
+    {
+        return true;
+    }
+
     auto stat_res = lnav::filesystem::stat_file(this->lf_actual_path.value());
     if (stat_res.isErr()) {
         log_error("%s: stat failed -- %s",
@@ -838,6 +1553,58 @@ logfile::get_content_time_range() const
     };
 }
 
+void
+logfile::log_format_detect_costs()
+{
+    static constexpr size_t MAX_REPORTED_FORMATS = 10;
+
+    std::vector<const format_detect_cost*> costs;
+    size_t total_scans = 0;
+    size_t total_skipped = 0;
+    auto total_duration = std::chrono::steady_clock::duration{0};
+
+    for (const auto& cost : this->lf_format_detect_costs) {
+        if (cost.fdc_scans == 0 && cost.fdc_skipped == 0) {
+            continue;
+        }
+        costs.emplace_back(&cost);
+        total_scans += cost.fdc_scans;
+        total_skipped += cost.fdc_skipped;
+        total_duration += cost.fdc_duration;
+    }
+    if (costs.empty()) {
+        return;
+    }
+
+    std::sort(costs.begin(), costs.end(), [](const auto* lhs, const auto* rhs) {
+        return lhs->fdc_duration > rhs->fdc_duration;
+    });
+    log_debug("%s: format detection scans=%zu; skipped=%zu; time=%lldus",
+              this->lf_filename_as_string.c_str(),
+              total_scans,
+              total_skipped,
+              std::chrono::duration_cast<std::chrono::microseconds>(
+                  total_duration)
+                  .count());
+    for (size_t lpc = 0; lpc < costs.size() && lpc < MAX_REPORTED_FORMATS;
+         lpc++)
+    {
+        const auto* cost = costs[lpc];
+
+        log_debug("  %s: scans=%zu; skipped=%zu; time=%lldus",
+                  cost->fdc_name.get(),
+                  cost->fdc_scans,
+                  cost->fdc_skipped,
+                  std::chrono::duration_cast<std::chrono::microseconds>(
+                      cost->fdc_duration)
+                      .count());
+    }
+
+    for (auto& cost : this->lf_format_detect_costs) {
+        cost = format_detect_cost{};
+    }
+}
+
 bool
 logfile::process_prefix(shared_buffer_ref& sbr,
                         const line_info& li,
@@ -849,6 +1616,9 @@ logfile::process_prefix(shared_buffer_ref& sbr,
 
     log_format::scan_result_t found = log_format::scan_no_match{};
     size_t prescan_size = this->lf_index.size();
+
+    sbc.sbc_opids.los_last_opid = string_fragment{};
+    sbc.sbc_tids.ltis_last_tid = string_fragment{};
     auto prescan_time = std::chrono::microseconds{0};
     bool retval = false;
 
@@ -887,7 +1657,15 @@ logfile::process_prefix(shared_buffer_ref& sbr,
             line_locks,
         };
         sbc_tmp.sbc_value_stats.reserve(64);
+        if (this->lf_format_detect_costs.size() != root_formats.size()) {
+            this->lf_format_detect_costs.clear();
+            this->lf_format_detect_costs.resize(root_formats.size());
+        }
+        const auto line_sf = sbr.to_string_fragment();
+        size_t format_index = 0;
         for (const auto& curr : root_formats) {
+            auto& detect_cost = this->lf_format_detect_costs[format_index++];
+
             if (this->lf_input_lines
                     >= curr->lf_max_unrecognized_lines.value_or(
                         max_unrecognized_lines)
@@ -945,23 +1723,36 @@ logfile::process_prefix(shared_buffer_ref& sbr,
             }
 
             scan_count += 1;
+            detect_cost.fdc_name = curr->get_name();
+            const auto is_current_format = this->lf_format != nullptr
+                && this->lf_format->lf_root_format == curr.get();
+            if (!is_current_format && !curr->might_match_line(line_sf)) {
+                // None of the format's patterns can match, so skip the
+                // setup and scan.
+                detect_cost.fdc_skipped += 1;
+                continue;
+            }
+
+            const auto scan_start = std::chrono::steady_clock::now();
             curr->clear();
             this->set_format_base_time(curr.get(), li);
             log_format::scan_result_t scan_res{mapbox::util::no_init{}};
-            if (this->lf_format != nullptr
-                && this->lf_format->lf_root_format == curr.get())
-            {
+            if (is_current_format) {
                 scan_res = this->lf_format->scan(
                     *this, this->lf_index, li, sbr, sbc);
             } else {
                 sbc_tmp.sbc_pattern_locks.pl_lines.clear();
                 sbc_tmp.sbc_value_stats.clear();
+                sbc_tmp.sbc_line_values.clear();
                 sbc_tmp.sbc_opids.los_opid_ranges.clear();
                 sbc_tmp.sbc_opids.los_sub_in_use.clear();
                 sbc_tmp.sbc_tids.ltis_tid_ranges.clear();
                 sbc_tmp.sbc_level_cache = {};
                 scan_res = curr->scan(*this, this->lf_index, li, sbr, sbc_tmp);
             }
+            detect_cost.fdc_scans += 1;
+            detect_cost.fdc_duration
+                += std::chrono::steady_clock::now() - scan_start;
 
             scan_res.match(
                 [this,
@@ -1008,7 +1799,9 @@ logfile::process_prefix(shared_buffer_ref& sbr,
 
                         sbc.sbc_opids = sbc_tmp.sbc_opids;
                         sbc.sbc_tids = sbc_tmp.sbc_tids;
+                        sbc.sbc_postings.clear();
                         sbc.sbc_value_stats = sbc_tmp.sbc_value_stats;
+                        sbc.sbc_line_values = sbc_tmp.sbc_line_values;
                         sbc.sbc_pattern_locks = sbc_tmp.sbc_pattern_locks;
                         auto match_um
                             = lnav::console::user_message::info(
@@ -1124,6 +1917,7 @@ logfile::process_prefix(shared_buffer_ref& sbr,
             this->lf_format_match_messages.emplace_back(match_um);
             this->lf_text_format = text_format_t::TF_LOG;
             this->lf_format = curr->specialized();
+            this->lf_column_cache.clear();
             this->lf_level_stats = {};
             for (const auto& ll : this->lf_index) {
                 if (ll.is_continued()) {
@@ -1219,7 +2013,16 @@ logfile::process_prefix(shared_buffer_ref& sbr,
         found = this->lf_format->scan(*this, this->lf_index, li, sbr, sbc);
     }
 
-    if (found.is<log_format::scan_match>()) {
+    if (found.is<log_format::scan_match>()
+        && this->skip_below_min_level(prescan_size))
+    {
+        // Nothing else to record for a message that was skipped.
+    } else if (found.is<log_format::scan_match>()) {
+        if (this->lf_index.size() > prescan_size) {
+            sbc.sbc_postings.add_line(prescan_size,
+                                      sbc.sbc_opids.los_last_opid,
+                                      sbc.sbc_tids.ltis_last_tid);
+        }
         if (!this->lf_index.empty()) {
             auto& last_line = this->lf_index.back();
 
@@ -1273,6 +2076,21 @@ logfile::process_prefix(shared_buffer_ref& sbr,
                 }
             }
         }
+        if (this->lf_index.size() > prescan_size) {
+            const auto msg_time = this->lf_index[prescan_size]
+                                      .get_time<std::chrono::microseconds>();
+            for (const auto& [index, value] : sbc.sbc_line_values) {
+                if (index >= this->lf_value_rollups.size()) {
+                    this->lf_value_rollups.resize(index + 1);
+                }
+                this->lf_value_rollups[index].add_value(msg_time, value);
+            }
+        }
+    } else if (found.is<log_format::scan_no_match>()
+               && this->lf_skipping_message)
+    {
+        // The line is a continuation of a skipped message, the placeholder
+        // for that message covers it.
     } else if (found.is<log_format::scan_no_match>()) {
         log_level_t last_level = LEVEL_UNKNOWN;
         auto last_time = this->lf_index_time;
@@ -1303,6 +2121,7 @@ logfile::process_prefix(shared_buffer_ref& sbr,
         new_line.set_valid_utf(li.li_utf8_scan_result.is_valid());
         new_line.set_has_ansi(li.li_utf8_scan_result.usr_has_ansi);
     }
+    sbc.sbc_line_values.clear();
 
     if (this->lf_format != nullptr && !this->lf_index.empty()
         && this->lf_index.back().get_time<std::chrono::microseconds>()
@@ -1321,6 +2140,30 @@ logfile::process_prefix(shared_buffer_ref& sbr,
     return retval;
 }
 
+bool
+logfile::skip_below_min_level(size_t prescan_size)
+{
+    if (this->lf_options.loo_min_level == LEVEL_UNKNOWN
+        || this->lf_format == nullptr || this->lf_index.size() <= prescan_size
+        || this->lf_index[prescan_size].get_msg_level()
+            >= this->lf_options.loo_min_level)
+    {
+        this->lf_skipping_message = false;
+        return false;
+    }
+
+    // A placeholder is kept for the message since the length of the
+    // previous message is computed from the offset of the next line in
+    // the index.
+    while (this->lf_index.size() > prescan_size + 1) {
+        this->lf_index.pop_back();
+    }
+    this->lf_index.back().set_ignore(true);
+    this->lf_skipping_message = true;
+
+    return true;
+}
+
 logfile::rebuild_result_t
 logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
 {
@@ -1387,6 +2230,13 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
     auto retval = rebuild_result_t::NO_NEW_LINES;
     struct stat st;
 
+    if (this->lf_event_driven && this->lf_index_caught_up
+        && !this->lf_sort_needed
+        && !std::exchange(this->lf_change_pending, false))
+    {
+        return rebuild_result_t::NO_NEW_LINES;
+    }
+
     this->lf_activity.la_polls += 1;
 
     if (fstat(this->lf_line_buffer.get_fd(), &st) == -1) {
@@ -1461,6 +2311,7 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
 
         // We haven't reached the end of the file.  Note that we use the
         // line buffer's notion of the file size since it may be compressed.
+        this->lf_index_caught_up = false;
         bool has_format = this->lf_format.get() != nullptr;
         struct rusage begin_rusage;
         file_off_t off;
@@ -1472,6 +2323,7 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
         if (record_rusage) {
             getrusage(RUSAGE_SELF, &begin_rusage);
         }
+        const auto index_start_time = std::chrono::steady_clock::now();
 
         if (begin_size == 0 && !has_format) {
             log_debug("scanning file... fd(%d) %s",
@@ -1494,6 +2346,21 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
             rollback_index_start = this->lf_index.size();
             rollback_size += 1;
 
+            {
+                // The last message can pick up more continuation lines, so
+                // its cached values are no longer valid.
+                auto msg_start = rollback_index_start;
+                while (msg_start > 0
+                       && this->lf_index[msg_start - 1].is_continued())
+                {
+                    msg_start -= 1;
+                }
+                if (msg_start > 0) {
+                    msg_start -= 1;
+                }
+                this->lf_column_cache.invalidate_from(msg_start);
+            }
+
             if (!this->lf_index.empty()) {
                 auto last_line = std::prev(this->lf_index.end());
                 if (last_line != this->lf_index.begin()) {
@@ -1564,7 +2431,7 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
                     limit = 100;
                 }
             } else if (this->lf_options.loo_detect_format
-                       && (!has_format
+                       && (!has_format || this->is_detecting_format()
                            || (this->lf_options.loo_time_range.has_bounds()
                                && this->lf_file_size_at_map_time == 0)))
             {
@@ -1800,7 +2667,9 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
                 break;
             }
 #endif
-            if (this->lf_format && li.li_utf8_scan_result.is_valid()) {
+            if (this->lf_format && li.li_utf8_scan_result.is_valid()
+                && !this->lf_skipping_message)
+            {
                 auto sf = sbr.to_string_fragment();
 
                 for (const auto& td : this->lf_applicable_taggers) {
@@ -1926,6 +2795,16 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
                        this->lf_activity.la_initial_index_rusage);
         }
 
+        this->lf_activity.la_index_time
+            += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - index_start_time);
+        this->lf_activity.la_indexed_bytes
+            += prev_range.next_offset() - begin_index_size;
+        if (this->lf_index.size() > begin_size) {
+            this->lf_activity.la_indexed_lines
+                += this->lf_index.size() - begin_size;
+        }
+
         /*
          * The file can still grow between the above fstat and when we're
          * doing the scanning, so use the line buffer's notion of the file
@@ -1976,6 +2855,32 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
                       sizeof(opid_time_range),
                       this->lf_allocator.getNumBytesAllocated());
         }
+        {
+            auto postings = this->lf_line_postings.writeAccess();
+
+            postings->merge(sbc.sbc_postings);
+            log_debug("%s: postings size: opids=%zu; tids=%zu; bytes=%zu",
+                      this->lf_filename_as_string.c_str(),
+                      postings->llp_opids.size(),
+                      postings->llp_tids.size(),
+                      postings->memory_size());
+        }
+        this->log_format_detect_costs();
+
+        if (!has_format && this->lf_format != nullptr) {
+            auto size_before_load = this->lf_index.size();
+
+            if (this->load_index_cache(st)) {
+                sort_needed = true;
+                // The observer has already seen EOF for the lines that were
+                // scanned, so it needs to be told about the restored lines.
+                if (this->lf_logline_observer != nullptr
+                    && size_before_load < this->lf_index.size())
+                {
+                    this->reobserve_from(this->begin() + size_before_load);
+                }
+            }
+        }
 
         if (begin_size > this->lf_index.size()) {
             log_info("overwritten file detected, closing -- %s",
@@ -2021,8 +2926,11 @@ logfile::rebuild_index(std::optional<ui_clock::time_point> deadline)
                 log_debug("stats[] p25=%f p50=%f p75=%f", p25, p50, p75);
             }
         }
+
+        this->save_index_cache();
     } else {
         this->lf_stat = st;
+        this->lf_index_caught_up = true;
         if (this->lf_sort_needed) {
             retval = rebuild_result_t::NEW_ORDER;
             this->lf_sort_needed = false;
@@ -2230,6 +3138,19 @@ logfile::set_logline_observer(logline_observer* llo)
 void
 logfile::reobserve_from(iterator iter)
 {
+    if (iter != this->end()
+        && !this->lf_logline_observer->logline_needs_content(*this))
+    {
+        this->lf_logline_observer->logline_new_lines(
+            *this, iter, this->end(), shared_buffer_ref{});
+        iter = this->end();
+    }
+    static constexpr size_t REOBSERVE_BATCH_SIZE = 16 * 1024;
+
+    std::vector<logline_observer::message_content> batch;
+    size_t msg_count = 0;
+    batch.reserve(std::min(REOBSERVE_BATCH_SIZE,
+                           (size_t) std::distance(iter, this->end())));
     for (; iter != this->end(); ++iter) {
         off_t offset = std::distance(this->begin(), iter);
 
@@ -2237,7 +3158,8 @@ logfile::reobserve_from(iterator iter)
             continue;
         }
 
-        if (this->lf_logfile_observer != nullptr) {
+        msg_count += 1;
+        if (this->lf_logfile_observer != nullptr && (msg_count % 1024) == 1) {
             auto indexing_res = this->lf_logfile_observer->logfile_indexing(
                 this, offset, this->size());
             if (indexing_res == lnav::progress_result_t::interrupt) {
@@ -2245,15 +3167,25 @@ logfile::reobserve_from(iterator iter)
             }
         }
 
-        this->read_line(iter).then([this, iter](auto sbr) {
+        this->read_line(iter).then([this, iter, &batch](auto sbr) {
             auto iter_end = iter + 1;
 
             while (iter_end != this->end() && iter_end->get_sub_offset() != 0) {
                 ++iter_end;
             }
-            this->lf_logline_observer->logline_new_lines(
-                *this, iter, iter_end, sbr);
+            // Detach from the line buffer since it will be reused for the
+            // following reads.
+            sbr.take_ownership();
+            batch.emplace_back(logline_observer::message_content{
+                iter, iter_end, std::move(sbr)});
         });
+        if (batch.size() >= REOBSERVE_BATCH_SIZE) {
+            this->lf_logline_observer->logline_new_messages(*this, batch);
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) {
+        this->lf_logline_observer->logline_new_messages(*this, batch);
     }
     if (this->lf_logfile_observer != nullptr) {
         this->lf_logfile_observer->logfile_indexing(
@@ -2282,6 +3214,31 @@ logfile::stats_for_value(intern_string_t name) const
     return retval;
 }
 
+const lnav::time_rollup*
+logfile::rollup_for_value(intern_string_t name) const
+{
+    if (this->lf_format == nullptr) {
+        return nullptr;
+    }
+
+    auto index_opt = this->lf_format->stats_index_for_value(name);
+    if (!index_opt || index_opt.value() >= this->lf_value_rollups.size()
+        || index_opt.value() >= this->lf_value_stats.size())
+    {
+        return nullptr;
+    }
+
+    const auto& retval = this->lf_value_rollups[index_opt.value()];
+    if (retval.count()
+        != static_cast<uint64_t>(
+            this->lf_value_stats[index_opt.value()].lvs_count))
+    {
+        return nullptr;
+    }
+
+    return &retval;
+}
+
 logfile::message_length_result
 logfile::message_byte_length(logfile::const_iterator ll, bool include_continues)
 {
@@ -2400,6 +3357,7 @@ logfile::adjust_content_time(int line, const timeval& tv, bool abs_offset)
     } else {
         timeradd(&old_time, &tv, &this->lf_time_offset);
     }
+    this->lf_value_rollups.clear();
     for (auto& iter : *this) {
         timeval curr, diff, new_time;
 
@@ -2506,6 +3464,7 @@ logfile::dump_stats()
     if (buf_stats.empty()) {
         return;
     }
+    this->lf_activity.la_buffer_stats += buf_stats;
     log_info("line buffer stats for file: %s",
              this->lf_filename_as_string.c_str());
     log_info("  file_size=%lld", this->lf_line_buffer.get_file_size());
@@ -2624,6 +3583,53 @@ logfile::clear_logline_opid(uint32_t line_number)
     }
 }
 
+static std::vector<uint32_t>
+lines_from_postings(const log_posting_map& postings,
+                    string_fragment key,
+                    size_t line_count)
+{
+    std::vector<uint32_t> retval;
+
+    auto iter = postings.find(key);
+    if (iter == postings.end()) {
+        return retval;
+    }
+
+    retval.reserve(iter->second.size());
+    iter->second.for_each([&retval, line_count](uint32_t line_number) {
+        // Lines that were rolled back can leave stale entries at the end.
+        if (line_number < line_count) {
+            retval.emplace_back(line_number);
+        }
+    });
+
+    return retval;
+}
+
+std::optional<std::vector<uint32_t>>
+logfile::lines_for_opid(string_fragment opid)
+{
+    // Opids set by the user are not in the index.
+    for (const auto& bm_pair : this->lf_bookmark_metadata) {
+        if (!bm_pair.second.bm_opid.empty()) {
+            return std::nullopt;
+        }
+    }
+
+    auto postings = this->lf_line_postings.readAccess();
+
+    return lines_from_postings(
+        postings->llp_opids, opid, this->lf_index.size());
+}
+
+std::optional<std::vector<uint32_t>>
+logfile::lines_for_thread_id(string_fragment tid)
+{
+    auto postings = this->lf_line_postings.readAccess();
+
+    return lines_from_postings(postings->llp_tids, tid, this->lf_index.size());
+}
+
 size_t
 logfile::estimated_remaining_lines() const
 {
@@ -36,6 +36,8 @@ namespace lnav::logfile {
 
 struct config {
     uint64_t lc_max_unrecognized_lines{1000};
+    uint64_t lc_indexing_threads{0};
+    uint64_t lc_column_cache_size{64 * 1024 * 1024};
 };
 
 }  // namespace lnav::logfile
@@ -34,6 +34,7 @@
 
 #include <chrono>
 #include <filesystem>
+#include <future>
 #include <string>
 #include <utility>
 #include <vector>
@@ -51,9 +52,11 @@
 #include "base/map_util.hh"
 #include "base/progress.hh"
 #include "base/result.h"
+#include "base/time_rollup.hh"
 #include "bookmarks.hh"
 #include "file_options.hh"
 #include "line_buffer.hh"
+#include "log.column_cache.hh"
 #include "log_format_fwd.hh"
 #include "logfile_fwd.hh"
 #include "mapbox/variant.hpp"
@@ -85,6 +88,13 @@ struct logfile_activity {
     int64_t la_polls{0};
     int64_t la_reads{0};
     struct rusage la_initial_index_rusage{};
+    /** The number of bytes and lines consumed by rebuild_index(). */
+    int64_t la_indexed_bytes{0};
+    int64_t la_indexed_lines{0};
+    /** The time spent by rebuild_index() reading and scanning lines. */
+    std::chrono::microseconds la_index_time{0};
+    /** The line buffer stats that have been consumed by dump_stats(). */
+    line_buffer::stats la_buffer_stats;
 };
 
 /**
@@ -120,8 +130,24 @@ public:
 
     ~logfile() override;
 
+    /**
+     * Remove stale entries from the on-disk index cache.
+     */
+    static std::future<void> cleanup_index_cache();
+
     const logfile_activity& get_activity() const { return this->lf_activity; }
 
+    /**
+     * @return The line buffer stats accumulated since the file was opened.
+     */
+    line_buffer::stats get_buffer_stats() const
+    {
+        auto retval = this->lf_activity.la_buffer_stats;
+
+        retval += this->lf_line_buffer.get_stats();
+        return retval;
+    }
+
     std::optional<std::filesystem::path> get_actual_path() const
     {
         return this->lf_actual_path;
@@ -285,6 +311,28 @@ public:
     /** @return True if this log file still exists. */
     bool exists() const;
 
+    /**
+     * Control whether changes to this file are detected by polling or by
+     * events from the file watcher.  When event-driven, the file is only
+     * stat()'d after notify_changed() is called or when the index has not
+     * caught up with the end of the file.
+     */
+    void set_event_driven(bool enabled)
+    {
+        this->lf_event_driven = enabled;
+        this->lf_change_pending = true;
+        this->lf_exists_check_pending = true;
+    }
+
+    bool is_event_driven() const { return this->lf_event_driven; }
+
+    /** Called when the file watcher reports an event for this file. */
+    void notify_changed()
+    {
+        this->lf_change_pending = true;
+        this->lf_exists_check_pending = true;
+    }
+
     void close() { this->lf_is_closed = true; }
 
     bool is_closed() const { return this->lf_is_closed; }
@@ -391,6 +439,11 @@ public:
         this->lf_logfile_observer = lo;
     }
 
+    logfile_observer* get_logfile_observer() const
+    {
+        return this->lf_logfile_observer;
+    }
+
     void set_logline_observer(logline_observer* llo);
 
     logline_observer* get_logline_observer() const
@@ -415,6 +468,13 @@ public:
 
     bool is_indexing() const { return this->lf_indexing; }
 
+    /**
+     * @return True if new lines are still being checked against all of the
+     * root formats.  The root formats are shared between files, so indexing
+     * must be done on the main thread while this is true.
+     */
+    bool is_detecting_format() const;
+
     void set_indexing(bool val) { this->lf_indexing = val; }
 
     /** Check the invariants for this object. */
@@ -445,6 +505,18 @@ public:
 
     const logline_value_stats* stats_for_value(intern_string_t name) const;
 
+    /**
+     * @return The time-bucketed rollup of the given value or nullptr if
+     * the value is unknown or the rollup does not cover every message
+     * that was counted in the value's stats.
+     */
+    const lnav::time_rollup* rollup_for_value(intern_string_t name) const;
+
+    lnav::log::column_cache& get_column_cache()
+    {
+        return this->lf_column_cache;
+    }
+
     log_format_file_state get_format_file_state() const
     {
         return {
@@ -467,6 +539,24 @@ public:
 
     void clear_logline_opid(uint32_t line_number);
 
+    /**
+     * Find the messages with the given opid using the index that is built
+     * up while the file is scanned.
+     *
+     * @param opid The opid to look for.
+     * @return The line numbers of the messages in increasing order or
+     *   nullopt if the index cannot answer, like when the user has set
+     *   the opid for some messages.
+     */
+    std::optional<std::vector<uint32_t>> lines_for_opid(string_fragment opid);
+
+    /**
+     * Find the messages with the given thread ID using the index that is
+     * built up while the file is scanned.
+     */
+    std::optional<std::vector<uint32_t>> lines_for_thread_id(
+        string_fragment tid);
+
     void quiesce() { this->lf_line_buffer.quiesce(); }
 
     void enable_cache() { this->lf_line_buffer.enable_cache(); }
@@ -545,6 +635,16 @@ protected:
                         const line_info& li,
                         scan_batch_context& sbc);
 
+    /**
+     * Check if the message that was just scanned is below the minimum
+     * level in the open options.  If it is, the message is reduced to a
+     * single ignored line that marks where it starts in the file.
+     *
+     * @param prescan_size The size of the index before the scan.
+     * @return True if the message should not be indexed.
+     */
+    bool skip_below_min_level(size_t prescan_size);
+
     void set_format_base_time(log_format* lf, const line_info& li);
 
 private:
@@ -554,6 +654,25 @@ private:
 
     void reset_internal_state_for_reindex();
 
+    std::optional<std::filesystem::path> index_cache_path() const;
+
+    /**
+     * Try to replace the index with a copy that was saved by a previous
+     * run.  This should be called right after the format has been detected.
+     *
+     * @param st The current stat() of the file.
+     * @return True if the cached index was loaded.
+     */
+    bool load_index_cache(const struct stat& st);
+
+    void save_index_cache();
+
+    /**
+     * Write the time spent trying each format on the lines in the last
+     * batch to the debug log and then reset the counters.
+     */
+    void log_format_detect_costs();
+
     std::filesystem::path lf_filename;
     std::string lf_filename_as_string;
     logfile_open_options lf_options;
@@ -578,7 +697,17 @@ private:
     bool lf_is_closed{false};
     bool lf_indexing{true};
     bool lf_partial_line{false};
+    bool lf_skipping_message{false};
     bool lf_zoned_to_local_state{true};
+    bool lf_event_driven{false};
+    bool lf_change_pending{true};
+    /**
+     * Separate from lf_change_pending since rebuild_index() and exists()
+     * each need to see the event, whichever of them runs first.
+     */
+    mutable bool lf_exists_check_pending{true};
+    bool lf_index_caught_up{false};
+    file_off_t lf_index_cache_size{0};
     robin_hood::unordered_set<string_fragment,
                               frag_hasher,
                               std::equal_to<string_fragment>>
@@ -590,10 +719,12 @@ private:
     uint32_t lf_out_of_time_order_count{0};
     safe_notes lf_notes;
     std::vector<logline_value_stats> lf_value_stats;
+    std::vector<lnav::time_rollup> lf_value_rollups;
     log_level_stats lf_level_stats;
     pattern_locks lf_pattern_locks;
     safe_opid_state lf_opids;
     safe_thread_id_state lf_thread_ids;
+    safe::Safe<log_line_postings> lf_line_postings;
     size_t lf_watch_count{0};
     ArenaAlloc::Alloc<char> lf_allocator{64 * 1024};
     std::optional<time_t> lf_cached_base_time;
@@ -611,6 +742,16 @@ private:
     size_t lf_file_options_generation{0};
     std::optional<std::pair<std::string, lnav::file_options>> lf_file_options;
     std::vector<lnav::console::user_message> lf_format_match_messages;
+
+    struct format_detect_cost {
+        intern_string_t fdc_name;
+        size_t fdc_scans{0};
+        size_t fdc_skipped{0};
+        std::chrono::steady_clock::duration fdc_duration{0};
+    };
+    /** Indexed by the position of the format in the root formats. */
+    std::vector<format_detect_cost> lf_format_detect_costs;
+    lnav::log::column_cache lf_column_cache;
     invalid_line_info lf_invalid_lines;
     auto_buffer lf_plain_msg_buffer = auto_buffer::alloc(256);
     shared_buffer lf_plain_msg_shared;
@@ -660,6 +801,34 @@ public:
                                    const shared_buffer_ref& sbr) = 0;
 
     virtual void logline_eof(const logfile& lf) = 0;
+
+    struct message_content {
+        logfile::const_iterator mc_begin;
+        logfile::const_iterator mc_end;
+        shared_buffer_ref mc_content;
+    };
+
+    /**
+     * Observe a batch of messages that are being re-observed.  The default
+     * passes each message to logline_new_lines().
+     */
+    virtual void logline_new_messages(const logfile& lf,
+                                      std::vector<message_content>& msgs)
+    {
+        for (auto& msg : msgs) {
+            this->logline_new_lines(
+                lf, msg.mc_begin, msg.mc_end, msg.mc_content);
+        }
+    }
+
+    /**
+     * @return False if logline_new_lines() does not look at the content of
+     * the lines, so the file does not need to be read when re-observing.
+     */
+    virtual bool logline_needs_content(const logfile& lf) const
+    {
+        return true;
+    }
 };
 
 #endif
@@ -41,6 +41,7 @@
 
 #include "base/fs_util.hh"
 #include "base/lnav.console.hh"
+#include "base/log_level_enum.hh"
 #include "base/text_format_enum.hh"
 #include "base/time_util.hh"
 #include "file_format.hh"
@@ -101,6 +102,7 @@ struct logfile_open_options_base {
     file_location_t loo_init_location{default_for_text_format{}};
     std::vector<lnav::console::user_message> loo_match_details;
     time_range loo_time_range{time_range::unbounded()};
+    log_level_t loo_min_level{LEVEL_UNKNOWN};
 };
 
 struct logfile_open_options : logfile_open_options_base {
@@ -216,6 +218,13 @@ struct logfile_open_options : logfile_open_options_base {
 
         return *this;
     }
+
+    logfile_open_options& with_min_level(log_level_t level)
+    {
+        this->loo_min_level = level;
+
+        return *this;
+    }
 };
 
 #endif
@@ -33,6 +33,8 @@
 #include <future>
 #include <optional>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_set>
 #include <vector>
 
@@ -46,6 +48,7 @@
 #include "base/injector.hh"
 #include "base/itertools.hh"
 #include "base/string_util.hh"
+#include "base/worker_pool.hh"
 #include "bookmarks.hh"
 #include "bookmarks.json.hh"
 #include "command_executor.hh"
@@ -55,7 +58,9 @@
 #include "hasher.hh"
 #include "k_merge_tree.h"
 #include "lnav_util.hh"
+#include "log.watch.hh"
 #include "log_accel.hh"
+#include "logfile.cfg.hh"
 #include "logfile_sub_source.cfg.hh"
 #include "logline_window.hh"
 #include "md2attr_line.hh"
@@ -292,40 +297,27 @@ logfile_sub_source::text_value_for_line(textview_curses& tc,
 
     this->lss_in_value_for_line = true;
     this->lss_token_flags = flags;
+    this->lss_token_rendered = this->lookup_rendered_line(line, flags);
     this->lss_token_file_data = this->find_data(line);
     this->lss_token_file = (*this->lss_token_file_data)->get_file();
     this->lss_token_line = this->lss_token_file->begin() + line;
 
-    this->lss_token_al.clear();
-    this->lss_token_values.clear();
+    // The values point into memory owned by the rendering, which is kept
+    // alive by lss_token_rendered, so a shallow copy is enough.
+    const auto& rl = *this->lss_token_rendered;
+    auto& lvv = this->lss_token_values;
+    this->lss_token_al = rl.rl_al;
+    lvv.clear();
+    lvv.lvv_values = rl.rl_values.lvv_values;
+    lvv.lvv_time_value = rl.rl_values.lvv_time_value;
+    lvv.lvv_time_exttm = rl.rl_values.lvv_time_exttm;
+    lvv.lvv_opid_value = rl.rl_values.lvv_opid_value;
+    lvv.lvv_opid_provenance = rl.rl_values.lvv_opid_provenance;
+    lvv.lvv_thread_id_value = rl.rl_values.lvv_thread_id_value;
+    lvv.lvv_src_file_value = rl.rl_values.lvv_src_file_value;
+    lvv.lvv_src_line_value = rl.rl_values.lvv_src_line_value;
+    lvv.lvv_duration_value = rl.rl_values.lvv_duration_value;
     this->lss_share_manager.invalidate_refs();
-    if (flags & RF_FULL) {
-        shared_buffer_ref sbr;
-
-        this->lss_token_file->read_full_message(this->lss_token_line, sbr);
-        this->lss_token_al.al_string = to_string(sbr);
-        if (sbr.get_metadata().m_has_ansi) {
-            scrub_ansi_string(this->lss_token_al.al_string,
-                              &this->lss_token_al.al_attrs);
-            sbr.get_metadata().m_has_ansi = false;
-        }
-    } else {
-        auto sub_opts = subline_options{};
-        sub_opts.scrub_invalid_utf8 = false;
-        this->lss_token_al.al_string
-            = this->lss_token_file->read_line(this->lss_token_line, sub_opts)
-                  .map([](auto sbr) { return to_string(sbr); })
-                  .unwrapOr({});
-        if (this->lss_token_line->has_ansi()) {
-            scrub_ansi_string(this->lss_token_al.al_string,
-                              &this->lss_token_al.al_attrs);
-        }
-    }
-    for (auto& sa : this->lss_token_al.al_attrs) {
-        if (sa.sa_type == &VC_HYPERLINK) {
-            sa.sa_type = &SAT_UNSUPPORTED;
-        }
-    }
     this->lss_token_shifts.clear();
 
     auto format = this->lss_token_file->get_format_ptr();
@@ -335,92 +327,9 @@ logfile_sub_source::text_value_for_line(textview_curses& tc,
     sbr.share(this->lss_share_manager,
               (char*) this->lss_token_al.al_string.c_str(),
               this->lss_token_al.al_string.size());
-    format->annotate(this->lss_token_file.get(),
-                     line,
-                     this->lss_token_al.al_attrs,
-                     this->lss_token_values);
-
-    auto src_file_attr
-        = find_string_attr(this->lss_token_al.al_attrs, &SA_SRC_FILE);
-    if (src_file_attr != this->lss_token_al.al_attrs.end()) {
-        auto lr = src_file_attr->sa_range;
-        lr.lr_end = lr.lr_start + 1;
-        auto break_ta = text_attrs::with_underline();
-        this->lss_token_al.with_attr({lr, VC_STYLE.value(break_ta)})
-            .with_attr({lr,
-                        VC_COMMAND.value(ui_command{
-                            source_location{},
-                            "|lnav-src-loc-handler $mouse_button",
-                        })});
-        if (!this->lss_breakpoints.empty()) {
-            if (this->lss_token_values.lvv_src_line_value) {
-                auto h = hasher();
-                h.update(format->get_name().to_string_fragment());
-                h.update(this->lss_token_values.lvv_src_file_value.value());
-                h.update(this->lss_token_values.lvv_src_line_value.value());
-
-                auto schema = h.to_string();
-                auto& breakpoints = this->lss_breakpoints;
-                auto it = breakpoints.find(schema);
-                if (it != breakpoints.end()) {
-                    lr.lr_end = lr.lr_start;
-                    this->lss_token_al.insert(
-                        lr.lr_start,
-                        it->second.bp_enabled ? ui_icon_t::breakpoint
-                                              : ui_icon_t::disabled_breakpoint);
-                    lr.lr_end += 2;
-                    this->lss_token_al.with_attr(
-                        {lr,
-                         VC_COMMAND.value(ui_command{
-                             source_location{},
-                             "|lnav-breakpoint-handler $mouse_button",
-                         })});
-                    this->lss_token_values.shift_origins_by(lr, 2);
-                }
-            }
-        }
-    }
 
     value_out = this->lss_token_al.al_string;
 
-    for (const auto& hl : format->lf_highlighters) {
-        auto hl_range = line_range{0, -1};
-        auto value_iter = this->lss_token_values.lvv_values.end();
-        if (!hl.h_field.empty()) {
-            value_iter = std::find_if(this->lss_token_values.lvv_values.begin(),
-                                      this->lss_token_values.lvv_values.end(),
-                                      logline_value_name_cmp(&hl.h_field));
-            if (value_iter == this->lss_token_values.lvv_values.end()) {
-                continue;
-            }
-            hl_range = value_iter->lv_origin;
-        }
-        if (hl.annotate(this->lss_token_al, hl_range)
-            && value_iter != this->lss_token_values.lvv_values.end())
-        {
-            value_iter->lv_highlighted = true;
-        }
-    }
-
-    for (const auto& hl : this->lss_highlighters) {
-        auto hl_range = line_range{0, -1};
-        auto value_iter = this->lss_token_values.lvv_values.end();
-        if (!hl.h_field.empty()) {
-            value_iter = std::find_if(this->lss_token_values.lvv_values.begin(),
-                                      this->lss_token_values.lvv_values.end(),
-                                      logline_value_name_cmp(&hl.h_field));
-            if (value_iter == this->lss_token_values.lvv_values.end()) {
-                continue;
-            }
-            hl_range = value_iter->lv_origin;
-        }
-        if (hl.annotate(this->lss_token_al, hl_range)
-            && value_iter != this->lss_token_values.lvv_values.end())
-        {
-            value_iter->lv_highlighted = true;
-        }
-    }
-
     if (flags & RF_REWRITE) {
         exec_context ec(
             &this->lss_token_values, pretty_sql_callback, pretty_pipe_callback);
@@ -616,6 +525,311 @@ logfile_sub_source::text_value_for_line(textview_curses& tc,
     return retval;
 }
 
+std::shared_ptr<const logfile_sub_source::rendered_line>
+logfile_sub_source::render_line(content_line_t line, line_flags_t flags)
+{
+    auto retval = std::make_shared<rendered_line>();
+    auto& al = retval->rl_al;
+    auto& values = retval->rl_values;
+    auto lf = this->find(line);
+    auto ll = lf->begin() + line;
+    shared_buffer share_manager;
+
+    if (flags & RF_FULL) {
+        shared_buffer_ref sbr;
+
+        lf->read_full_message(ll, sbr);
+        al.al_string = to_string(sbr);
+        if (sbr.get_metadata().m_has_ansi) {
+            scrub_ansi_string(al.al_string, &al.al_attrs);
+            sbr.get_metadata().m_has_ansi = false;
+        }
+    } else {
+        auto sub_opts = subline_options{};
+        sub_opts.scrub_invalid_utf8 = false;
+        al.al_string = lf->read_line(ll, sub_opts)
+                           .map([](auto sbr) { return to_string(sbr); })
+                           .unwrapOr({});
+        if (ll->has_ansi()) {
+            scrub_ansi_string(al.al_string, &al.al_attrs);
+        }
+    }
+    for (auto& sa : al.al_attrs) {
+        if (sa.sa_type == &VC_HYPERLINK) {
+            sa.sa_type = &SAT_UNSUPPORTED;
+        }
+    }
+
+    auto format = lf->get_format_ptr();
+
+    auto& sbr = values.lvv_sbr;
+
+    sbr.share(share_manager, (char*) al.al_string.c_str(), al.al_string.size());
+    format->annotate(lf.get(), line, al.al_attrs, values);
+
+    // The values can point into the message or into buffers owned by the
+    // format that are reused for the next message, so copy them into the
+    // allocator that lives with this rendering.
+    for (auto& lv : values.lvv_values) {
+        if (lv.lv_frag.is_valid()) {
+            lv.lv_frag = lv.lv_frag.to_owned(values.lvv_allocator);
+        }
+    }
+    values.lvv_time_value = to_owned(values.lvv_time_value,
+                                     values.lvv_allocator);
+    values.lvv_thread_id_value
+        = to_owned(values.lvv_thread_id_value, values.lvv_allocator);
+    values.lvv_src_file_value
+        = to_owned(values.lvv_src_file_value, values.lvv_allocator);
+    values.lvv_src_line_value
+        = to_owned(values.lvv_src_line_value, values.lvv_allocator);
+    sbr.disown();
+
+    auto src_file_attr = find_string_attr(al.al_attrs, &SA_SRC_FILE);
+    if (src_file_attr != al.al_attrs.end()) {
+        auto lr = src_file_attr->sa_range;
+        lr.lr_end = lr.lr_start + 1;
+        auto break_ta = text_attrs::with_underline();
+        al.with_attr({lr, VC_STYLE.value(break_ta)})
+            .with_attr({lr,
+                        VC_COMMAND.value(ui_command{
+                            source_location{},
+                            "|lnav-src-loc-handler $mouse_button",
+                        })});
+        if (!this->lss_breakpoints.empty()) {
+            if (values.lvv_src_line_value) {
+                auto h = hasher();
+                h.update(format->get_name().to_string_fragment());
+                h.update(values.lvv_src_file_value.value());
+                h.update(values.lvv_src_line_value.value());
+
+                auto schema = h.to_string();
+                auto& breakpoints = this->lss_breakpoints;
+                auto it = breakpoints.find(schema);
+                if (it != breakpoints.end()) {
+                    lr.lr_end = lr.lr_start;
+                    al.insert(lr.lr_start,
+                              it->second.bp_enabled
+                                  ? ui_icon_t::breakpoint
+                                  : ui_icon_t::disabled_breakpoint);
+                    lr.lr_end += 2;
+                    al.with_attr(
+                        {lr,
+                         VC_COMMAND.value(ui_command{
+                             source_location{},
+                             "|lnav-breakpoint-handler $mouse_button",
+                         })});
+                    values.shift_origins_by(lr, 2);
+                }
+            }
+        }
+    }
+
+    for (const auto& hl : format->lf_highlighters) {
+        auto hl_range = line_range{0, -1};
+        auto value_iter = values.lvv_values.end();
+        if (!hl.h_field.empty()) {
+            value_iter = std::find_if(values.lvv_values.begin(),
+                                      values.lvv_values.end(),
+                                      logline_value_name_cmp(&hl.h_field));
+            if (value_iter == values.lvv_values.end()) {
+                continue;
+            }
+            hl_range = value_iter->lv_origin;
+        }
+        if (hl.annotate(al, hl_range) && value_iter != values.lvv_values.end())
+        {
+            value_iter->lv_highlighted = true;
+        }
+    }
+
+    for (const auto& hl : this->lss_highlighters) {
+        auto hl_range = line_range{0, -1};
+        auto value_iter = values.lvv_values.end();
+        if (!hl.h_field.empty()) {
+            value_iter = std::find_if(values.lvv_values.begin(),
+                                      values.lvv_values.end(),
+                                      logline_value_name_cmp(&hl.h_field));
+            if (value_iter == values.lvv_values.end()) {
+                continue;
+            }
+            hl_range = value_iter->lv_origin;
+        }
+        if (hl.annotate(al, hl_range) && value_iter != values.lvv_values.end())
+        {
+            value_iter->lv_highlighted = true;
+        }
+    }
+
+    return retval;
+}
+
+bool
+logfile_sub_source::render_decorations::matches(
+    const std::vector<highlighter>& hls,
+    const std::map<std::string, breakpoint_info>& bps) const
+{
+    if (hls.size() != this->rd_highlighters.size()
+        || bps.size() != this->rd_breakpoints.size())
+    {
+        return false;
+    }
+
+    // The copies hold on to the regexes, so a new highlighter cannot end
+    // up with the same regex address as one that was removed.
+    for (size_t lpc = 0; lpc < hls.size(); lpc++) {
+        const auto& lhs = hls[lpc];
+        const auto& rhs = this->rd_highlighters[lpc];
+
+        if (lhs.h_regex != rhs.h_regex || lhs.h_field != rhs.h_field
+            || lhs.h_role != rhs.h_role || !(lhs.h_attrs == rhs.h_attrs)
+            || lhs.h_capture_attrs != rhs.h_capture_attrs)
+        {
+            return false;
+        }
+    }
+
+    auto bp_iter = this->rd_breakpoints.begin();
+    for (const auto& [schema, bp] : bps) {
+        if (bp_iter->first != schema || bp_iter->second != bp.bp_enabled) {
+            return false;
+        }
+        ++bp_iter;
+    }
+
+    return true;
+}
+
+void
+logfile_sub_source::update_decorations_version()
+{
+    if (this->lss_render_decorations.matches(this->lss_highlighters,
+                                             this->lss_breakpoints))
+    {
+        return;
+    }
+
+    auto& decos = this->lss_render_decorations;
+    decos.rd_highlighters = this->lss_highlighters;
+    decos.rd_breakpoints.clear();
+    for (const auto& [schema, bp] : this->lss_breakpoints) {
+        decos.rd_breakpoints.emplace_back(schema, bp.bp_enabled);
+    }
+    this->lss_decorations_version += 1;
+}
+
+logfile_sub_source::render_cache_key
+logfile_sub_source::render_key_for(content_line_t line,
+                                   line_flags_t flags) const
+{
+    const auto* lf = this->find_file_ptr(line);
+    const auto* format = lf == nullptr ? nullptr : lf->get_format_ptr();
+
+    return render_cache_key{
+        line,
+        flags & RF_FULL,
+        this->lss_render_generation,
+        format == nullptr ? 0 : format->get_display_generation(),
+        this->lss_decorations_version,
+    };
+}
+
+std::shared_ptr<const logfile_sub_source::rendered_line>
+logfile_sub_source::lookup_rendered_line(content_line_t line,
+                                         line_flags_t flags)
+{
+    this->update_decorations_version();
+
+    const auto key = this->render_key_for(line, flags);
+    auto cached = this->lss_render_cache.get(key);
+    if (cached) {
+        return cached.value();
+    }
+
+    auto retval = this->render_line(line, key.rck_flags);
+    if (this->is_render_cacheable(line)) {
+        this->lss_render_cache.put(key, retval);
+    }
+
+    return retval;
+}
+
+bool
+logfile_sub_source::is_render_cacheable(content_line_t line) const
+{
+    const auto* lf = this->find_file_ptr(line);
+    if (lf == nullptr) {
+        return false;
+    }
+
+    auto next_msg = lf->begin() + line + 1;
+
+    // The last message in a file can still grow, either by having more
+    // text appended to a partial line or by gaining continuation lines.
+    while (next_msg != lf->end() && next_msg->is_continued()) {
+        ++next_msg;
+    }
+
+    return next_msg != lf->end();
+}
+
+bool
+logfile_sub_source::prefetch_rendered_lines(textview_curses& tc,
+                                            ui_clock::time_point deadline)
+{
+    static auto op = lnav_operation{"render_prefetch"};
+
+    if (this->lss_indexing_in_progress || this->lss_in_value_for_line
+        || this->lss_filtered_index.empty())
+    {
+        return false;
+    }
+
+    const auto top = tc.get_top();
+    const auto bottom = tc.get_bottom();
+    const auto page_size = bottom - top + 1_vl;
+    const auto height = vis_line_t(this->lss_filtered_index.size());
+    std::vector<content_line_t> todo;
+
+    this->update_decorations_version();
+    auto add_row = [this, &todo](vis_line_t vl) {
+        const auto cl = this->at(vl);
+        const auto key = this->render_key_for(cl, 0);
+
+        if (!this->lss_render_cache.exists(key)
+            && this->is_render_cacheable(cl))
+        {
+            todo.emplace_back(cl);
+        }
+    };
+
+    // Page-down is more common than page-up, so render below first.
+    for (auto vl = bottom + 1_vl; vl <= bottom + page_size && vl < height;
+         ++vl)
+    {
+        add_row(vl);
+    }
+    for (auto vl = top - 1_vl; vl >= top - page_size && vl >= 0_vl; --vl) {
+        add_row(vl);
+    }
+
+    if (todo.empty()) {
+        return false;
+    }
+
+    auto op_guard = lnav_opid_guard::internal(op);
+    for (const auto cl : todo) {
+        if (ui_clock::now() >= deadline) {
+            return true;
+        }
+
+        const auto key = this->render_key_for(cl, 0);
+        this->lss_render_cache.put(key, this->render_line(cl, 0));
+    }
+
+    return false;
+}
+
 void
 logfile_sub_source::text_attrs_for_line(textview_curses& lv,
                                         int row,
@@ -999,6 +1213,232 @@ struct logline_cmp {
     logfile_sub_source& llss_controller;
 };
 
+namespace {
+
+/**
+ * An entry in the index along with a copy of the fields that are used to
+ * order the lines so that sorting does not need to look up the logline.
+ */
+struct sort_entry {
+    std::chrono::microseconds se_time;
+    file_off_t se_offset;
+    uint16_t se_sub_offset;
+    logfile_sub_source::indexed_content se_content;
+
+    bool operator<(const sort_entry& rhs) const
+    {
+        return std::tie(this->se_time, this->se_offset, this->se_sub_offset)
+            < std::tie(rhs.se_time, rhs.se_offset, rhs.se_sub_offset);
+    }
+};
+
+/**
+ * Sort the entries, which are made up of one run per file.  The runs are
+ * sorted in place, in parallel, and then merged straight into the output
+ * so no other copy of the entries is needed.
+ *
+ * @param entries The entries to sort.
+ * @param run_starts The offset of the start of each run in entries.
+ * @param emit Called with each entry in order.
+ */
+template<typename F>
+void
+sort_index_runs(std::vector<sort_entry>& entries,
+                std::vector<size_t> run_starts,
+                F emit)
+{
+    static constexpr size_t MIN_ENTRIES_PER_WORKER = 64 * 1024;
+
+    run_starts.emplace_back(entries.size());
+
+    const auto run_count = run_starts.size() - 1;
+    // Files are usually in time order already, so most runs only need to
+    // be checked.
+    auto sort_run = [&entries, &run_starts](size_t run) {
+        auto run_begin = entries.begin() + run_starts[run];
+        auto run_end = entries.begin() + run_starts[run + 1];
+
+        if (!std::is_sorted(run_begin, run_end)) {
+            std::sort(run_begin, run_end);
+        }
+    };
+
+    if (run_count > 1 && entries.size() >= MIN_ENTRIES_PER_WORKER) {
+        auto& pool = lnav::worker_pool::shared();
+        std::vector<std::future<void>> pending;
+
+        pending.reserve(run_count - 1);
+        for (size_t run = 1; run < run_count; run++) {
+            pending.emplace_back(
+                pool.submit([&sort_run, run]() { sort_run(run); }));
+        }
+        sort_run(0);
+        for (auto& fut : pending) {
+            fut.get();
+        }
+    } else {
+        for (size_t run = 0; run < run_count; run++) {
+            sort_run(run);
+        }
+    }
+
+    struct run_cursor {
+        size_t rc_next;
+        size_t rc_end;
+        size_t rc_run;
+    };
+
+    std::vector<run_cursor> heads;
+    for (size_t run = 0; run < run_count; run++) {
+        if (run_starts[run] < run_starts[run + 1]) {
+            heads.emplace_back(
+                run_cursor{run_starts[run], run_starts[run + 1], run});
+        }
+    }
+
+    // A heap of the next entry from each run, with ties going to the
+    // earlier run so files keep their order like a stable merge.
+    auto after = [&entries](const run_cursor& lhs, const run_cursor& rhs) {
+        const auto& lhs_entry = entries[lhs.rc_next];
+        const auto& rhs_entry = entries[rhs.rc_next];
+
+        if (rhs_entry < lhs_entry) {
+            return true;
+        }
+        if (lhs_entry < rhs_entry) {
+            return false;
+        }
+        return lhs.rc_run > rhs.rc_run;
+    };
+    std::make_heap(heads.begin(), heads.end(), after);
+    while (heads.size() > 1) {
+        std::pop_heap(heads.begin(), heads.end(), after);
+
+        auto& head = heads.back();
+        emit(entries[head.rc_next]);
+        head.rc_next += 1;
+        if (head.rc_next == head.rc_end) {
+            heads.pop_back();
+        } else {
+            std::push_heap(heads.begin(), heads.end(), after);
+        }
+    }
+    if (!heads.empty()) {
+        for (auto lpc = heads.front().rc_next; lpc < heads.front().rc_end;
+             lpc++)
+        {
+            emit(entries[lpc]);
+        }
+    }
+}
+
+}  // namespace
+
+std::vector<std::optional<logfile::rebuild_result_t>>
+logfile_sub_source::index_files_concurrently(
+    std::optional<ui_clock::time_point> deadline)
+{
+    static constexpr file_ssize_t MIN_PENDING_SIZE = 512 * 1024;
+    static const auto& lc = injector::get<const lnav::logfile::config&>();
+    static auto op = lnav_operation{"index_files_concurrently"};
+
+    std::vector<std::optional<logfile::rebuild_result_t>> retval(
+        this->lss_files.size());
+
+    if (this->tss_view->is_paused()) {
+        return retval;
+    }
+
+    size_t max_threads = lc.lc_indexing_threads;
+    if (max_threads == 0) {
+        max_threads = std::thread::hardware_concurrency();
+    }
+    if (max_threads <= 1) {
+        return retval;
+    }
+
+    // SQL filters and watch expressions are evaluated using the main
+    // database connection, which cannot be shared with the workers.
+    for (const auto& filt : this->get_filters()) {
+        if (!filt->lf_deleted && filt->get_lang() != filter_lang_t::REGEX) {
+            return retval;
+        }
+    }
+    if (lnav::log::watch::has_enabled_exprs()) {
+        return retval;
+    }
+
+    std::vector<size_t> candidates;
+    for (size_t file_index = 0; file_index < this->lss_files.size();
+         file_index++)
+    {
+        auto* lf = this->lss_files[file_index]->get_file_ptr();
+
+        if (lf == nullptr || lf->is_closed() || !lf->is_indexing()
+            || lf->is_detecting_format())
+        {
+            continue;
+        }
+        if (lf->get_content_size() - lf->get_index_size() < MIN_PENDING_SIZE)
+        {
+            continue;
+        }
+        candidates.emplace_back(file_index);
+    }
+    if (candidates.size() < 2) {
+        return retval;
+    }
+
+    auto op_guard = lnav_opid_guard::internal(op);
+    auto thread_count = std::min(max_threads, candidates.size());
+    log_info("indexing %zu files using %zu threads",
+             candidates.size(),
+             thread_count);
+
+    // The progress observer updates the UI, so it is detached while the
+    // workers are running and then poked once they are finished.
+    std::vector<logfile_observer*> observers;
+    for (const auto file_index : candidates) {
+        auto* lf = this->lss_files[file_index]->get_file_ptr();
+
+        observers.emplace_back(lf->get_logfile_observer());
+        lf->set_logfile_observer(nullptr);
+    }
+
+    std::atomic_size_t next_candidate{0};
+    std::vector<std::future<void>> workers;
+    for (size_t lpc = 0; lpc < thread_count; lpc++) {
+        workers.emplace_back(std::async(std::launch::async, [&, lpc]() {
+            log_set_thread_prefix(fmt::format(FMT_STRING("indexer-{}"), lpc));
+            while (true) {
+                auto index = next_candidate.fetch_add(1);
+                if (index >= candidates.size()) {
+                    break;
+                }
+
+                auto file_index = candidates[index];
+                auto* lf = this->lss_files[file_index]->get_file_ptr();
+                retval[file_index] = lf->rebuild_index(deadline);
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker.get();
+    }
+
+    for (size_t lpc = 0; lpc < candidates.size(); lpc++) {
+        auto* lf = this->lss_files[candidates[lpc]]->get_file_ptr();
+
+        lf->set_logfile_observer(observers[lpc]);
+        if (observers[lpc] != nullptr) {
+            observers[lpc]->logfile_indexing(
+                lf, lf->get_indexed_file_offset(), lf->get_content_size());
+        }
+    }
+
+    return retval;
+}
+
 logfile_sub_source::rebuild_result
 logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
 {
@@ -1052,6 +1492,7 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
                          });
     }
 
+    auto concurrent_results = this->index_files_concurrently(deadline);
     bool time_left = true;
     this->lss_all_timestamp_flags = 0;
     for (const auto file_index : file_order) {
@@ -1078,8 +1519,12 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
             this->lss_all_timestamp_flags
                 |= lf->get_format_ptr()->lf_timestamp_flags;
 
-            if (!this->tss_view->is_paused() && time_left) {
-                auto log_rebuild_res = lf->rebuild_index(deadline);
+            if (!this->tss_view->is_paused()
+                && (time_left || concurrent_results[file_index]))
+            {
+                auto log_rebuild_res = concurrent_results[file_index]
+                    ? concurrent_results[file_index].value()
+                    : lf->rebuild_index(deadline);
 
                 if (ld.ld_lines_indexed < lf->size()
                     && log_rebuild_res
@@ -1175,13 +1620,9 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
     }
 
     if (this->lss_index.reserve(total_lines + est_remaining_lines)) {
-        // The index array was reallocated, just do a full sort/rebuild since
-        // it's been cleared out.
+        // New segments are added to the end of the index, the existing
+        // entries are still valid.
         log_debug("expanding index capacity %zu", this->lss_index.ba_capacity);
-        force = true;
-        retval = rebuild_result::rr_full_rebuild;
-        full_sort = true;
-        this->tss_level_filtered_count = 0;
     }
 
     auto& vis_bm = this->tss_view->get_bookmarks();
@@ -1234,10 +1675,10 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
             remaining += lf->size() - ld.ld_lines_indexed;
         }
 
-        auto* row_iter = std::lower_bound(this->lss_index.begin(),
-                                          this->lss_index.end(),
-                                          lowest_tv.value(),
-                                          logline_cmp(*this));
+        auto row_iter = std::lower_bound(this->lss_index.begin(),
+                                         this->lss_index.end(),
+                                         lowest_tv.value(),
+                                         logline_cmp(*this));
         this->lss_index.shrink_to(
             std::distance(this->lss_index.begin(), row_iter));
         log_debug("new index size %ld/%ld; remain %ld",
@@ -1276,7 +1717,6 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
 
     if (retval != rebuild_result::rr_no_change || force) {
         size_t index_size = 0, start_size = this->lss_index.size();
-        logline_cmp line_cmper(*this);
 
         for (auto& ld : this->lss_files) {
             auto* lf = ld->get_file_ptr();
@@ -1295,6 +1735,8 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
 
         if (full_sort) {
             log_trace("rebuild_index full sort");
+            std::vector<sort_entry> entries;
+            std::vector<size_t> run_starts;
             for (auto& ld : this->lss_files) {
                 auto* lf = ld->get_file_ptr();
 
@@ -1302,6 +1744,8 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
                     continue;
                 }
 
+                run_starts.emplace_back(entries.size());
+
                 for (size_t line_index = 0; line_index < lf->size();
                      line_index++)
                 {
@@ -1340,18 +1784,23 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
                                 .insert_once(start_con_line);
                         }
                     }
-                    this->lss_index.push_back(
-                        indexed_content{con_line, lf_iter});
+                    entries.emplace_back(sort_entry{
+                        lf_iter->get_time<std::chrono::microseconds>(),
+                        lf_iter->get_offset(),
+                        lf_iter->get_sub_offset(),
+                        indexed_content{con_line, lf_iter},
+                    });
                 }
             }
 
-            // XXX get rid of this full sort on the initial run, it's not
-            // needed unless the file is not in time-order
             if (this->lss_sorting_observer) {
-                this->lss_sorting_observer(*this, 0, this->lss_index.size());
+                this->lss_sorting_observer(*this, 0, entries.size());
             }
-            std::sort(
-                this->lss_index.begin(), this->lss_index.end(), line_cmper);
+            this->lss_index.reserve(entries.size());
+            sort_index_runs(
+                entries, std::move(run_starts), [this](const auto& entry) {
+                    this->lss_index.push_back(entry.se_content);
+                });
             if (this->lss_sorting_observer) {
                 this->lss_sorting_observer(
                     *this, this->lss_index.size(), this->lss_index.size());
@@ -1448,7 +1897,7 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
 
         this->lss_filtered_index.reserve(this->lss_index.size());
 
-        uint32_t filter_in_mask, filter_out_mask;
+        filter_mask filter_in_mask, filter_out_mask;
         this->get_filters().get_enabled_mask(filter_in_mask, filter_out_mask);
 
         if (start_size == 0 && this->lss_index_delegate != nullptr) {
@@ -1515,12 +1964,14 @@ logfile_sub_source::rebuild_index(std::optional<ui_clock::time_point> deadline)
         case rebuild_result::rr_full_rebuild:
             log_debug("redoing search");
             this->lss_index_generation += 1;
+            this->invalidate_rendered_lines();
             this->tss_view->reload_data();
             this->tss_view->redo_search();
             break;
         case rebuild_result::rr_partial_rebuild:
             log_debug("redoing search from: %d", (int) search_start);
             this->lss_index_generation += 1;
+            this->invalidate_rendered_lines();
             this->tss_view->reload_data();
             this->tss_view->search_new_data(search_start);
             break;
@@ -1627,7 +2078,7 @@ logfile_sub_source::text_filters_changed()
     }
 
     auto& vis_bm = this->tss_view->get_bookmarks();
-    uint32_t filtered_in_mask, filtered_out_mask;
+    filter_mask filtered_in_mask, filtered_out_mask;
 
     this->get_filters().get_enabled_mask(filtered_in_mask, filtered_out_mask);
 
@@ -1636,6 +2087,23 @@ logfile_sub_source::text_filters_changed()
     }
     vis_bm[&textview_curses::BM_USER_EXPR].clear();
 
+    // Combine the filter masks for each file in bulk before walking the
+    // index, which is interleaved across files.
+    std::vector<std::vector<uint64_t>> excluded_bits(this->lss_files.size());
+    if (this->tss_apply_filters) {
+        for (size_t file_index = 0; file_index < this->lss_files.size();
+             file_index++)
+        {
+            const auto& ld = this->lss_files[file_index];
+
+            if (ld->is_visible() && ld->get_file_ptr() != nullptr) {
+                ld->ld_filter_state.excluded_lines(filtered_in_mask,
+                                                   filtered_out_mask,
+                                                   excluded_bits[file_index]);
+            }
+        }
+    }
+
     this->lss_filtered_index.clear();
     for (size_t index_index = 0; index_index < this->lss_index.size();
          index_index++)
@@ -1650,11 +2118,13 @@ logfile_sub_source::text_filters_changed()
 
         auto lf = (*ld)->get_file_ptr();
         auto line_iter = lf->begin() + line_number;
+        const auto& file_bits
+            = excluded_bits[std::distance(this->lss_files.begin(), ld)];
+        const auto is_excluded = line_number / 64 < file_bits.size()
+            && ((file_bits[line_number / 64] >> (line_number % 64)) & 1);
 
         if (!this->tss_apply_filters
-            || (!(*ld)->ld_filter_state.excluded(
-                    filtered_in_mask, filtered_out_mask, line_number)
-                && this->check_extra_filters(ld, line_iter)))
+            || (!is_excluded && this->check_extra_filters(ld, line_iter)))
         {
             auto eval_res = this->eval_sql_filter(
                 this->lss_marker_stmt.in(), ld, line_iter);
@@ -2420,6 +2890,8 @@ logfile_sub_source::remove_file(std::shared_ptr<logfile> lf)
         }
     }
     this->lss_token_file = nullptr;
+    this->lss_token_rendered = nullptr;
+    this->invalidate_rendered_lines();
 }
 
 std::optional<vis_line_t>
@@ -3400,8 +3872,8 @@ logfile_sub_source::get_filtered_count_for(size_t filter_index) const
     int retval = 0;
 
     for (const auto& ld : this->lss_files) {
-        retval += ld->ld_filter_state.lfo_filter_state
-                      .tfs_filter_hits[filter_index];
+        retval += ld->ld_filter_state.lfo_filter_state.filter_hits(
+            filter_index);
     }
 
     return retval;
@@ -3684,6 +4156,9 @@ logfile_sub_source::reload_config(error_reporter& reporter)
         case logfile_sub_source_ns::time_column_feature_t::Enabled:
             break;
     }
+
+    // The format highlighters and theme might have changed.
+    this->invalidate_rendered_lines();
 }
 
 void
@@ -3695,7 +4170,9 @@ logfile_sub_source::clear_preview()
     auto last = std::remove_if(this->lss_highlighters.begin(),
                                this->lss_highlighters.end(),
                                [](const auto& hl) { return hl.h_preview; });
-    this->lss_highlighters.erase(last, this->lss_highlighters.end());
+    if (last != this->lss_highlighters.end()) {
+        this->lss_highlighters.erase(last, this->lss_highlighters.end());
+    }
 }
 
 void
@@ -34,11 +34,13 @@
 
 #include <array>
 #include <map>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <limits.h>
 
+#include "base/lrucache.hpp"
 #include "base/time_util.hh"
 #include "big_array.hh"
 #include "bookmarks.hh"
@@ -709,6 +711,25 @@ public:
 
     void clear_preview();
 
+    /**
+     * Discard the cached renderings of the log messages.  Needs to be
+     * called when the messages themselves or the format highlighters have
+     * changed.  Changes to the hidden fields, field highlighters, and
+     * breakpoints are picked up by the cache key.
+     */
+    void invalidate_rendered_lines() { this->lss_render_generation += 1; }
+
+    /**
+     * Render the messages in the pages above and below the viewport of
+     * the given view so that they are ready when the user scrolls.
+     *
+     * @param tc The view that is displaying this source.
+     * @param deadline The time to stop rendering.
+     * @return True if there are more messages that could be rendered.
+     */
+    bool prefetch_rendered_lines(textview_curses& tc,
+                                 ui_clock::time_point deadline);
+
     void add_commands_for_session(
         const std::function<void(const std::string&)>& receiver);
 
@@ -724,6 +745,53 @@ protected:
 
 private:
     static const size_t LINE_SIZE_CACHE_SIZE = 512;
+    static const size_t RENDER_CACHE_SIZE = 512;
+
+    /**
+     * A message that has been read, annotated, and highlighted.  This is
+     * the part of text_value_for_line() that is independent of the view
+     * settings, like the time column or line context.
+     */
+    struct rendered_line {
+        attr_line_t rl_al;
+        logline_value_vector rl_values;
+    };
+
+    struct render_cache_key {
+        content_line_t rck_line;
+        line_flags_t rck_flags;
+        uint32_t rck_generation;
+        /** The display generation of the message's format. */
+        size_t rck_format_generation;
+        uint32_t rck_decorations_version;
+
+        bool operator<(const render_cache_key& rhs) const
+        {
+            return std::tie(this->rck_line,
+                            this->rck_flags,
+                            this->rck_generation,
+                            this->rck_format_generation,
+                            this->rck_decorations_version)
+                < std::tie(rhs.rck_line,
+                           rhs.rck_flags,
+                           rhs.rck_generation,
+                           rhs.rck_format_generation,
+                           rhs.rck_decorations_version);
+        }
+    };
+
+    /**
+     * The parts of the highlighters and breakpoints that are drawn into
+     * a rendered message.  A copy is kept so that changes to them can be
+     * detected without every caller having to report them.
+     */
+    struct render_decorations {
+        std::vector<highlighter> rd_highlighters;
+        std::vector<std::pair<std::string, bool>> rd_breakpoints;
+
+        bool matches(const std::vector<highlighter>& hls,
+                     const std::map<std::string, breakpoint_info>& bps) const;
+    };
 
     void clear_line_size_cache()
     {
@@ -733,6 +801,30 @@ private:
 
     bool check_extra_filters(iterator ld, logfile::iterator ll);
 
+    std::shared_ptr<const rendered_line> render_line(content_line_t line,
+                                                     line_flags_t flags);
+
+    std::shared_ptr<const rendered_line> lookup_rendered_line(
+        content_line_t line, line_flags_t flags);
+
+    bool is_render_cacheable(content_line_t line) const;
+
+    void update_decorations_version();
+
+    render_cache_key render_key_for(content_line_t line,
+                                    line_flags_t flags) const;
+
+    /**
+     * Index the pending data in several large files at once using a pool of
+     * worker threads.  Only files that have locked onto a format are
+     * eligible since format detection uses shared state.
+     *
+     * @return The rebuild results for the files that were indexed, addressed
+     * by the position of the file in lss_files.
+     */
+    std::vector<std::optional<logfile::rebuild_result_t>>
+    index_files_concurrently(std::optional<ui_clock::time_point> deadline);
+
     size_t lss_basename_width = 0;
     size_t lss_filename_width = 0;
     line_context_t lss_line_context{line_context_t::none};
@@ -762,6 +854,12 @@ private:
     std::vector<std::pair<int, int>> lss_token_shifts;
     shared_buffer lss_share_manager;
     logfile::iterator lss_token_line;
+    std::shared_ptr<const rendered_line> lss_token_rendered;
+    cache::lru_cache<render_cache_key, std::shared_ptr<const rendered_line>>
+        lss_render_cache{RENDER_CACHE_SIZE};
+    uint32_t lss_render_generation{0};
+    render_decorations lss_render_decorations;
+    uint32_t lss_decorations_version{0};
     std::array<std::pair<int, size_t>, LINE_SIZE_CACHE_SIZE>
         lss_line_size_cache;
     bool lss_marked_only{false};
@@ -237,6 +237,8 @@ logline_window::logmsg_info::load_msg() const
                      std::distance(this->li_file->begin(), this->li_logline),
                      this->li_string_attrs,
                      this->li_line_values);
+    this->li_file->get_column_cache().store(this->li_line_number,
+                                            this->li_line_values);
 
     if (!this->li_line_values.lvv_opid_value) {
         auto bm_opt = this->get_metadata();
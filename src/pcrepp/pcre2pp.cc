@@ -32,6 +32,11 @@
 #include "pcre2pp.hh"
 
 #include <algorithm>
+#include <utility>
+
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
 
 #include "config.h"
 #include "ww898/cp_utf8.hpp"
@@ -67,6 +72,7 @@ capture_builder::into(lnav::pcre2pp::match_data& md) &&
     if (md.get_capacity() < this->mb_code.get_match_data_capacity()) {
         md = this->mb_code.create_match_data();
     }
+    md.set_capture_offset(0);
 
     return matcher{
         this->mb_code,
@@ -85,6 +91,665 @@ code::create_match_data() const
     return match_data{std::move(md)};
 }
 
+static thread_local bool DEFER_JIT = false;
+
+static bool
+jit_supported()
+{
+    static const bool retval = [] {
+        uint32_t jit = 0;
+
+        pcre2_config(PCRE2_CONFIG_JIT, &jit);
+        return jit == 1;
+    }();
+
+    return retval;
+}
+
+code::deferred_jit_guard::deferred_jit_guard()
+    : djg_prev(std::exchange(DEFER_JIT, true))
+{
+}
+
+code::deferred_jit_guard::~deferred_jit_guard()
+{
+    DEFER_JIT = this->djg_prev;
+}
+
+code::deferred_jit::~deferred_jit()
+{
+    auto* jit_code = this->dj_code.load();
+
+    if (jit_code != nullptr) {
+        pcre2_code_free(jit_code);
+    }
+}
+
+code::code(auto_mem<pcre2_code> code, std::string pattern)
+    : p_code(std::move(code)), p_pattern(std::move(pattern)),
+      p_match_proto(this->create_match_data())
+{
+    if (DEFER_JIT && jit_supported()) {
+        this->p_deferred_jit = std::make_shared<deferred_jit>();
+    }
+
+    uint32_t options = 0;
+
+    pcre2_pattern_info(this->p_code.in(), PCRE2_INFO_ARGOPTIONS, &options);
+    this->p_prefilter = prefilter::from_pattern(this->p_pattern, options);
+
+    uint32_t all_options = 0;
+    uint32_t first_code_type = 0;
+    const uint8_t* first_bitmap = nullptr;
+
+    pcre2_pattern_info(this->p_code.in(), PCRE2_INFO_ALLOPTIONS, &all_options);
+    pcre2_pattern_info(
+        this->p_code.in(), PCRE2_INFO_MINLENGTH, &this->p_min_length);
+    pcre2_pattern_info(
+        this->p_code.in(), PCRE2_INFO_FIRSTCODETYPE, &first_code_type);
+    pcre2_pattern_info(
+        this->p_code.in(), PCRE2_INFO_FIRSTBITMAP, &first_bitmap);
+    this->p_anchored = (all_options & PCRE2_ANCHORED);
+    if (first_code_type == 1) {
+        // PCRE2 does not build a bitmap when the first code unit is fixed,
+        // so make one with just that code unit.
+        uint32_t first_unit = 0;
+
+        pcre2_pattern_info(
+            this->p_code.in(), PCRE2_INFO_FIRSTCODEUNIT, &first_unit);
+        if (first_unit <= 0xff) {
+            auto& bitmap = this->p_first_bitmap.emplace();
+            auto set_bit = [&bitmap](uint32_t ch) {
+                bitmap[ch / 8] |= 1U << (ch % 8);
+            };
+
+            set_bit(first_unit);
+            // The first code unit is matched caselessly if the pattern is
+            // caseless at that point, which is only done for ASCII.
+            if (first_unit < 0x80 && isalpha(first_unit)) {
+                set_bit(tolower(first_unit));
+                set_bit(toupper(first_unit));
+            }
+        }
+    } else if (first_bitmap != nullptr) {
+        this->p_first_bitmap.emplace();
+        std::copy(first_bitmap,
+                  first_bitmap + this->p_first_bitmap->size(),
+                  this->p_first_bitmap->begin());
+    }
+}
+
+bool
+code::is_jit_compiled() const
+{
+    if (this->p_deferred_jit != nullptr) {
+        return this->p_deferred_jit->dj_code.load() != nullptr;
+    }
+
+    size_t jit_size = 0;
+
+    pcre2_pattern_info(this->p_code.in(), PCRE2_INFO_JITSIZE, &jit_size);
+
+    return jit_size > 0;
+}
+
+const pcre2_code*
+code::get_match_code() const
+{
+    if (this->p_deferred_jit == nullptr) {
+        return this->p_code.in();
+    }
+
+    auto& dj = *this->p_deferred_jit;
+    const auto* jit_code = dj.dj_code.load(std::memory_order_acquire);
+    if (jit_code != nullptr) {
+        return jit_code;
+    }
+
+    // Only the thread that hits the threshold does the compile.  A copy
+    // is compiled since other threads can be matching with the original
+    // and the copy is only published once it is ready.
+    if (dj.dj_match_count.fetch_add(1, std::memory_order_relaxed) + 1
+        == JIT_THRESHOLD)
+    {
+        auto* copy = pcre2_code_copy(this->p_code.in());
+
+        if (copy != nullptr) {
+            if (pcre2_jit_compile(copy, PCRE2_JIT_COMPLETE) == 0) {
+                dj.dj_code.store(copy, std::memory_order_release);
+                return copy;
+            }
+            pcre2_code_free(copy);
+        }
+    }
+
+    return this->p_code.in();
+}
+
+bool
+code::has_back_references() const
+{
+    uint32_t backref_max = 0;
+
+    pcre2_pattern_info(this->p_code.in(), PCRE2_INFO_BACKREFMAX, &backref_max);
+
+    return backref_max > 0;
+}
+
+bool
+code::might_match(string_fragment in) const
+{
+    // The minimum length is in characters, which is never more than the
+    // length in bytes.
+    if ((size_t) in.length() < this->p_min_length) {
+        return false;
+    }
+    if (this->p_anchored && this->p_first_bitmap && !in.empty()) {
+        auto first = static_cast<unsigned char>(in.front());
+
+        if (!((*this->p_first_bitmap)[first / 8] & (1U << (first % 8)))) {
+            return false;
+        }
+    }
+
+    return this->p_prefilter.might_match(in);
+}
+
+namespace {
+
+/**
+ * Walks a pattern to find the runs of literal characters that are required
+ * for a match.  Anything inside of a group is skipped, so only the literals
+ * at the top-level of each alternative are considered.
+ */
+class literal_scanner {
+public:
+    static constexpr size_t MIN_LITERAL_SIZE = 2;
+    static constexpr size_t MAX_LITERALS = 8;
+
+    literal_scanner(string_fragment pattern, bool caseless)
+        : ls_pattern(pattern.to_string_view()), ls_caseless(caseless)
+    {
+    }
+
+    /**
+     * @return The longest required literal for each alternative or nullopt
+     * if the pattern could not be analyzed or an alternative did not have
+     * a usable literal.
+     */
+    std::optional<std::vector<std::string>> scan()
+    {
+        while (this->ls_index < this->ls_pattern.size()) {
+            auto ch = this->ls_pattern[this->ls_index];
+
+            switch (ch) {
+                case '\\':
+                    if (!this->scan_escape()) {
+                        return std::nullopt;
+                    }
+                    break;
+                case '[':
+                    this->end_run();
+                    if (!this->skip_class() || !this->skip_quantifier()) {
+                        return std::nullopt;
+                    }
+                    break;
+                case '(':
+                    this->end_run();
+                    if (!this->skip_group() || !this->skip_quantifier()) {
+                        return std::nullopt;
+                    }
+                    break;
+                case '|':
+                    this->end_branch();
+                    this->ls_index += 1;
+                    break;
+                case '.':
+                case '^':
+                case '$':
+                    this->end_run();
+                    this->ls_index += 1;
+                    if (!this->skip_quantifier()) {
+                        return std::nullopt;
+                    }
+                    break;
+                case ')':
+                case '*':
+                case '+':
+                case '?':
+                case '{':
+                    return std::nullopt;
+                default: {
+                    auto len = utf8_length(ch);
+                    if (this->ls_index + len > this->ls_pattern.size()) {
+                        return std::nullopt;
+                    }
+                    auto atom = this->ls_pattern.substr(this->ls_index, len);
+                    this->ls_index += len;
+                    if (this->ls_caseless && !is_simple_caseless(ch)) {
+                        // Only ASCII is case-folded here.
+                        this->end_run();
+                        if (!this->skip_quantifier()) {
+                            return std::nullopt;
+                        }
+                    } else if (!this->add_literal(atom)) {
+                        return std::nullopt;
+                    }
+                    break;
+                }
+            }
+        }
+        this->end_branch();
+
+        if (this->ls_branches.size() > MAX_LITERALS) {
+            return std::nullopt;
+        }
+        for (auto& lit : this->ls_branches) {
+            if (lit.size() < MIN_LITERAL_SIZE) {
+                return std::nullopt;
+            }
+            if (this->ls_caseless) {
+                std::transform(
+                    lit.begin(), lit.end(), lit.begin(), [](auto ch) {
+                        return tolower(ch);
+                    });
+            }
+        }
+
+        return std::move(this->ls_branches);
+    }
+
+    /**
+     * @return True if the given character only matches its ASCII upper and
+     * lower case forms in a caseless UTF pattern.  The letters 'k' and 's'
+     * also match the Kelvin sign and long s.
+     */
+    static bool is_simple_caseless(char ch)
+    {
+        auto uch = static_cast<unsigned char>(ch);
+
+        return uch < 0x80 && tolower(uch) != 'k' && tolower(uch) != 's';
+    }
+
+private:
+    static size_t utf8_length(char ch)
+    {
+        auto uch = static_cast<unsigned char>(ch);
+
+        if (uch < 0x80) {
+            return 1;
+        }
+        if ((uch & 0xe0) == 0xc0) {
+            return 2;
+        }
+        if ((uch & 0xf0) == 0xe0) {
+            return 3;
+        }
+        return 4;
+    }
+
+    bool at_end() const { return this->ls_index >= this->ls_pattern.size(); }
+
+    char peek(size_t off = 0) const
+    {
+        if (this->ls_index + off >= this->ls_pattern.size()) {
+            return '\0';
+        }
+        return this->ls_pattern[this->ls_index + off];
+    }
+
+    void end_run()
+    {
+        if (this->ls_run.size() > this->ls_best.size()) {
+            this->ls_best = this->ls_run;
+        }
+        this->ls_run.clear();
+    }
+
+    void end_branch()
+    {
+        this->end_run();
+        this->ls_branches.emplace_back(std::move(this->ls_best));
+        this->ls_best.clear();
+    }
+
+    /**
+     * Add a literal atom to the current run, taking any quantifier that
+     * follows it into account.
+     */
+    bool add_literal(std::string_view atom)
+    {
+        auto quant = this->parse_quantifier();
+        if (!quant) {
+            return false;
+        }
+        if (quant.value() == quantifier::none) {
+            this->ls_run.append(atom);
+        } else if (quant.value() == quantifier::optional) {
+            this->end_run();
+        } else {
+            this->ls_run.append(atom);
+            this->end_run();
+        }
+        return true;
+    }
+
+    enum class quantifier {
+        none,
+        optional,
+        required,
+    };
+
+    std::optional<quantifier> parse_quantifier()
+    {
+        auto retval = quantifier::none;
+
+        switch (this->peek()) {
+            case '?':
+            case '*':
+                retval = quantifier::optional;
+                this->ls_index += 1;
+                break;
+            case '+':
+                retval = quantifier::required;
+                this->ls_index += 1;
+                break;
+            case '{': {
+                size_t off = 1;
+                size_t min_digits = 0;
+                bool min_zero = true;
+
+                while (isdigit(this->peek(off))) {
+                    if (this->peek(off) != '0') {
+                        min_zero = false;
+                    }
+                    min_digits += 1;
+                    off += 1;
+                }
+                if (this->peek(off) == ',') {
+                    off += 1;
+                    while (isdigit(this->peek(off))) {
+                        off += 1;
+                    }
+                }
+                if (this->peek(off) != '}' || off == 1) {
+                    // Not a quantifier, which PCRE treats as a literal, but
+                    // keep things simple and give up.
+                    return std::nullopt;
+                }
+                retval = (min_digits == 0 || min_zero) ? quantifier::optional
+                                                       : quantifier::required;
+                this->ls_index += off + 1;
+                break;
+            }
+            default:
+                return retval;
+        }
+
+        // lazy and possessive modifiers
+        if (this->peek() == '?' || this->peek() == '+') {
+            this->ls_index += 1;
+        }
+
+        return retval;
+    }
+
+    bool skip_quantifier() { return this->parse_quantifier().has_value(); }
+
+    bool scan_escape()
+    {
+        auto ch = this->peek(1);
+
+        if (ch == '\0') {
+            return false;
+        }
+        if (static_cast<unsigned char>(ch) >= 0x80) {
+            return false;
+        }
+        if (!isalnum(ch)) {
+            this->ls_index += 2;
+            return this->add_literal(std::string_view(&ch, 1));
+        }
+
+        // Character types, assertions, back references and the like.
+        this->end_run();
+        this->ls_index += 2;
+        switch (ch) {
+            case 'Q':
+                return false;
+            case 'c':
+                this->ls_index += 1;
+                break;
+            case 'x':
+                if (this->peek() != '{') {
+                    for (int lpc = 0; lpc < 2 && isxdigit(this->peek());
+                         lpc++)
+                    {
+                        this->ls_index += 1;
+                    }
+                }
+                break;
+            case 'g':
+            case 'k':
+                if (this->peek() == '<' || this->peek() == '\'') {
+                    auto close = this->peek() == '<' ? '>' : '\'';
+                    while (!this->at_end() && this->peek() != close) {
+                        this->ls_index += 1;
+                    }
+                    if (this->at_end()) {
+                        return false;
+                    }
+                    this->ls_index += 1;
+                }
+                break;
+            default:
+                if (isdigit(ch)) {
+                    while (isdigit(this->peek())) {
+                        this->ls_index += 1;
+                    }
+                }
+                break;
+        }
+        if (this->peek() == '{') {
+            while (!this->at_end() && this->peek() != '}') {
+                this->ls_index += 1;
+            }
+            if (this->at_end()) {
+                return false;
+            }
+            this->ls_index += 1;
+        }
+
+        return this->skip_quantifier();
+    }
+
+    bool skip_class()
+    {
+        this->ls_index += 1;
+        if (this->peek() == '^') {
+            this->ls_index += 1;
+        }
+        if (this->peek() == ']') {
+            this->ls_index += 1;
+        }
+        while (!this->at_end()) {
+            switch (this->peek()) {
+                case '\\':
+                    this->ls_index += 2;
+                    break;
+                case '[':
+                    if (this->peek(1) == ':') {
+                        auto end = this->ls_pattern.find(":]", this->ls_index);
+                        if (end == std::string_view::npos) {
+                            return false;
+                        }
+                        this->ls_index = end + 2;
+                    } else {
+                        this->ls_index += 1;
+                    }
+                    break;
+                case ']':
+                    this->ls_index += 1;
+                    return true;
+                default:
+                    this->ls_index += 1;
+                    break;
+            }
+        }
+
+        return false;
+    }
+
+    bool skip_group()
+    {
+        static constexpr std::string_view SAFE_GROUP_CHARS = ":<'=!>P|";
+
+        if (this->peek(1) == '*') {
+            // verbs like (*UTF) can change how the pattern is interpreted
+            return false;
+        }
+        if (this->peek(1) == '?'
+            && SAFE_GROUP_CHARS.find(this->peek(2)) == std::string_view::npos)
+        {
+            // option settings, comments, conditionals, and so on
+            return false;
+        }
+
+        size_t depth = 0;
+        while (!this->at_end()) {
+            switch (this->peek()) {
+                case '\\':
+                    if (this->peek(1) == 'Q') {
+                        return false;
+                    }
+                    this->ls_index += 2;
+                    break;
+                case '[':
+                    if (!this->skip_class()) {
+                        return false;
+                    }
+                    break;
+                case '(':
+                    depth += 1;
+                    this->ls_index += 1;
+                    break;
+                case ')':
+                    depth -= 1;
+                    this->ls_index += 1;
+                    if (depth == 0) {
+                        return true;
+                    }
+                    break;
+                default:
+                    this->ls_index += 1;
+                    break;
+            }
+        }
+
+        return false;
+    }
+
+    std::string_view ls_pattern;
+    bool ls_caseless;
+    size_t ls_index{0};
+    std::string ls_run;
+    std::string ls_best;
+    std::vector<std::string> ls_branches;
+};
+
+const char*
+find_caseless(const char* str, size_t len, const std::string& lit)
+{
+    auto lower = lit[0];
+    auto upper = static_cast<char>(toupper(lower));
+
+    while (len >= lit.size()) {
+        auto search_len = len - lit.size() + 1;
+        const auto* hit
+            = static_cast<const char*>(memchr(str, lower, search_len));
+
+        if (upper != lower) {
+            auto upper_len = hit == nullptr ? search_len : hit - str;
+            const auto* upper_hit
+                = static_cast<const char*>(memchr(str, upper, upper_len));
+            if (upper_hit != nullptr) {
+                hit = upper_hit;
+            }
+        }
+        if (hit == nullptr) {
+            return nullptr;
+        }
+        if (strncasecmp(hit, lit.data(), lit.size()) == 0) {
+            return hit;
+        }
+        len -= (hit - str) + 1;
+        str = hit + 1;
+    }
+
+    return nullptr;
+}
+
+}  // namespace
+
+prefilter
+prefilter::from_pattern(string_fragment pattern, uint32_t options)
+{
+    prefilter retval;
+
+    if (options & (PCRE2_EXTENDED | PCRE2_EXTENDED_MORE | PCRE2_ALT_BSUX)) {
+        return retval;
+    }
+
+    retval.pf_caseless = (options & PCRE2_CASELESS);
+    if (options & PCRE2_LITERAL) {
+        if (pattern.length() >= literal_scanner::MIN_LITERAL_SIZE
+            && (!retval.pf_caseless
+                || std::all_of(pattern.begin(),
+                               pattern.end(),
+                               literal_scanner::is_simple_caseless)))
+        {
+            auto lit = pattern.to_string();
+            if (retval.pf_caseless) {
+                std::transform(
+                    lit.begin(), lit.end(), lit.begin(), [](auto ch) {
+                        return tolower(ch);
+                    });
+            }
+            retval.pf_literals.emplace_back(std::move(lit));
+        }
+        return retval;
+    }
+
+    auto scan_res = literal_scanner(pattern, retval.pf_caseless).scan();
+    if (scan_res) {
+        retval.pf_literals = std::move(scan_res.value());
+    }
+
+    return retval;
+}
+
+bool
+prefilter::might_match(string_fragment sf) const
+{
+    if (this->pf_literals.empty()) {
+        return true;
+    }
+
+    for (const auto& lit : this->pf_literals) {
+        if (this->pf_caseless) {
+            if (find_caseless(sf.data(), sf.length(), lit) != nullptr) {
+                return true;
+            }
+        } else if (memmem(sf.data(), sf.length(), lit.data(), lit.size())
+                   != nullptr)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 Result<code, compile_error>
 code::from(string_fragment sf, int options)
 {
@@ -100,9 +765,11 @@ code::from(string_fragment sf, int options)
         return Err(ce);
     }
 
-    auto jit_rc = pcre2_jit_compile(co, PCRE2_JIT_COMPLETE);
-    if (jit_rc < 0) {
-        // log_error("failed to JIT compile pattern: %d", jit_rc);
+    if (!DEFER_JIT) {
+        auto jit_rc = pcre2_jit_compile(co, PCRE2_JIT_COMPLETE);
+        if (jit_rc < 0) {
+            // log_error("failed to JIT compile pattern: %d", jit_rc);
+        }
     }
 
     return Ok(code{std::move(co), sf.to_string()});
@@ -464,13 +1131,19 @@ matcher::found_p(uint32_t options)
         return false;
     }
 
-    auto rc = pcre2_match(this->mb_code.p_code.in(),
-                          this->mb_input.i_string.udata(),
-                          this->mb_input.i_string.length(),
-                          this->mb_input.i_offset,
-                          options,
-                          this->mb_match_data.md_data.in(),
-                          nullptr);
+    auto rc = PCRE2_ERROR_NOMATCH;
+    if ((options & (PCRE2_PARTIAL_HARD | PCRE2_PARTIAL_SOFT))
+        || this->mb_code.p_prefilter.might_match(
+            this->mb_input.i_string.substr(this->mb_input.i_offset)))
+    {
+        rc = pcre2_match(this->mb_code.get_match_code(),
+                         this->mb_input.i_string.udata(),
+                         this->mb_input.i_string.length(),
+                         this->mb_input.i_offset,
+                         options,
+                         this->mb_match_data.md_data.in(),
+                         nullptr);
+    }
 
     if (rc > 0) {
         this->mb_match_data.md_input = this->mb_input;
@@ -511,13 +1184,19 @@ matcher::matches(uint32_t options)
         return not_found{};
     }
 
-    auto rc = pcre2_match(this->mb_code.p_code.in(),
-                          this->mb_input.i_string.udata(),
-                          this->mb_input.i_string.length(),
-                          this->mb_input.i_offset,
-                          options,
-                          this->mb_match_data.md_data.in(),
-                          nullptr);
+    auto rc = PCRE2_ERROR_NOMATCH;
+    if ((options & (PCRE2_PARTIAL_HARD | PCRE2_PARTIAL_SOFT))
+        || this->mb_code.p_prefilter.might_match(
+            this->mb_input.i_string.substr(this->mb_input.i_offset)))
+    {
+        rc = pcre2_match(this->mb_code.get_match_code(),
+                         this->mb_input.i_string.udata(),
+                         this->mb_input.i_string.length(),
+                         this->mb_input.i_offset,
+                         options,
+                         this->mb_match_data.md_data.in(),
+                         nullptr);
+    }
 
     if (rc > 0) {
         this->mb_match_data.md_input = this->mb_input;
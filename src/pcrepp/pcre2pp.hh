@@ -32,6 +32,8 @@
 
 #define PCRE2_CODE_UNIT_WIDTH 8
 
+#include <array>
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <string>
@@ -78,8 +80,23 @@ public:
             this->md_input.i_string.sf_end);
     }
 
+    /**
+     * Read the numbered captures, other than the whole match, from the
+     * given number of groups further along.  This lets the captures of one
+     * branch of a combined pattern be read with the group numbers of the
+     * pattern on its own.  The offset is reset by the next match.
+     */
+    void set_capture_offset(size_t offset)
+    {
+        this->md_capture_offset = offset;
+    }
+
     size_t capture_size(size_t index) const
     {
+        if (index > 0) {
+            index += this->md_capture_offset;
+        }
+
         const auto start = this->md_ovector[(index * 2)];
         const auto stop = this->md_ovector[(index * 2) + 1];
 
@@ -88,17 +105,11 @@ public:
 
     std::optional<string_fragment> operator[](size_t index) const
     {
-        if (index >= this->md_capture_end) {
-            return std::nullopt;
+        if (index > 0) {
+            index += this->md_capture_offset;
         }
 
-        auto start = this->md_ovector[(index * 2)];
-        auto stop = this->md_ovector[(index * 2) + 1];
-        if (start == PCRE2_UNSET || stop == PCRE2_UNSET) {
-            return std::nullopt;
-        }
-
-        return this->md_input.i_string.sub_range(start, stop);
+        return this->capture_at(index);
     }
 
     template<typename T, std::size_t N>
@@ -121,6 +132,21 @@ private:
 
     match_data() = default;
 
+    std::optional<string_fragment> capture_at(size_t index) const
+    {
+        if (index >= this->md_capture_end) {
+            return std::nullopt;
+        }
+
+        auto start = this->md_ovector[(index * 2)];
+        auto stop = this->md_ovector[(index * 2) + 1];
+        if (start == PCRE2_UNSET || stop == PCRE2_UNSET) {
+            return std::nullopt;
+        }
+
+        return this->md_input.i_string.sub_range(start, stop);
+    }
+
     explicit match_data(auto_mem<pcre2_match_data> dat)
         : md_data(std::move(dat)),
           md_ovector(pcre2_get_ovector_pointer(this->md_data.in())),
@@ -134,6 +160,7 @@ private:
     PCRE2_SIZE* md_ovector{nullptr};
     uint32_t md_ovector_count{0};
     size_t md_capture_end{0};
+    size_t md_capture_offset{0};
 };
 
 class matcher {
@@ -226,6 +253,39 @@ struct compile_error {
     std::string get_message() const;
 };
 
+/**
+ * Literal strings, at least one of which has to appear in a subject for a
+ * pattern to match.  Checking for them with memmem(3) is much cheaper than
+ * running pcre2_match() on subjects that cannot match.
+ */
+class prefilter {
+public:
+    /**
+     * Analyze the given pattern to find the literals that are required for
+     * a match.  The analysis is conservative, the result is empty if the
+     * pattern uses a construct that is not understood.
+     */
+    static prefilter from_pattern(string_fragment pattern, uint32_t options);
+
+    bool empty() const { return this->pf_literals.empty(); }
+
+    const std::vector<std::string>& get_literals() const
+    {
+        return this->pf_literals;
+    }
+
+    bool is_caseless() const { return this->pf_caseless; }
+
+    /**
+     * @return False if the subject definitely does not match the pattern.
+     */
+    bool might_match(string_fragment sf) const;
+
+private:
+    std::vector<std::string> pf_literals;
+    bool pf_caseless{false};
+};
+
 class code {
 public:
     class named_capture {
@@ -266,6 +326,28 @@ public:
     static Result<code, compile_error> from(string_fragment sf,
                                             int options = 0);
 
+    /**
+     * While an instance of this guard is alive, patterns compiled on the
+     * current thread are not JIT-compiled right away.  Instead, a pattern
+     * is JIT-compiled the first time it has been used for JIT_THRESHOLD
+     * matches.  This keeps the cost of loading a large number of patterns
+     * down when most of them will never be used, like the patterns for
+     * the log formats.
+     */
+    class deferred_jit_guard {
+    public:
+        deferred_jit_guard();
+        ~deferred_jit_guard();
+
+        deferred_jit_guard(const deferred_jit_guard&) = delete;
+        deferred_jit_guard& operator=(const deferred_jit_guard&) = delete;
+
+    private:
+        bool djg_prev;
+    };
+
+    static constexpr uint32_t JIT_THRESHOLD = 64;
+
     template<typename T, std::size_t N>
     static code from_const(const T (&str)[N], int options = 0)
     {
@@ -314,21 +396,61 @@ public:
                                       std::move(this->p_pattern));
     }
 
-    code(auto_mem<pcre2_code> code, std::string pattern)
-        : p_code(std::move(code)), p_pattern(std::move(pattern)),
-          p_match_proto(this->create_match_data())
-    {
-    }
+    const prefilter& get_prefilter() const { return this->p_prefilter; }
+
+    /**
+     * A cheap check of a whole subject against the minimum length, the
+     * possible first characters of an anchored pattern, and the prefilter.
+     *
+     * @return False if the subject definitely does not match.
+     */
+    bool might_match(string_fragment in) const;
+
+    /**
+     * @return True if the pattern can only match at the start of a subject.
+     */
+    bool is_anchored() const { return this->p_anchored; }
+
+    /**
+     * @return True if the pattern contains a back reference.
+     */
+    bool has_back_references() const;
+
+    /**
+     * @return True if the pattern has been JIT-compiled.
+     */
+    bool is_jit_compiled() const;
+
+    code(auto_mem<pcre2_code> code, std::string pattern);
 
 private:
     friend matcher;
     friend match_data;
 
+    struct deferred_jit {
+        ~deferred_jit();
+
+        std::atomic<uint32_t> dj_match_count{0};
+        std::atomic<pcre2_code*> dj_code{nullptr};
+    };
+
     static code from_const(string_fragment sf, int options);
 
+    /**
+     * @return The compiled pattern to pass to pcre2_match().  If JIT
+     * compilation was deferred, this will be the JIT-compiled copy once
+     * it is ready.
+     */
+    const pcre2_code* get_match_code() const;
+
     auto_mem<pcre2_code> p_code;
+    std::shared_ptr<deferred_jit> p_deferred_jit;
     std::string p_pattern;
     match_data p_match_proto;
+    prefilter p_prefilter;
+    bool p_anchored{false};
+    uint32_t p_min_length{0};
+    std::optional<std::array<uint8_t, 32>> p_first_bitmap;
 };
 
 template<typename T, std::size_t N>
@@ -339,7 +461,9 @@ match_data::operator[](const T (&name)[N]) const
         this->md_code->p_code.in(),
         reinterpret_cast<const unsigned char*>(name));
 
-    return this->operator[](index);
+    // The number comes from the pattern that matched, so it is not
+    // adjusted by the capture offset.
+    return this->capture_at(index);
 }
 
 template<uint32_t Options, typename F>
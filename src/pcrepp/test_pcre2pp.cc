@@ -67,6 +67,38 @@ TEST_CASE("marks")
     }
 }
 
+TEST_CASE("capture offset")
+{
+    auto code = lnav::pcre2pp::code::from_const(
+        "^(?:(?<a>a)(b)(*MARK:0)|(?<c>c)(d)(*MARK:1))$", PCRE2_DUPNAMES);
+    auto md = lnav::pcre2pp::match_data::unitialized();
+
+    auto match_res = code.capture_from(string_fragment::from_const("cd"))
+                         .into(md)
+                         .matches(PCRE2_NO_UTF_CHECK)
+                         .ignore_error();
+    REQUIRE(match_res.has_value());
+    CHECK(md.get_mark() == "1");
+
+    md.set_capture_offset(2);
+    CHECK(md[0] == "cd");
+    CHECK(md[1] == "c");
+    CHECK(md[2] == "d");
+    CHECK(md.capture_size(2) == 1);
+    CHECK_FALSE(md[3].has_value());
+    // Names are resolved against the whole pattern.
+    CHECK(md["c"] == "c");
+
+    // The next match resets the offset.
+    match_res = code.capture_from(string_fragment::from_const("ab"))
+                    .into(md)
+                    .matches(PCRE2_NO_UTF_CHECK)
+                    .ignore_error();
+    REQUIRE(match_res.has_value());
+    CHECK(md[1] == "a");
+    CHECK(md[2] == "b");
+}
+
 TEST_CASE("bad pattern")
 {
     auto compile_res
@@ -325,3 +357,136 @@ TEST_CASE("anchored")
     CHECK_FALSE(re.find_in(sub2).ignore_error().has_value());
     CHECK_FALSE(re.find_in(sub3).ignore_error().has_value());
 }
+
+TEST_CASE("prefilter")
+{
+    using lnav::pcre2pp::prefilter;
+
+    static const auto literals_for
+        = [](const char* pattern, uint32_t options = 0) {
+              return prefilter::from_pattern(
+                         string_fragment::from_c_str(pattern), options)
+                  .get_literals();
+          };
+
+    CHECK(literals_for("abc") == std::vector<std::string>{"abc"});
+    CHECK(literals_for("req-[0-9]+ failed")
+          == std::vector<std::string>{" failed"});
+    CHECK(literals_for("colou?r") == std::vector<std::string>{"colo"});
+    CHECK(literals_for("ab+cd") == std::vector<std::string>{"ab"});
+    CHECK(literals_for("a\\.b\\.c") == std::vector<std::string>{"a.b.c"});
+    CHECK(literals_for("foo(bar)?baz") == std::vector<std::string>{"foo"});
+    CHECK(literals_for("error|warn")
+          == std::vector<std::string>{"error", "warn"});
+    CHECK(literals_for("Error", PCRE2_CASELESS)
+          == std::vector<std::string>{"error"});
+    CHECK(literals_for("a.b", PCRE2_LITERAL)
+          == std::vector<std::string>{"a.b"});
+    CHECK(literals_for("foo|.*").empty());
+    CHECK(literals_for("(?i)foo").empty());
+    CHECK(literals_for("(*UTF)foo").empty());
+    CHECK(literals_for("\\Qfoo\\E").empty());
+    CHECK(literals_for("foo bar", PCRE2_EXTENDED).empty());
+    CHECK(literals_for("a{2}") == std::vector<std::string>{});
+    CHECK(literals_for("ab{0,3}cd") == std::vector<std::string>{"cd"});
+    CHECK(literals_for("\\d+ms") == std::vector<std::string>{"ms"});
+    CHECK(literals_for("disk", PCRE2_CASELESS)
+          == std::vector<std::string>{"di"});
+
+    auto re = lnav::pcre2pp::code::from_const("(?:GET|POST) /api");
+    CHECK(re.get_prefilter().get_literals()
+          == std::vector<std::string>{" /api"});
+    CHECK(re.find_in(string_fragment::from_const("POST /api/v1"))
+              .ignore_error()
+              .has_value());
+    CHECK_FALSE(re.find_in(string_fragment::from_const("POST /web/v1"))
+                    .ignore_error()
+                    .has_value());
+
+    auto ci_re = lnav::pcre2pp::code::from_const("timeout", PCRE2_CASELESS);
+    CHECK(ci_re.find_in(string_fragment::from_const("read TimeOut!"))
+              .ignore_error()
+              .has_value());
+    CHECK_FALSE(ci_re.find_in(string_fragment::from_const("read time out"))
+                    .ignore_error()
+                    .has_value());
+}
+
+TEST_CASE("might_match")
+{
+    auto re = lnav::pcre2pp::code::from_const(
+        "^\\[(?<timestamp>\\d{4}-\\d{2}-\\d{2})\\] (?<body>.*)$");
+
+    CHECK(re.might_match(string_fragment::from_const("[2024-01-01] hello")));
+    CHECK_FALSE(
+        re.might_match(string_fragment::from_const("2024-01-01 hello world")));
+    CHECK_FALSE(re.might_match(string_fragment::from_const("[2024]")));
+
+    auto unanchored = lnav::pcre2pp::code::from_const("\\d+");
+    CHECK(unanchored.might_match(string_fragment::from_const("abc 123")));
+
+    CHECK(re.is_anchored());
+    CHECK_FALSE(unanchored.is_anchored());
+    CHECK_FALSE(re.has_back_references());
+
+    auto backref = lnav::pcre2pp::code::from_const("^(\\w+) \\1$");
+    CHECK(backref.has_back_references());
+}
+
+TEST_CASE("might_match first character")
+{
+    // The subjects are long enough and have the required literal, so only
+    // the check of the first character can reject them.
+    auto fixed = lnav::pcre2pp::code::from_const("^abc");
+
+    CHECK(fixed.might_match(string_fragment::from_const("abc")));
+    CHECK_FALSE(fixed.might_match(string_fragment::from_const("xabc")));
+
+    auto caseless = lnav::pcre2pp::code::from_const("(?i)^abc");
+
+    CHECK(caseless.might_match(string_fragment::from_const("ABC")));
+    CHECK_FALSE(caseless.might_match(string_fragment::from_const("xabc")));
+
+    auto alts = lnav::pcre2pp::code::from_const("^(?:a|b)cd");
+
+    CHECK(alts.might_match(string_fragment::from_const("acd")));
+    CHECK(alts.might_match(string_fragment::from_const("bcd")));
+    CHECK_FALSE(alts.might_match(string_fragment::from_const("xbcd")));
+
+    auto unanchored = lnav::pcre2pp::code::from_const("abc");
+
+    CHECK(unanchored.might_match(string_fragment::from_const("xabc")));
+}
+
+TEST_CASE("deferred_jit")
+{
+    auto eager = lnav::pcre2pp::code::from_const("(\\d+)-(\\w+)");
+    std::optional<lnav::pcre2pp::code> lazy;
+
+    {
+        lnav::pcre2pp::code::deferred_jit_guard djg;
+
+        lazy = lnav::pcre2pp::code::from_const("(\\d+)-(\\w+)");
+    }
+
+    auto after = lnav::pcre2pp::code::from_const("(\\d+)-(\\w+)");
+    auto jit_available = eager.is_jit_compiled();
+
+    CHECK_FALSE(lazy->is_jit_compiled());
+    CHECK(after.is_jit_compiled() == jit_available);
+
+    auto input = string_fragment::from_const("abc 123-def");
+    for (uint32_t lpc = 0; lpc < lnav::pcre2pp::code::JIT_THRESHOLD * 2;
+         lpc++)
+    {
+        auto md = lazy->create_match_data();
+        auto match_res
+            = lazy->capture_from(input).into(md).matches().ignore_error();
+
+        REQUIRE(match_res.has_value());
+        CHECK(md[1]->to_string() == "123");
+        CHECK(md[2]->to_string() == "def");
+        CHECK(md.leading().to_string() == "abc ");
+    }
+    CHECK(lazy->is_jit_compiled() == jit_available);
+}
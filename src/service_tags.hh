@@ -39,6 +39,7 @@ struct curl_streamer_t {};
 struct remote_tailer_t {};
 struct url_handler_t {};
 struct background_t {};
+struct file_watcher_t {};
 
 }  // namespace services
 
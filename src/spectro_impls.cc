@@ -113,6 +113,142 @@ public:
     std::vector<vis_line_t> fss_lines;
 };
 
+namespace {
+
+using value_cell = lnav::log::column_cache::cell;
+
+std::optional<value_cell>
+numeric_value_in(const logline_value_vector& values, intern_string_t colname)
+{
+    auto lv_iter = find_if(values.lvv_values.begin(),
+                           values.lvv_values.end(),
+                           logline_value_name_cmp(&colname));
+
+    if (lv_iter == values.lvv_values.end()) {
+        return std::nullopt;
+    }
+
+    value_cell retval;
+    switch (lv_iter->lv_meta.lvm_kind) {
+        case value_kind_t::VALUE_FLOAT:
+            retval.c_kind = lnav::log::column_cache::cell_kind::real;
+            retval.c_real = lv_iter->lv_value.d;
+            break;
+        case value_kind_t::VALUE_INTEGER:
+            retval.c_kind = lnav::log::column_cache::cell_kind::integer;
+            retval.c_integer = lv_iter->lv_value.i;
+            break;
+        default:
+            return std::nullopt;
+    }
+
+    return retval;
+}
+
+/**
+ * Get the numeric value of a column in a message, using the file's column
+ * cache to avoid reading and parsing the message again on a redraw.
+ */
+std::optional<value_cell>
+numeric_value_for(const logline_window::logmsg_info& msg_info,
+                  intern_string_t colname)
+{
+    auto& cache = msg_info.get_file_ptr()->get_column_cache();
+    auto cell_opt = cache.lookup(msg_info.get_file_line_number(), colname);
+
+    if (cell_opt) {
+        if (!cell_opt->is_numeric()) {
+            return std::nullopt;
+        }
+        return cell_opt;
+    }
+
+    // Loading the values also stores them in the cache.
+    return numeric_value_in(msg_info.get_values(), colname);
+}
+
+/**
+ * Fill in a row from the time rollups of the files instead of visiting
+ * each message.  This is only possible when every message in the range
+ * would be visited, none of them are marked, and the range lines up with
+ * the rollup buckets.  The buckets must also still have an exact count of
+ * each value, otherwise the values would land in different columns than
+ * they do when the messages are visited.
+ *
+ * @return True if the row was filled in.
+ */
+bool
+spectro_row_from_rollups(spectrogram_request& sr,
+                         intern_string_t colname,
+                         vis_line_t begin_line,
+                         vis_line_t end_line,
+                         spectrogram_row& row_out)
+{
+    auto& lss = lnav_data.ld_log_source;
+    if (lss.get_filtered_count() > 0) {
+        return false;
+    }
+
+    const auto& user_marks = lnav_data.ld_views[LNV_LOG]
+                                 .get_bookmarks()[&textview_curses::BM_USER];
+    auto marks_range = user_marks.equal_range(begin_line, end_line);
+    if (marks_range.first != marks_range.second) {
+        return false;
+    }
+
+    using file_bucket = std::pair<const lnav::time_rollup::summary*,
+                                  spectrogram_row::value_type>;
+    std::vector<file_bucket> buckets;
+    for (const auto& ld : lss) {
+        const auto* lf = ld->get_file_ptr();
+        if (lf == nullptr || !ld->is_visible()
+            || lf->stats_for_value(colname) == nullptr)
+        {
+            continue;
+        }
+
+        const auto* rollup = lf->rollup_for_value(colname);
+        if (rollup == nullptr
+            || !rollup->can_summarize(sr.sr_begin_time, sr.sr_end_time))
+        {
+            return false;
+        }
+
+        auto vt = spectrogram_row::value_type::integer;
+        for (const auto& meta : lf->get_format_ptr()->get_value_metadata()) {
+            if (meta.lvm_name == colname
+                && meta.lvm_kind == value_kind_t::VALUE_FLOAT)
+            {
+                vt = spectrogram_row::value_type::real;
+                break;
+            }
+        }
+
+        auto exact = true;
+        rollup->for_each_finest(
+            sr.sr_begin_time,
+            sr.sr_end_time,
+            [&buckets, &exact, vt](const auto& summ) {
+                exact = exact && summ.s_exact;
+                buckets.emplace_back(&summ, vt);
+            });
+        if (!exact) {
+            return false;
+        }
+    }
+
+    for (const auto& [summ, vt] : buckets) {
+        for (const auto& cent : summ->s_centroids) {
+            row_out.add_values(sr, vt, cent.c_mean, cent.c_weight);
+            row_out.sr_tdigest.insert(cent.c_mean, cent.c_weight);
+        }
+    }
+
+    return true;
+}
+
+}  // namespace
+
 log_spectro_value_source::log_spectro_value_source(intern_string_t colname)
     : lsvs_colname(colname)
 {
@@ -208,37 +344,36 @@ log_spectro_value_source::spectro_row(spectrogram_request& sr,
     auto end_line = lss.find_from_time(timeval{to_time_t(sr.sr_end_time), 0})
                         .value_or(vis_line_t(lss.text_line_count()));
 
-    auto win = lss.window_at(begin_line, end_line);
-    for (const auto& msg_info : *win) {
-        const auto& ll = msg_info.get_logline();
-        if (ll.get_time<std::chrono::microseconds>() >= sr.sr_end_time) {
-            break;
-        }
+    if (spectro_row_from_rollups(
+            sr, this->lsvs_colname, begin_line, end_line, row_out))
+    {
+        log_debug("spectrogram row filled from rollups");
+    } else {
+        auto win = lss.window_at(begin_line, end_line);
+        for (const auto& msg_info : *win) {
+            const auto& ll = msg_info.get_logline();
+            if (ll.get_time<std::chrono::microseconds>() >= sr.sr_end_time) {
+                break;
+            }
+
+            auto cell_opt = numeric_value_for(msg_info, this->lsvs_colname);
+            if (!cell_opt) {
+                continue;
+            }
 
-        const auto& values = msg_info.get_values();
-        auto lv_iter = find_if(values.lvv_values.begin(),
-                               values.lvv_values.end(),
-                               logline_value_name_cmp(&this->lsvs_colname));
-
-        if (lv_iter != values.lvv_values.end()) {
-            switch (lv_iter->lv_meta.lvm_kind) {
-                case value_kind_t::VALUE_FLOAT:
-                    row_out.add_value(sr,
-                                      spectrogram_row::value_type::real,
-                                      lv_iter->lv_value.d,
-                                      ll.is_marked());
-                    row_out.sr_tdigest.insert(lv_iter->lv_value.d);
-                    break;
-                case value_kind_t::VALUE_INTEGER: {
-                    row_out.add_value(sr,
-                                      spectrogram_row::value_type::integer,
-                                      lv_iter->lv_value.i,
-                                      ll.is_marked());
-                    row_out.sr_tdigest.insert(lv_iter->lv_value.i);
-                    break;
-                }
-                default:
-                    break;
+            if (cell_opt->c_kind == lnav::log::column_cache::cell_kind::real)
+            {
+                row_out.add_value(sr,
+                                  spectrogram_row::value_type::real,
+                                  cell_opt->c_real,
+                                  ll.is_marked());
+                row_out.sr_tdigest.insert(cell_opt->c_real);
+            } else {
+                row_out.add_value(sr,
+                                  spectrogram_row::value_type::integer,
+                                  cell_opt->c_integer,
+                                  ll.is_marked());
+                row_out.sr_tdigest.insert(cell_opt->c_integer);
             }
         }
     }
@@ -265,32 +400,14 @@ log_spectro_value_source::spectro_row(spectrogram_request& sr,
                 break;
             }
 
-            const auto& values = msg_info.get_values();
-            auto lv_iter = find_if(values.lvv_values.begin(),
-                                   values.lvv_values.end(),
-                                   logline_value_name_cmp(&this->lsvs_colname));
-
-            if (lv_iter != values.lvv_values.end()) {
-                switch (lv_iter->lv_meta.lvm_kind) {
-                    case value_kind_t::VALUE_FLOAT:
-                        if (range_min <= lv_iter->lv_value.d
-                            && lv_iter->lv_value.d < range_max)
-                        {
-                            retval->fss_lines.emplace_back(
-                                msg_info.get_vis_line());
-                        }
-                        break;
-                    case value_kind_t::VALUE_INTEGER:
-                        if (range_min <= lv_iter->lv_value.i
-                            && lv_iter->lv_value.i < range_max)
-                        {
-                            retval->fss_lines.emplace_back(
-                                msg_info.get_vis_line());
-                        }
-                        break;
-                    default:
-                        break;
-                }
+            auto cell_opt = numeric_value_for(msg_info, this->lsvs_colname);
+            if (!cell_opt) {
+                continue;
+            }
+
+            auto value = cell_opt->to_double();
+            if (range_min <= value && value < range_max) {
+                retval->fss_lines.emplace_back(msg_info.get_vis_line());
             }
         }
 
@@ -349,39 +466,25 @@ log_spectro_value_source::spectro_mark(textview_curses& tc,
             continue;
         }
 
-        values.clear();
-        lf->read_full_message(ll, values.lvv_sbr);
-        values.lvv_sbr.erase_ansi();
-        sa.clear();
-        format->annotate(lf.get(), cl, sa, values);
-
-        auto lv_iter = find_if(values.lvv_values.begin(),
-                               values.lvv_values.end(),
-                               logline_value_name_cmp(&this->lsvs_colname));
-
-        if (lv_iter != values.lvv_values.end()) {
-            switch (lv_iter->lv_meta.lvm_kind) {
-                case value_kind_t::VALUE_FLOAT:
-                    if (range_min <= lv_iter->lv_value.d
-                        && lv_iter->lv_value.d <= range_max)
-                    {
-                        log_tc.set_user_mark(&textview_curses::BM_USER,
-                                             curr_line,
-                                             op == mark_op_t::add);
-                    }
-                    break;
-                case value_kind_t::VALUE_INTEGER:
-                    if (range_min <= lv_iter->lv_value.i
-                        && lv_iter->lv_value.i <= range_max)
-                    {
-                        log_tc.set_user_mark(&textview_curses::BM_USER,
-                                             curr_line,
-                                             op == mark_op_t::add);
-                    }
-                    break;
-                default:
-                    break;
-            }
+        auto& cache = lf->get_column_cache();
+        auto cell_opt = cache.lookup(cl, this->lsvs_colname);
+        if (!cell_opt) {
+            values.clear();
+            lf->read_full_message(ll, values.lvv_sbr);
+            values.lvv_sbr.erase_ansi();
+            sa.clear();
+            format->annotate(lf.get(), cl, sa, values);
+            cache.store(cl, values);
+            cell_opt = numeric_value_in(values, this->lsvs_colname);
+        }
+        if (!cell_opt || !cell_opt->is_numeric()) {
+            continue;
+        }
+
+        auto value = cell_opt->to_double();
+        if (range_min <= value && value <= range_max) {
+            log_tc.set_user_mark(
+                &textview_curses::BM_USER, curr_line, op == mark_op_t::add);
         }
     }
 }
@@ -161,7 +161,7 @@ spectrogram_source::text_handle_mouse(
     int closest_distance = INT_MAX;
 
     for (int lpc = 0; lpc <= (int) s_row.sr_width; lpc++) {
-        int col_value = s_row.sr_values[lpc].rb_counter;
+        auto col_value = s_row.sr_values[lpc].rb_counter;
 
         if (col_value == 0) {
             continue;
@@ -405,7 +405,7 @@ spectrogram_source::chart_attrs_for_line(textview_curses& tc,
     const auto& s_row = this->load_row(tc, row);
 
     for (int lpc = 0; lpc <= (int) s_row.sr_width; lpc++) {
-        int col_value = s_row.sr_values[lpc].rb_counter;
+        auto col_value = s_row.sr_values[lpc].rb_counter;
 
         if (col_value == 0) {
             continue;
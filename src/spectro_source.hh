@@ -32,6 +32,7 @@
 #ifndef spectro_source_hh
 #define spectro_source_hh
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -76,7 +77,7 @@ struct spectrogram_row {
     spectrogram_row(const spectrogram_row&) = delete;
 
     struct row_bucket {
-        int rb_counter{0};
+        int64_t rb_counter{0};
         int rb_marks{0};
     };
 
@@ -112,6 +113,25 @@ struct spectrogram_row {
         }
     }
 
+    /**
+     * Add a group of unmarked values that were summarized as a single
+     * value, like a centroid from a time rollup.
+     */
+    void add_values(spectrogram_request& sr,
+                    value_type vt,
+                    double value,
+                    int64_t count)
+    {
+        if (vt != value_type::integer) {
+            this->sr_value_type = vt;
+        }
+        long index = std::floor((value - sr.sr_bounds.sb_min_value_out)
+                                / sr.sr_column_size);
+
+        index = std::clamp(index, 0L, (long) this->sr_values.size() - 1);
+        this->sr_values[index].rb_counter += count;
+    }
+
     std::optional<size_t> nearest_column(size_t current) const;
 };
 
@@ -56,8 +56,8 @@ read_err_pipe(auto_fd& err, std::string& eq)
 int
 main(int argc, char* const* argv)
 {
-    if (argc != 3) {
-        fprintf(stderr, "usage: %s <cmd> <path>\n", argv[0]);
+    if (argc != 3 && argc != 4) {
+        fprintf(stderr, "usage: %s <cmd> <path> [<filter>]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -124,6 +124,20 @@ main(int argc, char* const* argv)
     if (cmd == "open") {
         send_packet(
             to_child.get(), TPT_OPEN_PATH, TPPT_STRING, argv[2], TPPT_DONE);
+    } else if (cmd == "tail") {
+        const char* filter = argc == 4 ? argv[3] : "";
+
+        send_packet(to_child.get(),
+                    TPT_OPEN_PATH,
+                    TPPT_STRING,
+                    argv[2],
+                    TPPT_INT64,
+                    int64_t{TOO_DEFLATE},
+                    TPPT_INT64,
+                    int64_t{0},
+                    TPPT_STRING,
+                    filter,
+                    TPPT_DONE);
     } else if (cmd == "preview") {
         send_packet(to_child.get(),
                     TPT_LOAD_PREVIEW,
@@ -140,7 +154,9 @@ main(int argc, char* const* argv)
         exit(EXIT_FAILURE);
     }
 
-    close(to_child.get());
+    if (cmd != "tail") {
+        close(to_child.get());
+    }
 
     bool done = false;
     while (!done) {
@@ -178,6 +194,15 @@ main(int argc, char* const* argv)
                        pob.pob_offset,
                        pob.pob_length);
 
+                if (cmd == "tail") {
+                    send_packet(to_child.get(),
+                                TPT_NEED_BLOCK,
+                                TPPT_STRING,
+                                pob.pob_path.c_str(),
+                                TPPT_DONE);
+                    return;
+                }
+
                 auto remote_path = std::filesystem::absolute(
                                        std::filesystem::path(pob.pob_path))
                                        .relative_path();
@@ -232,6 +257,13 @@ main(int argc, char* const* argv)
 #endif
             },
             [&](const tailer::packet_tail_block& ptb) {
+                printf("tail block: %s %lld %zu%s\n%.*s",
+                       ptb.ptb_path.c_str(),
+                       ptb.ptb_offset,
+                       ptb.ptb_bits.size(),
+                       ptb.ptb_deflated ? " (deflated)" : "",
+                       (int) ptb.ptb_bits.size(),
+                       ptb.ptb_bits.data());
 #if 0
                 //printf("got a tail: %s %lld %ld\n", ptb.ptb_path.c_str(),
                 //       ptb.ptb_offset, ptb.ptb_bits.size());
@@ -253,7 +285,10 @@ main(int argc, char* const* argv)
 #endif
             },
             [&](const tailer::packet_synced& ps) {
-
+                if (cmd == "tail" && ps.ps_path == argv[2]) {
+                    printf("synced: %s\n", ps.ps_path.c_str());
+                    to_child.reset();
+                }
             },
             [&](const tailer::packet_link& pl) {
                 printf("link value: %s -> %s\n",
@@ -59,8 +59,31 @@ typedef enum {
     TPT_COMPLETE_PATH,
     TPT_POSSIBLE_PATH,
     TPT_ANNOUNCE,
+    TPT_TAIL_BLOCK_DEFLATE,
 } tailer_packet_type_t;
 
+/**
+ * The features supported by a tailer, sent as an optional TPPT_INT64 after
+ * the uname in the TPT_ANNOUNCE packet.  Older tailers do not send the
+ * value, so a client must not use any of these features until it has
+ * seen them announced.
+ */
+typedef enum {
+    /**
+     * TPT_OPEN_PATH packets can carry the TOO_* options, a lower bound on
+     * the modification time of files to transfer, and a filter pattern.
+     */
+    TF_OPEN_OPTIONS = 1 << 0,
+    /** Tail blocks can be compressed and sent as TPT_TAIL_BLOCK_DEFLATE. */
+    TF_DEFLATE = 1 << 1,
+} tailer_feature_t;
+
+/** The options that can be sent in a TPT_OPEN_PATH packet. */
+typedef enum {
+    /** Compress tail blocks when that makes them smaller. */
+    TOO_DEFLATE = 1 << 0,
+} tailer_open_option_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -534,12 +534,12 @@ tailer::looper::host_tailer::open_remote_path(const std::string& path,
 {
     this->ht_state.match(
         [&](connected& conn) {
+            // The open is deferred until the tailer has announced the
+            // features it supports.
+            if (conn.c_announced) {
+                this->send_open_path(conn, path, loo);
+            }
             conn.c_desired_paths[path] = std::move(loo);
-            send_packet(conn.ht_to_child.get(),
-                        TPT_OPEN_PATH,
-                        TPPT_STRING,
-                        path.c_str(),
-                        TPPT_DONE);
         },
         [&](const disconnected& d) {
             log_warning("disconnected from host, cannot tail: %s",
@@ -550,6 +550,55 @@ tailer::looper::host_tailer::open_remote_path(const std::string& path,
         });
 }
 
+void
+tailer::looper::host_tailer::send_open_path(
+    const connected& conn,
+    const std::string& path,
+    const logfile_open_options_base& loo) const
+{
+    if (!(conn.c_features & TF_OPEN_OPTIONS)) {
+        send_packet(conn.ht_to_child.get(),
+                    TPT_OPEN_PATH,
+                    TPPT_STRING,
+                    path.c_str(),
+                    TPPT_DONE);
+        return;
+    }
+
+    const auto& cfg = injector::get<const tailer::config&>();
+    int64_t options = 0;
+    int64_t since = 0;
+    std::string filter;
+
+    if (conn.c_features & TF_DEFLATE) {
+        options |= TOO_DEFLATE;
+    }
+    if (loo.loo_time_range.has_lower_bound()) {
+        since = std::chrono::duration_cast<std::chrono::seconds>(
+                    loo.loo_time_range.tr_begin)
+                    .count();
+    }
+    auto rp = humanize::network::path::from_str(this->ht_netloc);
+    if (rp) {
+        auto filter_iter = cfg.c_filters.find(rp->p_locality.l_hostname);
+        if (filter_iter != cfg.c_filters.end()) {
+            filter = filter_iter->second;
+        }
+    }
+
+    send_packet(conn.ht_to_child.get(),
+                TPT_OPEN_PATH,
+                TPPT_STRING,
+                path.c_str(),
+                TPPT_INT64,
+                options,
+                TPPT_INT64,
+                since,
+                TPPT_STRING,
+                filter.c_str(),
+                TPPT_DONE);
+}
+
 void
 tailer::looper::host_tailer::load_preview(int64_t id, const std::string& path)
 {
@@ -651,6 +700,17 @@ tailer::looper::host_tailer::loop_body()
                 update_tailer_description(
                     this->ht_netloc, conn.c_desired_paths, pa.pa_uname);
                 this->ht_uname = pa.pa_uname;
+                if (!conn.c_announced) {
+                    log_info("tailer(%s): features=%llx",
+                             this->ht_netloc.c_str(),
+                             pa.pa_features);
+                    conn.c_announced = true;
+                    conn.c_features = pa.pa_features;
+                    for (const auto& desired_pair : conn.c_desired_paths) {
+                        this->send_open_path(
+                            conn, desired_pair.first, desired_pair.second);
+                    }
+                }
                 return std::move(this->ht_state);
             },
             [&](const tailer::packet_log& pl) {
@@ -885,9 +945,10 @@ tailer::looper::host_tailer::loop_body()
                                        .relative_path();
                 auto local_path = this->ht_local_path / remote_path;
 
-                log_debug("writing tail to: %lld/%ld %s",
+                log_debug("writing tail to: %lld/%ld%s %s",
                           ptb.ptb_offset,
                           ptb.ptb_bits.size(),
+                          ptb.ptb_deflated ? " (deflated)" : "",
                           local_path.c_str());
                 std::filesystem::create_directories(local_path.parent_path());
                 auto create_res = lnav::filesystem::create_file(
@@ -46,6 +46,8 @@ struct config {
         {"BatchMode", "yes"},
         {"ConnectTimeout", "10"},
     };
+    /** Hostname to a regex for the lines the tailer should transfer. */
+    std::map<std::string, std::string> c_filters{};
 };
 
 }  // namespace tailer
@@ -114,10 +114,18 @@ private:
             std::map<std::string, logfile_open_options_base> c_child_paths;
             std::set<std::string> c_synced_child_paths;
             bool c_initial_sync_done{false};
+            /** Set once the tailer has sent its TPT_ANNOUNCE packet. */
+            bool c_announced{false};
+            /** The tailer_feature_t flags the tailer announced. */
+            int64_t c_features{0};
 
             auto_pid<process_state::finished> close() &&;
         };
 
+        void send_open_path(const connected& conn,
+                            const std::string& path,
+                            const logfile_open_options_base& loo) const;
+
         struct disconnected {};
         struct synced {};
 
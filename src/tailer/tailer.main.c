@@ -44,6 +44,8 @@
 #include <sys/utsname.h>
 #include <ctype.h>
 #include <stdint.h>
+#include <regex.h>
+#include <zlib.h>
 #endif
 
 #include "sha-256.h"
@@ -141,6 +143,12 @@ struct client_path_state {
     int64_t cps_client_file_size;
     client_state_t cps_client_state;
     struct list cps_children;
+    /* The offset in the client's copy when only filtered lines are sent. */
+    int64_t cps_client_output_offset;
+    /* The TOO_* options, lower time bound, and filter sent by the client. */
+    int64_t cps_options;
+    int64_t cps_since;
+    regex_t *cps_filter;
 };
 
 struct client_path_state *create_client_path_state(const char *path)
@@ -154,6 +162,10 @@ struct client_path_state *create_client_path_state(const char *path)
     retval->cps_client_file_size = 0;
     retval->cps_client_state = CS_INIT;
     list_init(&retval->cps_children);
+    retval->cps_client_output_offset = 0;
+    retval->cps_options = 0;
+    retval->cps_since = 0;
+    retval->cps_filter = NULL;
     return retval;
 }
 
@@ -173,6 +185,10 @@ void delete_client_path_state(struct client_path_state *cps)
 {
     free(cps->cps_path);
     delete_client_path_list(&cps->cps_children);
+    if (cps->cps_filter != NULL) {
+        regfree(cps->cps_filter);
+        free(cps->cps_filter);
+    }
     free(cps);
 }
 
@@ -220,6 +236,7 @@ void set_client_path_state_error(struct client_path_state *cps, const char *op)
     }
     cps->cps_last_path_state = PS_ERROR;
     cps->cps_client_file_offset = -1;
+    cps->cps_client_output_offset = 0;
     cps->cps_client_state = CS_INIT;
     delete_client_path_list(&cps->cps_children);
 }
@@ -325,6 +342,18 @@ static char *readstr(recv_state_t *state, int sock)
     return retval;
 }
 
+static int readint64_content(recv_state_t *state, int sock, int64_t *i)
+{
+    *state = RS_PAYLOAD_CONTENT;
+    *state = readall(*state, sock, i, sizeof(*i));
+    if (*state == RS_ERROR) {
+        fprintf(stderr, "error: unable to read int64\n");
+        return -1;
+    }
+
+    return 0;
+}
+
 static int readint64(recv_state_t *state, int sock, int64_t *i)
 {
     tailer_packet_payload_type_t payload_type = read_payload_type(state, sock);
@@ -334,14 +363,7 @@ static int readint64(recv_state_t *state, int sock, int64_t *i)
         return -1;
     }
 
-    *state = RS_PAYLOAD_CONTENT;
-    *state = readall(*state, sock, i, sizeof(*i));
-    if (*state == -1) {
-        fprintf(stderr, "error: unable to read int64\n");
-        return -1;
-    }
-
-    return 0;
+    return readint64_content(state, sock, i);
 }
 
 struct list client_path_list;
@@ -388,6 +410,114 @@ void send_preview_data(int64_t id, const char *path, int32_t len, const char *bi
                 TPPT_DONE);
 }
 
+/* Blocks smaller than this are not worth compressing. */
+#define MIN_DEFLATE_SIZE 256
+
+void send_tail_block(const struct client_path_state *root_cps,
+                     const struct client_path_state *cps,
+                     int64_t mtime,
+                     int64_t offset,
+                     const unsigned char *bits,
+                     int32_t len)
+{
+    if ((root_cps->cps_options & TOO_DEFLATE) && len >= MIN_DEFLATE_SIZE) {
+        static unsigned char deflate_buffer[4 * 1024 * 1024];
+        uLongf deflate_len = len - 1;
+
+        /*
+         * The output is limited to less than the input so the block is
+         * sent as-is if compressing it does not help.
+         */
+        if (compress2(deflate_buffer,
+                      &deflate_len,
+                      bits,
+                      len,
+                      Z_BEST_SPEED) == Z_OK) {
+            send_packet(STDOUT_FILENO,
+                        TPT_TAIL_BLOCK_DEFLATE,
+                        TPPT_STRING, root_cps->cps_path,
+                        TPPT_STRING, cps->cps_path,
+                        TPPT_INT64, mtime,
+                        TPPT_INT64, offset,
+                        TPPT_INT64, (int64_t) len,
+                        TPPT_BITS, (int32_t) deflate_len, deflate_buffer,
+                        TPPT_DONE);
+            return;
+        }
+    }
+
+    send_packet(STDOUT_FILENO,
+                TPT_TAIL_BLOCK,
+                TPPT_STRING, root_cps->cps_path,
+                TPPT_STRING, cps->cps_path,
+                TPPT_INT64, mtime,
+                TPPT_INT64, offset,
+                TPPT_BITS, len, bits,
+                TPPT_DONE);
+}
+
+/*
+ * Send the lines in the buffer that match the root path's filter.  Only
+ * complete lines are consumed so that a line that is still being written
+ * is checked once it is done.  If the buffer is full and has no line
+ * endings, it is sent as-is.  The matching lines are moved to the front
+ * of the buffer.  The first block for a file is always sent, even if it
+ * is empty, so that the client's copy from a previous run is truncated.
+ *
+ * Returns the number of bytes of the file that were consumed.
+ */
+int32_t send_filtered_block(const struct client_path_state *root_cps,
+                            struct client_path_state *cps,
+                            int64_t mtime,
+                            unsigned char *buffer,
+                            int32_t len,
+                            int32_t capacity)
+{
+    int32_t consumed = len;
+    int32_t out_len = 0;
+    int32_t offset = 0;
+
+    while (consumed > 0 && buffer[consumed - 1] != '\n') {
+        consumed -= 1;
+    }
+    if (consumed == 0 && len == capacity) {
+        consumed = len;
+    }
+
+    while (offset < consumed) {
+        unsigned char *line_end = memchr(&buffer[offset], '\n', consumed - offset);
+        int32_t line_len = line_end == NULL ?
+            consumed - offset :
+            line_end - &buffer[offset] + 1;
+        int matched = 1;
+
+        if (line_end != NULL) {
+            *line_end = '\0';
+            matched = regexec(root_cps->cps_filter,
+                              (const char *) &buffer[offset],
+                              0, NULL, 0) == 0;
+            *line_end = '\n';
+        }
+        if (matched) {
+            memmove(&buffer[out_len], &buffer[offset], line_len);
+            out_len += line_len;
+        }
+        offset += line_len;
+    }
+
+    if (out_len > 0 || cps->cps_client_file_offset < 0) {
+        send_tail_block(root_cps,
+                        cps,
+                        mtime,
+                        cps->cps_client_output_offset,
+                        buffer,
+                        out_len);
+        cps->cps_client_output_offset += out_len;
+    }
+
+    return consumed;
+}
+
 int poll_paths(struct list *path_list, struct client_path_state *root_cps)
 {
     struct client_path_state *curr = (struct client_path_state *) path_list->l_head;
@@ -507,6 +637,16 @@ int poll_paths(struct list *path_list, struct client_path_state *root_cps)
 
             retval += poll_paths(&curr->cps_children, root_cps);
 
+            curr->cps_last_path_state = PS_OK;
+        } else if (S_ISREG(st.st_mode) && curr != root_cps &&
+                   curr->cps_client_file_offset < 0 &&
+                   st.st_mtime < root_cps->cps_since) {
+            // Nothing in the file can be inside the client's time range.
+            if (curr->cps_last_path_state == PS_UNKNOWN) {
+                fprintf(stderr,
+                        "info: skipping file modified before the time range: %s\n",
+                        curr->cps_path);
+            }
             curr->cps_last_path_state = PS_OK;
         } else if (S_ISREG(st.st_mode)) {
             switch (curr->cps_client_state) {
@@ -526,7 +666,8 @@ int poll_paths(struct list *path_list, struct client_path_state *root_cps)
                                 0 :
                                 curr->cps_client_file_offset;
                             int64_t nbytes = sizeof(buffer);
-                            if (curr->cps_client_state == CS_INIT) {
+                            if (curr->cps_client_state == CS_INIT &&
+                                root_cps->cps_filter == NULL) {
                                 if (curr->cps_client_file_size == 0) {
                                     // initial state, haven't heard from client yet.
                                     nbytes = 32 * 1024;
@@ -542,6 +683,37 @@ int poll_paths(struct list *path_list, struct client_path_state *root_cps)
 
                             if (bytes_read == -1) {
                                 set_client_path_state_error(curr, "pread");
+                            } else if (root_cps->cps_filter != NULL) {
+                                // The client's copy only has the filtered
+                                // lines, so there is nothing to offer.
+                                int32_t consumed = send_filtered_block(
+                                    root_cps,
+                                    curr,
+                                    (int64_t) st.st_mtime,
+                                    buffer,
+                                    bytes_read,
+                                    sizeof(buffer));
+
+                                if (curr->cps_client_file_offset < 0) {
+                                    curr->cps_client_file_offset = 0;
+                                }
+                                if (consumed > 0) {
+                                    curr->cps_client_file_offset += consumed;
+                                    curr->cps_client_state = CS_TAILING;
+                                } else {
+                                    // Only a partial line is left, wait for
+                                    // the rest of it.
+                                    if (curr->cps_client_state != CS_SYNCED) {
+                                        send_packet(STDOUT_FILENO,
+                                                    TPT_SYNCED,
+                                                    TPPT_STRING, root_cps->cps_path,
+                                                    TPPT_STRING, curr->cps_path,
+                                                    TPPT_DONE);
+                                        curr->cps_client_state = CS_SYNCED;
+                                    }
+                                    close(fd);
+                                    break;
+                                }
                             } else if (curr->cps_client_state == CS_INIT &&
                                        (curr->cps_client_file_offset < 0 ||
                                         bytes_read > 0)) {
@@ -612,14 +784,12 @@ int poll_paths(struct list *path_list, struct client_path_state *root_cps)
                                     curr->cps_client_file_offset = 0;
                                 }
 
-                                send_packet(STDOUT_FILENO,
-                                            TPT_TAIL_BLOCK,
-                                            TPPT_STRING, root_cps->cps_path,
-                                            TPPT_STRING, curr->cps_path,
-                                            TPPT_INT64, (int64_t) st.st_mtime,
-                                            TPPT_INT64, curr->cps_client_file_offset,
-                                            TPPT_BITS, bytes_read, buffer,
-                                            TPPT_DONE);
+                                send_tail_block(root_cps,
+                                                curr,
+                                                (int64_t) st.st_mtime,
+                                                curr->cps_client_file_offset,
+                                                buffer,
+                                                bytes_read);
                                 curr->cps_client_file_offset += bytes_read;
                                 curr->cps_client_state = CS_TAILING;
                             }
@@ -907,6 +1077,37 @@ void handle_complete_path_request(const char *path)
     free(glob_path);
 }
 
+static
+void set_open_options(struct client_path_state *cps,
+                      int64_t options,
+                      int64_t since,
+                      const char *filter)
+{
+    cps->cps_options = options;
+    cps->cps_since = since;
+    if (filter != NULL && filter[0] != '\0') {
+        regex_t *re = malloc(sizeof(regex_t));
+        int rc = regcomp(re, filter, REG_EXTENDED | REG_NOSUB);
+
+        if (rc != 0) {
+            char msg[1024];
+
+            regerror(rc, re, msg, sizeof(msg));
+            fprintf(stderr,
+                    "warning: ignoring invalid filter for %s -- %s\n",
+                    cps->cps_path,
+                    msg);
+            free(re);
+        } else {
+            fprintf(stderr,
+                    "info: filtering path: %s -- %s\n",
+                    cps->cps_path,
+                    filter);
+            cps->cps_filter = re;
+        }
+    }
+}
+
 int main(int argc, char *argv[])
 {
     int done = 0, timeout = 0;
@@ -921,22 +1122,23 @@ int main(int argc, char *argv[])
 
     {
         FILE *unameFile = popen("uname -mrsv", "r");
+        char buffer[1024] = "unknown";
 
         if (unameFile != NULL) {
-            char buffer[1024];
-
             fgets(buffer, sizeof(buffer), unameFile);
             char *bufend = buffer + strlen(buffer) - 1;
             while (isspace(*bufend)) {
                 bufend -= 1;
             }
             *bufend = '\0';
-            send_packet(STDOUT_FILENO,
-                        TPT_ANNOUNCE,
-                        TPPT_STRING, buffer,
-                        TPPT_DONE);
             pclose(unameFile);
         }
+        // The client waits for this packet before opening any paths.
+        send_packet(STDOUT_FILENO,
+                    TPT_ANNOUNCE,
+                    TPPT_STRING, buffer,
+                    TPPT_INT64, (int64_t) (TF_OPEN_OPTIONS | TF_DEFLATE),
+                    TPPT_DONE);
     }
 
     while (!done) {
@@ -964,6 +1166,9 @@ int main(int argc, char *argv[])
                     case TPT_COMPLETE_PATH: {
                         char *path = readstr(&rstate, STDIN_FILENO);
                         int64_t preview_id = 0;
+                        int64_t open_options = 0, open_since = 0;
+                        char *open_filter = NULL;
+                        tailer_packet_payload_type_t payload_type = TPPT_DONE;
 
                         if (type == TPT_LOAD_PREVIEW) {
                             if (readint64(&rstate, STDIN_FILENO, &preview_id) == -1) {
@@ -971,10 +1176,24 @@ int main(int argc, char *argv[])
                                 break;
                             }
                         }
+                        if (path != NULL) {
+                            payload_type = read_payload_type(&rstate, STDIN_FILENO);
+                            if (type == TPT_OPEN_PATH && payload_type == TPPT_INT64) {
+                                if (readint64_content(&rstate, STDIN_FILENO, &open_options) == -1 ||
+                                    readint64(&rstate, STDIN_FILENO, &open_since) == -1 ||
+                                    (open_filter = readstr(&rstate, STDIN_FILENO)) == NULL) {
+                                    fprintf(stderr, "error: invalid open options\n");
+                                    free(path);
+                                    done = 1;
+                                    break;
+                                }
+                                payload_type = read_payload_type(&rstate, STDIN_FILENO);
+                            }
+                        }
                         if (path == NULL) {
                             fprintf(stderr, "error: unable to get path to open\n");
                             done = 1;
-                        } else if (read_payload_type(&rstate, STDIN_FILENO) != TPPT_DONE) {
+                        } else if (payload_type != TPPT_DONE) {
                             fprintf(stderr, "error: invalid open packet\n");
                             done = 1;
                         } else if (type == TPT_OPEN_PATH) {
@@ -987,6 +1206,7 @@ int main(int argc, char *argv[])
                                 cps = create_client_path_state(path);
 
                                 fprintf(stderr, "info: monitoring path: %s\n", path);
+                                set_open_options(cps, open_options, open_since, open_filter);
                                 list_append(&client_path_list, &cps->cps_node);
                             }
                         } else if (type == TPT_CLOSE_PATH) {
@@ -1004,6 +1224,7 @@ int main(int argc, char *argv[])
                             handle_complete_path_request(path);
                         }
 
+                        free(open_filter);
                         free(path);
                         break;
                     }
@@ -28,6 +28,7 @@
 # SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 import os
+import re
 import sys
 import glob
 import struct
@@ -35,6 +36,7 @@ import hashlib
 import select
 import stat
 import enum
+import zlib
 from typing import List, Optional
 
 
@@ -55,6 +57,16 @@ class TailerPacketType(enum.IntEnum):
     TPT_COMPLETE_PATH = 13
     TPT_POSSIBLE_PATH = 14
     TPT_ANNOUNCE = 15
+    TPT_TAIL_BLOCK_DEFLATE = 16
+
+
+class TailerFeature(enum.IntFlag):
+    TF_OPEN_OPTIONS = 1 << 0
+    TF_DEFLATE = 1 << 1
+
+
+class TailerOpenOption(enum.IntFlag):
+    TOO_DEFLATE = 1 << 0
 
 
 class TailerPacketPayloadType(enum.IntEnum):
@@ -88,6 +100,9 @@ class RecvState(enum.IntEnum):
 
 
 SHA256_BLOCK_SIZE = 32
+BUFFER_SIZE = 4 * 1024 * 1024
+# Blocks smaller than this are not worth compressing.
+MIN_DEFLATE_SIZE = 256
 
 
 def is_glob(fn: str) -> bool:
@@ -162,6 +177,12 @@ class ClientPathState:
         self.cps_client_file_size = 0
         self.cps_client_state = ClientState.CS_INIT
         self.cps_children: List['ClientPathState'] = []
+        # The offset in the client's copy when only filtered lines are sent.
+        self.cps_client_output_offset = 0
+        # The options, lower time bound, and filter sent by the client.
+        self.cps_options = 0
+        self.cps_since = 0
+        self.cps_filter: Optional[re.Pattern] = None
 
     def find_child(self, path: str) -> Optional['ClientPathState']:
         for child in self.cps_children:
@@ -187,6 +208,7 @@ class Tailer:
 
         cps.cps_last_path_state = PathState.PS_ERROR
         cps.cps_client_file_offset = -1
+        cps.cps_client_output_offset = 0
         cps.cps_client_state = ClientState.CS_INIT
         cps.cps_children.clear()
 
@@ -204,6 +226,79 @@ class Tailer:
                     (TailerPacketPayloadType.TPPT_STRING, path),
                     (TailerPacketPayloadType.TPPT_BITS, bits))
 
+    def send_tail_block(self, root_cps: ClientPathState, cps: ClientPathState,
+                        mtime: int, offset: int, bits: bytes):
+        if (root_cps.cps_options & TailerOpenOption.TOO_DEFLATE and
+                len(bits) >= MIN_DEFLATE_SIZE):
+            deflated = zlib.compress(bits, 1)
+            if len(deflated) < len(bits):
+                send_packet(sys.stdout.fileno(),
+                            TailerPacketType.TPT_TAIL_BLOCK_DEFLATE,
+                            (TailerPacketPayloadType.TPPT_STRING, root_cps.cps_path),
+                            (TailerPacketPayloadType.TPPT_STRING, cps.cps_path),
+                            (TailerPacketPayloadType.TPPT_INT64, mtime),
+                            (TailerPacketPayloadType.TPPT_INT64, offset),
+                            (TailerPacketPayloadType.TPPT_INT64, len(bits)),
+                            (TailerPacketPayloadType.TPPT_BITS, deflated))
+                return
+
+        send_packet(sys.stdout.fileno(),
+                    TailerPacketType.TPT_TAIL_BLOCK,
+                    (TailerPacketPayloadType.TPPT_STRING, root_cps.cps_path),
+                    (TailerPacketPayloadType.TPPT_STRING, cps.cps_path),
+                    (TailerPacketPayloadType.TPPT_INT64, mtime),
+                    (TailerPacketPayloadType.TPPT_INT64, offset),
+                    (TailerPacketPayloadType.TPPT_BITS, bits))
+
+    def send_filtered_block(self, root_cps: ClientPathState,
+                            cps: ClientPathState, mtime: int,
+                            buffer: bytes) -> int:
+        """
+        Send the lines in the buffer that match the root path's filter.
+        Only complete lines are consumed so that a line that is still being
+        written is checked once it is done.  If the buffer is full and has
+        no line endings, it is sent as-is.  The first block for a file is
+        always sent, even if it is empty, so that the client's copy from a
+        previous run is truncated.
+
+        Returns the number of bytes of the file that were consumed.
+        """
+        consumed = buffer.rfind(b'\n') + 1
+        if consumed == 0 and len(buffer) >= BUFFER_SIZE:
+            consumed = len(buffer)
+
+        out = bytearray()
+        start = 0
+        while start < consumed:
+            end = buffer.find(b'\n', start, consumed)
+            if end == -1:
+                out.extend(buffer[start:consumed])
+                break
+            text = buffer[start:end].decode('utf-8', errors='replace')
+            if root_cps.cps_filter.search(text):
+                out.extend(buffer[start:end + 1])
+            start = end + 1
+
+        if out or cps.cps_client_file_offset < 0:
+            self.send_tail_block(root_cps, cps, mtime,
+                                 cps.cps_client_output_offset, bytes(out))
+            cps.cps_client_output_offset += len(out)
+
+        return consumed
+
+    def set_open_options(self, cps: ClientPathState, options: int, since: int,
+                         pattern: str):
+        cps.cps_options = options
+        cps.cps_since = since
+        if pattern:
+            try:
+                cps.cps_filter = re.compile(pattern)
+                sys.stderr.write(
+                    f"info: filtering path: {cps.cps_path} -- {pattern}\n")
+            except re.error as e:
+                sys.stderr.write(
+                    f"warning: ignoring invalid filter for {cps.cps_path} -- {e}\n")
+
     def find_client_path_state(self, path_list: List[ClientPathState], path: str) -> Optional[ClientPathState]:
         for curr in path_list:
             if curr.cps_path == path:
@@ -311,6 +406,15 @@ class Tailer:
                     retval += self.poll_paths(curr.cps_children, current_root)
                     curr.cps_last_path_state = PathState.PS_OK
 
+                elif (stat.S_ISREG(st.st_mode) and curr is not current_root and
+                      curr.cps_client_file_offset < 0 and
+                      st.st_mtime < current_root.cps_since):
+                    # Nothing in the file can be inside the client's time range.
+                    if curr.cps_last_path_state == PathState.PS_UNKNOWN:
+                        sys.stderr.write(
+                            f"info: skipping file modified before the time range: {curr.cps_path}\n")
+                    curr.cps_last_path_state = PathState.PS_OK
+
                 elif stat.S_ISREG(st.st_mode):
                     if curr.cps_client_state in (ClientState.CS_INIT,
                                                  ClientState.CS_TAILING,
@@ -323,8 +427,9 @@ class Tailer:
                                                       curr.cps_client_file_offset)
 
                                     # Determine read size
-                                    nbytes = 4 * 1024 * 1024
-                                    if curr.cps_client_state == ClientState.CS_INIT:
+                                    nbytes = BUFFER_SIZE
+                                    if (curr.cps_client_state == ClientState.CS_INIT and
+                                            current_root.cps_filter is None):
                                         if curr.cps_client_file_size == 0:
                                             nbytes = 32 * 1024
                                         elif file_offset < curr.cps_client_file_size:
@@ -337,7 +442,31 @@ class Tailer:
                                     buffer = os.pread(fd, nbytes, file_offset)
                                     bytes_read = len(buffer)
 
-                                    if curr.cps_client_state == ClientState.CS_INIT and (
+                                    sent = True
+                                    if current_root.cps_filter is not None:
+                                        # The client's copy only has the
+                                        # filtered lines, so there is nothing
+                                        # to offer.
+                                        consumed = self.send_filtered_block(
+                                            current_root, curr, int(st.st_mtime),
+                                            buffer)
+                                        if curr.cps_client_file_offset < 0:
+                                            curr.cps_client_file_offset = 0
+                                        if consumed > 0:
+                                            curr.cps_client_file_offset += consumed
+                                            curr.cps_client_state = ClientState.CS_TAILING
+                                        else:
+                                            # Only a partial line is left, wait
+                                            # for the rest of it.
+                                            sent = False
+                                            if curr.cps_client_state != ClientState.CS_SYNCED:
+                                                send_packet(sys.stdout.fileno(),
+                                                            TailerPacketType.TPT_SYNCED,
+                                                            (TailerPacketPayloadType.TPPT_STRING, current_root.cps_path),
+                                                            (TailerPacketPayloadType.TPPT_STRING, curr.cps_path))
+                                                curr.cps_client_state = ClientState.CS_SYNCED
+
+                                    elif curr.cps_client_state == ClientState.CS_INIT and (
                                             curr.cps_client_file_offset < 0 or bytes_read > 0):
                                         # Offer block logic (Hashing)
                                         remaining = 0
@@ -385,18 +514,16 @@ class Tailer:
                                         if curr.cps_client_file_offset < 0:
                                             curr.cps_client_file_offset = 0
 
-                                        send_packet(sys.stdout.fileno(),
-                                                    TailerPacketType.TPT_TAIL_BLOCK,
-                                                    (TailerPacketPayloadType.TPPT_STRING, current_root.cps_path),
-                                                    (TailerPacketPayloadType.TPPT_STRING, curr.cps_path),
-                                                    (TailerPacketPayloadType.TPPT_INT64, int(st.st_mtime)),
-                                                    (TailerPacketPayloadType.TPPT_INT64, curr.cps_client_file_offset),
-                                                    (TailerPacketPayloadType.TPPT_BITS, buffer))
+                                        self.send_tail_block(current_root, curr,
+                                                             int(st.st_mtime),
+                                                             curr.cps_client_file_offset,
+                                                             buffer)
 
                                         curr.cps_client_file_offset += bytes_read
                                         curr.cps_client_state = ClientState.CS_TAILING
 
-                                    retval = 1
+                                    if sent:
+                                        retval = 1
                                 finally:
                                     os.close(fd)
                             except OSError as e:
@@ -608,7 +735,7 @@ class Tailer:
         length = struct.unpack('i', len_data)[0]
 
         str_data = self.read_full(fd, length)
-        if not str_data: return None
+        if str_data is None: return None
         return str_data.decode('utf-8', errors='replace')
 
     def read_int64(self, fd: int) -> Optional[int]:
@@ -617,6 +744,9 @@ class Tailer:
             sys.stderr.write("error: expected int64\n")
             self.running = False
             return None
+        return self.read_int64_content(fd)
+
+    def read_int64_content(self, fd: int) -> Optional[int]:
         data = self.read_full(fd, 8)
         if not data: return None
         return struct.unpack('q', data)[0]
@@ -624,15 +754,20 @@ class Tailer:
     # --- Main Loop ---
 
     def run(self):
-        # Announce system info (simulated)
+        # Announce system info (simulated).  The client waits for this
+        # packet before opening any paths.
+        sys_info = "unknown"
         try:
             import platform
             sys_info = " ".join(platform.uname())
-            send_packet(sys.stdout.fileno(),
-                        TailerPacketType.TPT_ANNOUNCE,
-                        (TailerPacketPayloadType.TPPT_STRING, sys_info))
         except Exception:
             pass
+        send_packet(sys.stdout.fileno(),
+                    TailerPacketType.TPT_ANNOUNCE,
+                    (TailerPacketPayloadType.TPPT_STRING, sys_info),
+                    (TailerPacketPayloadType.TPPT_INT64,
+                     int(TailerFeature.TF_OPEN_OPTIONS |
+                         TailerFeature.TF_DEFLATE)))
 
         stdin_fd = sys.stdin.fileno()
         # Ensure stdin is blocking or handle accordingly. C uses poll.
@@ -666,8 +801,23 @@ class Tailer:
                     if ptype == TailerPacketType.TPT_LOAD_PREVIEW:
                         preview_id = self.read_int64(stdin_fd)
 
+                    open_options = 0
+                    open_since = 0
+                    open_filter = None
+
                     # Done check
                     pl_type = self.read_payload_type(stdin_fd)
+                    if (ptype == TailerPacketType.TPT_OPEN_PATH and
+                            pl_type == TailerPacketPayloadType.TPPT_INT64):
+                        open_options = self.read_int64_content(stdin_fd)
+                        open_since = self.read_int64(stdin_fd)
+                        open_filter = self.read_string(stdin_fd)
+                        if (open_options is None or open_since is None or
+                                open_filter is None):
+                            sys.stderr.write("error: invalid open options\n")
+                            self.running = False
+                            break
+                        pl_type = self.read_payload_type(stdin_fd)
                     if pl_type != TailerPacketPayloadType.TPPT_DONE:
                         sys.stderr.write("error: invalid open packet\n")
                         self.running = False
@@ -681,6 +831,8 @@ class Tailer:
                             else:
                                 cps = self.create_client_path_state(path)
                                 sys.stderr.write(f"info: monitoring path: {path}\n")
+                                self.set_open_options(cps, open_options,
+                                                      open_since, open_filter)
                                 self.client_path_list.append(cps)
 
                         elif ptype == TailerPacketType.TPT_CLOSE_PATH:
@@ -30,6 +30,7 @@
 #include "tailerpp.hh"
 
 #include <unistd.h>
+#include <zlib.h>
 
 namespace tailer {
 
@@ -79,8 +80,28 @@ read_packet(int fd)
         }
         case TPT_ANNOUNCE: {
             packet_announce pa;
-
-            TRY(read_payloads_into(fd, pa.pa_uname));
+            tailer_packet_payload_type_t payload_type;
+
+            TRY(TRY(TRY(protocol_recv<TPPT_STRING>::create(fd))
+                        .read_length(pa.pa_uname))
+                    .read_content(pa.pa_uname));
+            // Older tailers do not send their features.
+            if (readall(fd, &payload_type, sizeof(payload_type)) == -1) {
+                return Err(
+                    fmt::format(FMT_STRING("unable to read payload type: {}"),
+                                strerror(errno)));
+            }
+            if (payload_type == TPPT_INT64) {
+                if (readall(fd, &pa.pa_features, sizeof(pa.pa_features)) == -1)
+                {
+                    return Err(fmt::format(
+                        FMT_STRING("unable to read tailer features: {}"),
+                        strerror(errno)));
+                }
+                TRY(read_payloads_into(fd));
+            } else if (payload_type != TPPT_DONE) {
+                return Err(std::string("invalid announce packet"));
+            }
             return Ok(packet{pa});
         }
         case TPT_OFFER_BLOCK: {
@@ -106,6 +127,41 @@ read_packet(int fd)
                                    ptb.ptb_bits));
             return Ok(packet{ptb});
         }
+        case TPT_TAIL_BLOCK_DEFLATE: {
+            static constexpr int64_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+
+            packet_tail_block ptb;
+            int64_t block_size = 0;
+            std::vector<uint8_t> deflated;
+
+            TRY(read_payloads_into(fd,
+                                   ptb.ptb_root_path,
+                                   ptb.ptb_path,
+                                   ptb.ptb_mtime,
+                                   ptb.ptb_offset,
+                                   block_size,
+                                   deflated));
+            if (block_size < 0 || block_size > MAX_BLOCK_SIZE) {
+                return Err(fmt::format(
+                    FMT_STRING("invalid size for compressed tail block: {}"),
+                    block_size));
+            }
+            ptb.ptb_bits.resize(block_size);
+            ptb.ptb_deflated = true;
+
+            auto dest_len = static_cast<uLongf>(block_size);
+            auto rc = uncompress(ptb.ptb_bits.data(),
+                                 &dest_len,
+                                 deflated.data(),
+                                 deflated.size());
+            if (rc != Z_OK || dest_len != static_cast<uLongf>(block_size)) {
+                return Err(fmt::format(
+                    FMT_STRING("unable to decompress tail block for {}: {}"),
+                    ptb.ptb_path,
+                    rc));
+            }
+            return Ok(packet{ptb});
+        }
         case TPT_SYNCED: {
             packet_synced ps;
 
@@ -50,6 +50,8 @@ struct packet_error {
 
 struct packet_announce {
     std::string pa_uname;
+    /** The TF_* flags for the features supported by the tailer. */
+    int64_t pa_features{0};
 };
 
 struct hash_frag {
@@ -81,6 +83,8 @@ struct packet_tail_block {
     int64_t ptb_mtime;
     int64_t ptb_offset;
     std::vector<uint8_t> ptb_bits;
+    /** True if the block was compressed on the wire. */
+    bool ptb_deflated{false};
 };
 
 struct packet_synced {
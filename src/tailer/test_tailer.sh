@@ -48,3 +48,83 @@ tailer stderr:
 info: monitoring path: foo
 info: exiting...
 EOF
+
+run_test ./drive_tailer tail ${test_dir}/logfile_syslog.0
+
+check_output "tail of file failed?" <<EOF
+Got an offer: {test_dir}/logfile_syslog.0  0 - 384
+tail block: {test_dir}/logfile_syslog.0 0 384 (deflated)
+Nov  3 09:23:38 veridian automount[7998]: lookup(file): lookup for foobar failed
+Nov  3 09:23:38 veridian automount[16442]: attempting to mount entry /auto/opt
+Nov  3 09:23:38 veridian automount[7999]: lookup(file): lookup for opt failed
+Nov  3 09:47:02 veridian sudo: timstack : TTY=pts/6 ; PWD=/auto/wstimstack/rpms/lbuild/test ; USER=root ; COMMAND=/usr/bin/tail /var/log/messages
+synced: {test_dir}/logfile_syslog.0
+all done!
+tailer stderr:
+info: monitoring path: {test_dir}/logfile_syslog.0
+info: prepping offer: init=384; remaining=0; {test_dir}/logfile_syslog.0
+info: client is tailing: {test_dir}/logfile_syslog.0
+info: exiting...
+EOF
+
+run_test ./drive_tailer tail ${test_dir}/logfile_syslog.0 automount
+
+check_output "filtered tail of file failed?" <<EOF
+tail block: {test_dir}/logfile_syslog.0 0 238
+Nov  3 09:23:38 veridian automount[7998]: lookup(file): lookup for foobar failed
+Nov  3 09:23:38 veridian automount[16442]: attempting to mount entry /auto/opt
+Nov  3 09:23:38 veridian automount[7999]: lookup(file): lookup for opt failed
+synced: {test_dir}/logfile_syslog.0
+all done!
+tailer stderr:
+info: monitoring path: {test_dir}/logfile_syslog.0
+info: filtering path: {test_dir}/logfile_syslog.0 -- automount
+info: exiting...
+EOF
+
+# A line that crosses the end of the read buffer should be checked against
+# the filter once it has been read in full.
+awk 'BEGIN {
+    print "keep first";
+    for (remaining = 4 * 1024 * 1024 - 100 - 11;
+         remaining > 0;
+         remaining -= len + 1) {
+        len = remaining > 100 ? 99 : remaining - 1;
+        line = sprintf("%*s", len, "");
+        gsub(/ /, "x", line);
+        print line;
+    }
+    line = sprintf("%300s", "");
+    gsub(/ /, "y", line);
+    print "drop " line;
+    print "keep last";
+}' > tailer-long-line.0
+
+run_test ./drive_tailer tail tailer-long-line.0 keep
+
+check_output "line across the buffer end was not filtered?" <<EOF
+tail block: tailer-long-line.0 0 11
+keep first
+tail block: tailer-long-line.0 11 10
+keep last
+synced: tailer-long-line.0
+all done!
+tailer stderr:
+info: monitoring path: tailer-long-line.0
+info: filtering path: tailer-long-line.0 -- keep
+info: exiting...
+EOF
+
+# The first block is sent even when no lines match so that a stale copy
+# of the file on the client is truncated.
+run_test ./drive_tailer tail ${test_dir}/logfile_syslog.0 no-such-line
+
+check_output "empty filtered tail of file not sent?" <<EOF
+tail block: {test_dir}/logfile_syslog.0 0 0
+synced: {test_dir}/logfile_syslog.0
+all done!
+tailer stderr:
+info: monitoring path: {test_dir}/logfile_syslog.0
+info: filtering path: {test_dir}/logfile_syslog.0 -- no-such-line
+info: exiting...
+EOF
@@ -88,6 +88,8 @@ const std::array<string_fragment, text_time_translator::ZOOM_COUNT>
 void
 text_filter::revert_to_last(logfile_filter_state& lfs, size_t rollback_size)
 {
+    lfs.ensure_filter(this->lf_index);
+
     require(lfs.tfs_lines_for_message[this->lf_index] == 0);
 
     lfs.tfs_message_matched[this->lf_index]
@@ -105,7 +107,7 @@ text_filter::revert_to_last(logfile_filter_state& lfs, size_t rollback_size)
         lfs.tfs_filter_count[this->lf_index] -= 1;
         size_t line_number = lfs.tfs_filter_count[this->lf_index];
 
-        lfs.tfs_mask[line_number] &= ~(((uint32_t) 1) << this->lf_index);
+        lfs.set_mask(line_number, this->lf_index, false);
     }
     if (lfs.tfs_lines_for_message[this->lf_index] > 0) {
         require(lfs.tfs_lines_for_message[this->lf_index] >= rollback_size);
@@ -122,27 +124,35 @@ text_filter::add_line(logfile_filter_state& lfs,
                       logfile::const_iterator ll,
                       const shared_buffer_ref& line)
 {
+    auto retval = this->matches(line_source{*lfs.tfs_logfile, ll}, line);
+
+    this->add_line_result(lfs, ll, retval);
+
+    return retval;
+}
+
+void
+text_filter::add_line_result(logfile_filter_state& lfs,
+                             logfile::const_iterator ll,
+                             bool matched)
+{
+    lfs.ensure_filter(this->lf_index);
     if (ll->is_message()) {
         this->end_of_message(lfs);
     }
-    auto retval = this->matches(line_source{*lfs.tfs_logfile, ll}, line);
 
     lfs.tfs_message_matched[this->lf_index]
-        = lfs.tfs_message_matched[this->lf_index] || retval;
+        = lfs.tfs_message_matched[this->lf_index] || matched;
     lfs.tfs_lines_for_message[this->lf_index] += 1;
-    if (retval) {
+    if (matched) {
         lfs.tfs_hits_for_message[this->lf_index] += 1;
     }
-
-    return retval;
 }
 
 void
 text_filter::end_of_message(logfile_filter_state& lfs)
 {
-    uint32_t mask = 0;
-
-    mask = ((uint32_t) 1U << this->lf_index);
+    lfs.ensure_filter(this->lf_index);
 
     for (size_t lpc = 0; lpc < lfs.tfs_lines_for_message[this->lf_index]; lpc++)
     {
@@ -152,11 +162,9 @@ text_filter::end_of_message(logfile_filter_state& lfs)
         if (line_number == lfs.tfs_logfile->size()) {
             continue;
         }
-        if (lfs.tfs_message_matched[this->lf_index]) {
-            lfs.tfs_mask[line_number] |= mask;
-        } else {
-            lfs.tfs_mask[line_number] &= ~mask;
-        }
+        lfs.set_mask(line_number,
+                     this->lf_index,
+                     lfs.tfs_message_matched[this->lf_index]);
         lfs.tfs_filter_count[this->lf_index] += 1;
     }
     lfs.tfs_filter_hits[this->lf_index]
@@ -1481,15 +1489,20 @@ empty_filter::to_command() const
 bool
 pcre_filter::matches(std::optional<line_source> ls,
                      const shared_buffer_ref& line)
+{
+    return this->matches_content(line.to_string_fragment(),
+                                 line.get_metadata().m_valid_utf);
+}
+
+bool
+pcre_filter::matches_content(string_fragment line, bool valid_utf) const
 {
     auto options = 0;
-    if (line.get_metadata().m_valid_utf) {
+    if (valid_utf) {
         options |= PCRE2_NO_UTF_CHECK;
     }
 
-    return this->pf_pcre->find_in(line.to_string_fragment(), options)
-        .ignore_error()
-        .has_value();
+    return this->pf_pcre->find_in(line, options).ignore_error().has_value();
 }
 
 filter_stack::iterator
@@ -1509,7 +1522,7 @@ filter_stack::find(size_t index)
 std::optional<size_t>
 filter_stack::next_index()
 {
-    bool used[32];
+    bool used[logfile_filter_state::MAX_FILTERS];
 
     memset(used, 0, sizeof(used));
     for (auto& iter : *this) {
@@ -1564,9 +1577,9 @@ filter_stack::delete_filter(const std::string& id)
 }
 
 void
-filter_stack::get_mask(uint32_t& filter_mask)
+filter_stack::get_mask(filter_mask& mask)
 {
-    filter_mask = 0;
+    mask = filter_mask{};
     for (auto& iter : *this) {
         std::shared_ptr<text_filter> tf = iter;
 
@@ -1574,12 +1587,10 @@ filter_stack::get_mask(uint32_t& filter_mask)
             continue;
         }
         if (tf->is_enabled()) {
-            uint32_t bit = (1UL << tf->get_index());
-
             switch (tf->get_type()) {
                 case text_filter::EXCLUDE:
                 case text_filter::INCLUDE:
-                    filter_mask |= bit;
+                    mask.set(tf->get_index());
                     break;
                 default:
                     ensure(0);
@@ -1590,10 +1601,10 @@ filter_stack::get_mask(uint32_t& filter_mask)
 }
 
 void
-filter_stack::get_enabled_mask(uint32_t& filter_in_mask,
-                               uint32_t& filter_out_mask)
+filter_stack::get_enabled_mask(filter_mask& filter_in_mask,
+                               filter_mask& filter_out_mask)
 {
-    filter_in_mask = filter_out_mask = 0;
+    filter_in_mask = filter_out_mask = filter_mask{};
     for (auto& iter : *this) {
         std::shared_ptr<text_filter> tf = iter;
 
@@ -1601,14 +1612,12 @@ filter_stack::get_enabled_mask(uint32_t& filter_in_mask,
             continue;
         }
         if (tf->is_enabled()) {
-            uint32_t bit = (1UL << tf->get_index());
-
             switch (tf->get_type()) {
                 case text_filter::EXCLUDE:
-                    filter_out_mask |= bit;
+                    filter_out_mask.set(tf->get_index());
                     break;
                 case text_filter::INCLUDE:
-                    filter_in_mask |= bit;
+                    filter_in_mask.set(tf->get_index());
                     break;
                 default:
                     ensure(0);
@@ -1708,17 +1717,6 @@ text_sub_source::text_crumbs_for_line(int line,
 logfile_filter_state::logfile_filter_state(std::shared_ptr<logfile> lf)
     : tfs_logfile(std::move(lf))
 {
-    memset(this->tfs_filter_count, 0, sizeof(this->tfs_filter_count));
-    memset(this->tfs_filter_hits, 0, sizeof(this->tfs_filter_hits));
-    memset(this->tfs_message_matched, 0, sizeof(this->tfs_message_matched));
-    memset(this->tfs_lines_for_message, 0, sizeof(this->tfs_lines_for_message));
-    memset(this->tfs_hits_for_message, 0, sizeof(this->tfs_hits_for_message));
-    memset(this->tfs_last_message_matched,
-           0,
-           sizeof(this->tfs_last_message_matched));
-    memset(this->tfs_last_lines_for_message,
-           0,
-           sizeof(this->tfs_last_lines_for_message));
     this->tfs_mask.reserve(64 * 1024);
 }
 
@@ -1733,17 +1731,15 @@ void
 logfile_filter_state::clear_for_rebuild()
 {
     log_debug("clearing filter state");
-    memset(this->tfs_filter_count, 0, sizeof(this->tfs_filter_count));
-    memset(this->tfs_filter_hits, 0, sizeof(this->tfs_filter_hits));
-    memset(this->tfs_message_matched, 0, sizeof(this->tfs_message_matched));
-    memset(this->tfs_lines_for_message, 0, sizeof(this->tfs_lines_for_message));
-    memset(this->tfs_hits_for_message, 0, sizeof(this->tfs_hits_for_message));
-    memset(this->tfs_last_message_matched,
-           0,
-           sizeof(this->tfs_last_message_matched));
-    memset(this->tfs_last_lines_for_message,
-           0,
-           sizeof(this->tfs_last_lines_for_message));
+    this->tfs_filter_count.clear();
+    this->tfs_filter_hits.clear();
+    this->tfs_message_matched.clear();
+    this->tfs_lines_for_message.clear();
+    this->tfs_hits_for_message.clear();
+    this->tfs_last_message_matched.clear();
+    this->tfs_last_lines_for_message.clear();
+    this->tfs_last_hits_for_message.clear();
+    this->tfs_mask_words = 1;
     this->tfs_mask.clear();
     this->tfs_index.clear();
 }
@@ -1751,6 +1747,10 @@ logfile_filter_state::clear_for_rebuild()
 void
 logfile_filter_state::clear_filter_state(size_t index)
 {
+    if (index >= this->tfs_filter_count.size()) {
+        return;
+    }
+
     this->tfs_filter_count[index] = 0;
     this->tfs_filter_hits[index] = 0;
     this->tfs_message_matched[index] = false;
@@ -1758,38 +1758,93 @@ logfile_filter_state::clear_filter_state(size_t index)
     this->tfs_hits_for_message[index] = 0;
     this->tfs_last_message_matched[index] = false;
     this->tfs_last_lines_for_message[index] = 0;
+    this->tfs_last_hits_for_message[index] = 0;
 }
 
 void
-logfile_filter_state::clear_deleted_filter_state(uint32_t used_mask)
+logfile_filter_state::clear_deleted_filter_state(const filter_mask& used_mask)
 {
-    for (int lpc = 0; lpc < MAX_FILTERS; lpc++) {
-        if (!(used_mask & (1L << lpc))) {
+    for (size_t lpc = 0; lpc < this->tfs_filter_count.size(); lpc++) {
+        if (!used_mask.test(lpc)) {
             this->clear_filter_state(lpc);
         }
     }
+
+    // Drop the words for filters that are gone and then clear the bits
+    // for any others that were deleted.
+    this->set_mask_words(std::min(this->tfs_mask_words, used_mask.size()));
     for (size_t lpc = 0; lpc < this->tfs_mask.size(); lpc++) {
-        this->tfs_mask[lpc] &= used_mask;
+        this->tfs_mask[lpc] &= used_mask.word(lpc % this->tfs_mask_words);
     }
 }
 
 void
-logfile_filter_state::resize(size_t newsize)
+logfile_filter_state::ensure_filter(size_t index)
+{
+    require(index < MAX_FILTERS);
+
+    if (index >= this->tfs_filter_count.size()) {
+        const auto count = index + 1;
+
+        this->tfs_filter_count.resize(count);
+        this->tfs_filter_hits.resize(count);
+        this->tfs_message_matched.resize(count);
+        this->tfs_lines_for_message.resize(count);
+        this->tfs_hits_for_message.resize(count);
+        this->tfs_last_message_matched.resize(count);
+        this->tfs_last_lines_for_message.resize(count);
+        this->tfs_last_hits_for_message.resize(count);
+    }
+
+    const auto words = index / filter_mask::WORD_BITS + 1;
+    if (words > this->tfs_mask_words) {
+        this->set_mask_words(words);
+    }
+}
+
+void
+logfile_filter_state::set_mask_words(size_t words)
 {
-    size_t old_mask_size = this->tfs_mask.size();
+    words = std::max(words, size_t{1});
+    if (words == this->tfs_mask_words) {
+        return;
+    }
+
+    const auto lines = this->mask_lines();
+    const auto old_words = this->tfs_mask_words;
 
-    this->tfs_mask.resize(newsize);
-    if (newsize > old_mask_size) {
-        memset(&this->tfs_mask[old_mask_size],
-               0,
-               sizeof(uint32_t) * (newsize - old_mask_size));
+    if (words > old_words) {
+        // Widen in place, working backwards so rows are not overwritten
+        // before they are moved.
+        this->tfs_mask.resize(lines * words);
+        for (size_t line = lines; line > 0; line--) {
+            auto* dst = &this->tfs_mask[(line - 1) * words];
+            const auto* src = &this->tfs_mask[(line - 1) * old_words];
+
+            std::copy_backward(src, src + old_words, dst + old_words);
+            std::fill(dst + old_words, dst + words, 0);
+        }
+    } else {
+        for (size_t line = 0; line < lines; line++) {
+            std::copy_n(&this->tfs_mask[line * old_words],
+                        words,
+                        &this->tfs_mask[line * words]);
+        }
+        this->tfs_mask.resize(lines * words);
     }
+    this->tfs_mask_words = words;
+}
+
+void
+logfile_filter_state::resize(size_t newsize)
+{
+    this->tfs_mask.resize(newsize * this->tfs_mask_words, 0);
 }
 
 void
 logfile_filter_state::reserve(size_t expected)
 {
-    this->tfs_mask.reserve(expected);
+    this->tfs_mask.reserve(expected * this->tfs_mask_words);
 }
 
 std::optional<size_t>
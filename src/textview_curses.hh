@@ -32,6 +32,7 @@
 #ifndef textview_curses_hh
 #define textview_curses_hh
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <memory>
@@ -63,6 +64,44 @@ struct exec_context;
 using vis_bookmarks_t = bookmarks<vis_line_t>;
 using vis_bookmarks = bookmarks<vis_line_t>::type;
 
+/**
+ * A set of filters, one bit per filter index.  The enabled filters are
+ * collected into these so they can be combined with the per-line masks
+ * in logfile_filter_state.
+ */
+class filter_mask {
+public:
+    static constexpr size_t WORD_BITS = 32;
+    static constexpr size_t MAX_WORDS = 8;
+
+    void set(size_t index)
+    {
+        const auto word = index / WORD_BITS;
+
+        this->fm_words[word] |= (uint32_t) 1U << (index % WORD_BITS);
+        this->fm_size = std::max(this->fm_size, word + 1);
+    }
+
+    bool test(size_t index) const
+    {
+        const auto word = index / WORD_BITS;
+
+        return word < this->fm_size
+            && (this->fm_words[word] >> (index % WORD_BITS)) & 1U;
+    }
+
+    bool empty() const { return this->fm_size == 0; }
+
+    /** The number of words needed to hold the highest bit that is set. */
+    size_t size() const { return this->fm_size; }
+
+    uint32_t word(size_t index) const { return this->fm_words[index]; }
+
+private:
+    std::array<uint32_t, MAX_WORDS> fm_words{};
+    size_t fm_size{0};
+};
+
 class logfile_filter_state {
 public:
     logfile_filter_state(std::shared_ptr<logfile> lf = nullptr);
@@ -73,7 +112,14 @@ public:
 
     void clear_filter_state(size_t index);
 
-    void clear_deleted_filter_state(uint32_t used_mask);
+    void clear_deleted_filter_state(const filter_mask& used_mask);
+
+    /**
+     * Make room for the state of the filter with the given index.  The
+     * per-line masks are only as wide as the highest filter index in use,
+     * so a file with a handful of filters pays one word per line.
+     */
+    void ensure_filter(size_t index);
 
     void resize(size_t newsize);
 
@@ -81,19 +127,83 @@ public:
 
     std::optional<size_t> content_line_to_vis_line(uint32_t line);
 
-    const static int MAX_FILTERS = 32;
+    size_t filter_count(size_t index) const
+    {
+        return index < this->tfs_filter_count.size()
+            ? this->tfs_filter_count[index]
+            : 0;
+    }
+
+    int filter_hits(size_t index) const
+    {
+        return index < this->tfs_filter_hits.size()
+            ? this->tfs_filter_hits[index]
+            : 0;
+    }
+
+    /** The number of lines that have a mask. */
+    size_t mask_lines() const
+    {
+        return this->tfs_mask.size() / this->tfs_mask_words;
+    }
+
+    const uint32_t* mask_row(size_t line) const
+    {
+        return &this->tfs_mask[line * this->tfs_mask_words];
+    }
+
+    bool test_mask(size_t line, size_t index) const
+    {
+        const auto word = index / filter_mask::WORD_BITS;
+
+        if (word >= this->tfs_mask_words) {
+            return false;
+        }
+        return (this->mask_row(line)[word] >> (index % filter_mask::WORD_BITS))
+            & 1U;
+    }
+
+    bool any_mask(size_t line) const
+    {
+        const auto* row = this->mask_row(line);
+
+        return std::any_of(row, row + this->tfs_mask_words, [](auto word) {
+            return word != 0;
+        });
+    }
+
+    void set_mask(size_t line, size_t index, bool value)
+    {
+        auto& word = this->tfs_mask[line * this->tfs_mask_words
+                                    + index / filter_mask::WORD_BITS];
+        const auto bit = (uint32_t) 1U << (index % filter_mask::WORD_BITS);
+
+        if (value) {
+            word |= bit;
+        } else {
+            word &= ~bit;
+        }
+    }
+
+    static constexpr size_t MAX_FILTERS
+        = filter_mask::WORD_BITS * filter_mask::MAX_WORDS;
 
     std::shared_ptr<logfile> tfs_logfile;
-    size_t tfs_filter_count[MAX_FILTERS];
-    int tfs_filter_hits[MAX_FILTERS];
-    bool tfs_message_matched[MAX_FILTERS];
-    size_t tfs_lines_for_message[MAX_FILTERS];
-    size_t tfs_hits_for_message[MAX_FILTERS];
-    bool tfs_last_message_matched[MAX_FILTERS];
-    size_t tfs_last_lines_for_message[MAX_FILTERS];
-    size_t tfs_last_hits_for_message[MAX_FILTERS];
+    std::vector<size_t> tfs_filter_count;
+    std::vector<int> tfs_filter_hits;
+    std::vector<bool> tfs_message_matched;
+    std::vector<size_t> tfs_lines_for_message;
+    std::vector<size_t> tfs_hits_for_message;
+    std::vector<bool> tfs_last_message_matched;
+    std::vector<size_t> tfs_last_lines_for_message;
+    std::vector<size_t> tfs_last_hits_for_message;
+    /** The filter bits for each line, tfs_mask_words per line. */
+    size_t tfs_mask_words{1};
     std::vector<uint32_t> tfs_mask;
     std::vector<uint32_t> tfs_index;
+
+private:
+    void set_mask_words(size_t words);
 };
 
 enum class filter_lang_t : int {
@@ -133,6 +243,14 @@ public:
                   logfile_const_iterator ll,
                   const shared_buffer_ref& line);
 
+    /**
+     * Record the result of matching a line that was evaluated elsewhere,
+     * like on a worker thread.
+     */
+    void add_line_result(logfile_filter_state& lfs,
+                         logfile_const_iterator ll,
+                         bool matched);
+
     void end_of_message(logfile_filter_state& lfs);
 
     struct line_source {
@@ -186,6 +304,12 @@ public:
     bool matches(std::optional<line_source> ls,
                  const shared_buffer_ref& line) override;
 
+    /**
+     * Match against the content of a line.  Unlike matches(), this is safe
+     * to call from multiple threads.
+     */
+    bool matches_content(string_fragment line, bool valid_utf) const;
+
     std::string to_command() const override
     {
         return (this->lf_type == text_filter::INCLUDE ? "filter-in "
@@ -253,9 +377,10 @@ public:
 
     bool delete_filter(const std::string& id);
 
-    void get_mask(uint32_t& filter_mask);
+    void get_mask(filter_mask& mask);
 
-    void get_enabled_mask(uint32_t& filter_in_mask, uint32_t& filter_out_mask);
+    void get_enabled_mask(filter_mask& filter_in_mask,
+                          filter_mask& filter_out_mask);
 
     uint32_t fs_generation{0};
 
@@ -819,13 +944,6 @@ public:
     std::optional<line_info> grep_value_for_line(vis_line_t line,
                                                  std::string& value_out);
 
-    void grep_quiesce()
-    {
-        if (this->tc_sub_source != nullptr) {
-            this->tc_sub_source->quiesce();
-        }
-    }
-
     void grep_begin(grep_proc<vis_line_t>& gp,
                     vis_line_t start,
                     vis_line_t stop);
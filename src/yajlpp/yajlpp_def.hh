@@ -633,7 +633,9 @@ struct json_path_handler : public json_path_handler_base {
                                      yajl_string_props_t* props) {
             auto* obj = ypc->ypc_obj_stack.top();
             auto key = ypc->get_path_fragment(-1);
+            const auto* jph = ypc->ypc_current_handler;
 
+            jph->validate_string(*ypc, value_str);
             json_path_handler::get_field(obj, args...)[key]
                 = value_str.to_string();
 
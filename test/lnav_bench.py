@@ -0,0 +1,411 @@
+#! /usr/bin/env python3
+
+# Copyright (c) 2026, Timothy Stack
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# * Redistributions of source code must retain the above copyright notice, this
+# list of conditions and the following disclaimer.
+# * Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+# * Neither the name of Timothy Stack nor the names of its contributors
+# may be used to endorse or promote products derived from this software
+# without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+# ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""
+Benchmarks for lnav's indexing, filtering, searching, SQL, and rendering.
+
+The log files are generated from a seeded random number generator so that
+the same inputs are used from run to run.  Each scenario runs lnav in
+headless mode on a generated file, measures the wall-clock time, and saves
+the operation timings from the lnav_perf table.  The results are written as
+JSON so that they can be compared against the results from an earlier
+release with the --baseline option.
+"""
+
+import argparse
+import datetime
+import gzip
+import json
+import os
+import random
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+HOSTS = ["web01", "web02", "db01", "cache01"]
+USERS = ["alice", "bob", "carol", "dave", "erin", "frank"]
+PROGRAMS = ["sshd", "cron", "kernel", "systemd", "nginx"]
+LEVELS = ["TRACE", "DEBUG", "INFO", "INFO", "INFO", "WARN", "ERROR"]
+BUNYAN_LEVELS = {"TRACE": 10, "DEBUG": 20, "INFO": 30, "WARN": 40,
+                 "ERROR": 50}
+CLASSES = ["com.example.web.RequestHandler",
+           "com.example.db.ConnectionPool",
+           "com.example.cache.Evictor",
+           "com.example.auth.SessionManager"]
+START_TIME = datetime.datetime(2024, 1, 1, tzinfo=datetime.timezone.utc)
+
+
+def message(rng):
+    user = rng.choice(USERS)
+    choice = rng.randrange(5)
+    if choice == 0:
+        return "session opened for user %s by (uid=%d)" % (
+            user, rng.randrange(1000, 2000))
+    if choice == 1:
+        return "request GET /api/v1/items/%d completed in %dms status=%d" % (
+            rng.randrange(100000), rng.randrange(1, 5000),
+            rng.choice([200, 200, 200, 304, 404, 500]))
+    if choice == 2:
+        return "user %s logged in from 10.%d.%d.%d" % (
+            user, rng.randrange(256), rng.randrange(256), rng.randrange(256))
+    if choice == 3:
+        return "cache miss for key=%08x size=%d" % (
+            rng.getrandbits(32), rng.randrange(1, 1 << 20))
+    return "processed batch %d with %d records" % (
+        rng.randrange(100000), rng.randrange(1, 10000))
+
+
+def gen_syslog(rng, ts):
+    return "%s %s %s[%d]: %s\n" % (
+        ts.strftime("%b %e %H:%M:%S"), rng.choice(HOSTS),
+        rng.choice(PROGRAMS), rng.randrange(1, 65536), message(rng))
+
+
+def gen_json(rng, ts):
+    level = rng.choice(LEVELS)
+    return json.dumps({
+        "name": "bench",
+        "hostname": rng.choice(HOSTS),
+        "pid": rng.randrange(1, 65536),
+        "level": BUNYAN_LEVELS.get(level, 30),
+        "msg": message(rng),
+        "time": ts.strftime("%Y-%m-%dT%H:%M:%S.") + "%03dZ" % (
+            ts.microsecond // 1000),
+        "v": 0,
+    }) + "\n"
+
+
+def gen_java(rng, ts):
+    level = rng.choice(LEVELS)
+    clazz = rng.choice(CLASSES)
+    retval = "INFO   | jvm 1    | %s | %s,%03d [Worker-%d] %-5s %s - %s\n" % (
+        ts.strftime("%Y/%m/%d %H:%M:%S"),
+        ts.strftime("%Y-%m-%d %H:%M:%S"), ts.microsecond // 1000,
+        rng.randrange(16), level, clazz, message(rng))
+    if level == "ERROR":
+        retval += "java.lang.IllegalStateException: unexpected state %d\n" % (
+            rng.randrange(100))
+        for depth in range(rng.randrange(3, 12)):
+            retval += "\tat %s.method%d(%s.java:%d)\n" % (
+                rng.choice(CLASSES), depth,
+                rng.choice(CLASSES).rsplit(".", 1)[1], rng.randrange(1, 900))
+    return retval
+
+
+GENERATORS = {
+    "syslog": gen_syslog,
+    "json": gen_json,
+    "java": gen_java,
+}
+
+LOG_TYPES = sorted(GENERATORS) + sorted(name + ".gz" for name in GENERATORS)
+
+# The commands for each scenario.  The file is always loaded and indexed,
+# so the "index" scenario is the baseline for the others.
+SCENARIOS = {
+    "index": [],
+    "detect": [],
+    "filter": [
+        ":filter-out cache miss",
+        ":toggle-filtering",
+        ":toggle-filtering",
+        ":filter-in user",
+        ":toggle-filtering",
+        ":toggle-filtering",
+    ],
+    "search": [
+        "/logged in from 10\\.1[0-9]\\.",
+        ":next-mark search",
+    ],
+    "sql": [
+        ";SELECT log_level, count(*), min(log_time), max(log_time) "
+        "FROM all_logs GROUP BY log_level",
+    ],
+    "redraw": [
+        ":goto 0",
+        ":write-screen-to /dev/null",
+        ":goto 25%",
+        ":write-screen-to /dev/null",
+        ":goto 50%",
+        ":write-screen-to /dev/null",
+        ":goto 75%",
+        ":write-screen-to /dev/null",
+        ":goto 100%",
+        ":write-screen-to /dev/null",
+    ],
+}
+
+# The number of lines in the files used to measure format detection.
+DETECT_LINES = 1000
+
+
+def parse_size(value):
+    suffixes = {"k": 1024, "m": 1024 * 1024, "g": 1024 * 1024 * 1024}
+    value = value.strip().lower()
+    if value and value[-1] in suffixes:
+        return int(float(value[:-1]) * suffixes[value[-1]])
+    return int(value)
+
+
+def generate(path, log_type, seed, size=None, lines=None):
+    """Write a log file of the given type that is at least 'size' bytes or
+    has 'lines' messages."""
+    base_type = log_type[:-3] if log_type.endswith(".gz") else log_type
+    gen = GENERATORS[base_type]
+    rng = random.Random("%s:%d" % (base_type, seed))
+    ts = START_TIME
+    written = 0
+    count = 0
+
+    raw = open(path, "wb")
+    out = raw
+    if log_type.endswith(".gz"):
+        out = gzip.GzipFile(filename="", mode="wb", fileobj=raw, mtime=0)
+    with raw, out:
+        while True:
+            if size is not None and written >= size:
+                break
+            if lines is not None and count >= lines:
+                break
+            ts += datetime.timedelta(milliseconds=rng.randrange(1, 2000))
+            data = gen(rng, ts).encode("utf-8")
+            out.write(data)
+            written += len(data)
+            count += 1
+
+
+def input_file(work_dir, log_type, size, seed, lines=None):
+    suffix = ".gz" if log_type.endswith(".gz") else ".log"
+    base_type = log_type[:-3] if log_type.endswith(".gz") else log_type
+    if lines is None:
+        name = "%s-%d-%d%s" % (base_type, size, seed, suffix)
+    else:
+        name = "%s-%dl-%d%s" % (base_type, lines, seed, suffix)
+    path = os.path.join(work_dir, name)
+    if not os.path.exists(path):
+        tmp_path = path + ".tmp"
+        generate(tmp_path, log_type, seed, size=size, lines=lines)
+        os.rename(tmp_path, path)
+    return path
+
+
+def run_lnav(args, lnav_home, path, commands):
+    # Each run gets its own HOME and TMPDIR so that the index cache and the
+    # gzip sync-point cache from an earlier run do not speed up this one.
+    run_dir = tempfile.mkdtemp(prefix="run.", dir=lnav_home)
+    home_dir = os.path.join(run_dir, "home")
+    tmp_dir = os.path.join(run_dir, "tmp")
+    os.mkdir(home_dir)
+    os.mkdir(tmp_dir)
+    perf_path = os.path.join(run_dir, "perf.json")
+    cmd = [args.lnav, "-n"]
+    for command in commands:
+        cmd.extend(["-c", command])
+    cmd.extend([
+        "-c", ";SELECT kind, name, metric, value, unit FROM lnav_perf",
+        "-c", ":write-json-to " + perf_path,
+        path,
+    ])
+
+    env = dict(os.environ)
+    env["HOME"] = home_dir
+    env["TMPDIR"] = tmp_dir
+    env["TZ"] = "UTC"
+    env.pop("XDG_CONFIG_HOME", None)
+    try:
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, env=env, stdin=subprocess.DEVNULL,
+                              stdout=subprocess.DEVNULL,
+                              stderr=subprocess.PIPE)
+        elapsed = time.perf_counter() - start
+        if proc.returncode != 0:
+            raise RuntimeError("lnav failed (%d): %s" % (
+                proc.returncode, proc.stderr.decode("utf-8", "replace")))
+        with open(perf_path) as fp:
+            rows = json.load(fp)
+    finally:
+        shutil.rmtree(run_dir, ignore_errors=True)
+    return elapsed, rows
+
+
+def summarize_rows(rows):
+    operations = {}
+    files = {}
+    for row in rows:
+        if row["kind"] == "operation":
+            if row["metric"] in ("count", "total", "p50", "p90", "p99",
+                                 "max"):
+                operations.setdefault(row["name"], {})[row["metric"]] = \
+                    row["value"]
+        elif row["kind"] == "file":
+            files[row["metric"]] = row["value"]
+    return operations, files
+
+
+def run_scenario(args, lnav_home, log_type, size, scenario):
+    if scenario == "detect":
+        path = input_file(args.work_dir, log_type, size, args.seed,
+                          lines=DETECT_LINES)
+    else:
+        path = input_file(args.work_dir, log_type, size, args.seed)
+    wall_times = []
+    operations = {}
+    files = {}
+    for _ in range(args.repeat):
+        elapsed, rows = run_lnav(args, lnav_home, path, SCENARIOS[scenario])
+        wall_times.append(elapsed * 1000.0)
+        operations, files = summarize_rows(rows)
+
+    return {
+        "log_type": log_type,
+        "size": size,
+        "scenario": scenario,
+        "file_size": os.path.getsize(path),
+        "wall_time_ms": statistics.median(wall_times),
+        "wall_times_ms": wall_times,
+        "operations": operations,
+        "file": files,
+    }
+
+
+def result_key(result):
+    return (result["log_type"], result["size"], result["scenario"])
+
+
+def compare(results, baseline_path, threshold):
+    with open(baseline_path) as fp:
+        baseline = json.load(fp)
+    previous = {result_key(result): result for result in baseline["results"]}
+    regressions = []
+    for result in results:
+        old = previous.get(result_key(result))
+        if old is None:
+            continue
+        ratio = result["wall_time_ms"] / max(old["wall_time_ms"], 1e-9)
+        result["baseline_wall_time_ms"] = old["wall_time_ms"]
+        result["ratio"] = ratio
+        if ratio > 1.0 + threshold:
+            regressions.append(result)
+    return regressions
+
+
+def lnav_version(lnav):
+    proc = subprocess.run([lnav, "-V"], stdout=subprocess.PIPE,
+                          stderr=subprocess.DEVNULL)
+    return proc.stdout.decode("utf-8", "replace").strip()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument("--lnav", default="lnav",
+                        help="the lnav binary to benchmark")
+    parser.add_argument("--sizes", default="16M",
+                        help="comma-separated list of file sizes to test")
+    parser.add_argument("--types", default=",".join(LOG_TYPES),
+                        help="comma-separated list of log types: %s" %
+                             ", ".join(LOG_TYPES))
+    parser.add_argument("--scenarios", default=",".join(SCENARIOS),
+                        help="comma-separated list of scenarios: %s" %
+                             ", ".join(SCENARIOS))
+    parser.add_argument("--seed", type=int, default=1,
+                        help="the seed for the log generators")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="the number of times to run each scenario")
+    parser.add_argument("--work-dir",
+                        help="the directory for the generated logs")
+    parser.add_argument("--output", default="-",
+                        help="the file to write the JSON results to")
+    parser.add_argument("--baseline",
+                        help="the results of an earlier run to compare to")
+    parser.add_argument("--threshold", type=float, default=0.2,
+                        help="the slowdown, as a fraction, that is reported "
+                             "as a regression")
+    args = parser.parse_args()
+
+    types = [t for t in args.types.split(",") if t]
+    scenarios = [s for s in args.scenarios.split(",") if s]
+    sizes = [parse_size(s) for s in args.sizes.split(",") if s]
+    for log_type in types:
+        if log_type not in LOG_TYPES:
+            parser.error("unknown log type: %s" % log_type)
+    for scenario in scenarios:
+        if scenario not in SCENARIOS:
+            parser.error("unknown scenario: %s" % scenario)
+
+    if args.work_dir is None:
+        args.work_dir = os.path.join(tempfile.gettempdir(), "lnav-bench")
+    os.makedirs(args.work_dir, exist_ok=True)
+    lnav_home = tempfile.mkdtemp(prefix="lnav-bench-home.")
+
+    results = []
+    try:
+        for log_type in types:
+            for size in sizes:
+                for scenario in scenarios:
+                    result = run_scenario(args, lnav_home, log_type, size,
+                                          scenario)
+                    print("%-10s %10d %-8s %10.1fms" % (
+                        log_type, size, scenario, result["wall_time_ms"]),
+                        file=sys.stderr)
+                    results.append(result)
+    finally:
+        shutil.rmtree(lnav_home, ignore_errors=True)
+
+    regressions = []
+    if args.baseline:
+        regressions = compare(results, args.baseline, args.threshold)
+
+    doc = {
+        "lnav_version": lnav_version(args.lnav),
+        "seed": args.seed,
+        "repeat": args.repeat,
+        "results": results,
+    }
+    if args.output == "-":
+        json.dump(doc, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+    else:
+        with open(args.output, "w") as fp:
+            json.dump(doc, fp, indent=2)
+            fp.write("\n")
+
+    for result in regressions:
+        print("regression: %s %d %s -- %.1fms -> %.1fms" % (
+            result["log_type"], result["size"], result["scenario"],
+            result["baseline_wall_time_ms"], result["wall_time_ms"]),
+            file=sys.stderr)
+
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
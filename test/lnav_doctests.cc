@@ -40,6 +40,8 @@
 #include "doctest/doctest.h"
 #include "hasher.hh"
 #include "lnav_config.hh"
+#include "log.column_cache.hh"
+#include "log_format.hh"
 #include "lnav_util.hh"
 #include "ptimec.hh"
 #include "shlex.hh"
@@ -404,3 +406,131 @@ TEST_CASE("hasher to_string")
     h.to_string(buf);
     CHECK(string(buf) == "cae682d36a82683743e01ac7d11e945c");
 }
+
+TEST_CASE("column_cache")
+{
+    using lnav::log::column_cache;
+
+    const auto num_name = intern_string::lookup("num");
+    const auto real_name = intern_string::lookup("real");
+    const auto str_name = intern_string::lookup("str");
+    auto make_values = [&](int64_t num, const char* str) {
+        logline_value_vector retval;
+
+        retval.lvv_values.emplace_back(
+            logline_value_meta(num_name,
+                               value_kind_t::VALUE_INTEGER,
+                               logline_value_meta::table_column{0}),
+            num);
+        retval.lvv_values.emplace_back(
+            logline_value_meta(real_name,
+                               value_kind_t::VALUE_FLOAT,
+                               logline_value_meta::table_column{1}),
+            num / 2.0);
+        if (str != nullptr) {
+            retval.lvv_values.emplace_back(
+                logline_value_meta(str_name,
+                                   value_kind_t::VALUE_TEXT,
+                                   logline_value_meta::table_column{2}),
+                string_fragment::from_c_str(str));
+        }
+        return retval;
+    };
+
+    SUBCASE("store and lookup")
+    {
+        column_cache cc;
+
+        CHECK_FALSE(cc.lookup(0, size_t{0}).has_value());
+
+        cc.store(0, make_values(10, "abc"));
+        cc.store(1, make_values(11, nullptr));
+
+        auto num = cc.lookup(0, size_t{0});
+        REQUIRE(num.has_value());
+        CHECK(num->c_kind == column_cache::cell_kind::integer);
+        CHECK(num->c_integer == 10);
+
+        auto real = cc.lookup(1, real_name);
+        REQUIRE(real.has_value());
+        CHECK(real->c_kind == column_cache::cell_kind::real);
+        CHECK(real->c_real == 5.5);
+
+        auto str = cc.lookup(0, str_name);
+        REQUIRE(str.has_value());
+        CHECK(str->c_kind == column_cache::cell_kind::text);
+        CHECK(str->c_text.to_string() == "abc");
+
+        auto missing = cc.lookup(1, str_name);
+        REQUIRE(missing.has_value());
+        CHECK(missing->c_kind == column_cache::cell_kind::null);
+
+        CHECK_FALSE(cc.lookup(2, size_t{0}).has_value());
+        CHECK_FALSE(cc.lookup(0, size_t{3}).has_value());
+        CHECK(cc.memory_usage() > 0);
+        CHECK(column_cache::total_memory_usage() >= cc.memory_usage());
+    }
+
+    SUBCASE("invalidate_from")
+    {
+        column_cache cc;
+
+        cc.store(0, make_values(1, "a"));
+        cc.store(5, make_values(2, "b"));
+        cc.store(column_cache::PAGE_SIZE, make_values(3, "c"));
+
+        auto usage_before = cc.memory_usage();
+        cc.invalidate_from(5);
+        CHECK(cc.lookup(0, num_name).has_value());
+        CHECK_FALSE(cc.lookup(5, num_name).has_value());
+        CHECK_FALSE(cc.lookup(column_cache::PAGE_SIZE, num_name).has_value());
+        CHECK(cc.memory_usage() < usage_before);
+
+        cc.store(5, make_values(4, "d"));
+        auto num = cc.lookup(5, num_name);
+        REQUIRE(num.has_value());
+        CHECK(num->c_integer == 4);
+
+        cc.invalidate_from(0);
+        CHECK_FALSE(cc.lookup(0, num_name).has_value());
+        CHECK_FALSE(cc.lookup(5, num_name).has_value());
+    }
+
+    SUBCASE("evict")
+    {
+        auto& cfg = lnav_config.lc_logfile;
+        auto saved_size = cfg.lc_column_cache_size;
+        column_cache cc1;
+        column_cache cc2;
+        auto make_num = [&](int64_t num) {
+            logline_value_vector retval;
+
+            retval.lvv_values.emplace_back(
+                logline_value_meta(num_name,
+                                   value_kind_t::VALUE_INTEGER,
+                                   logline_value_meta::table_column{0}),
+                num);
+            return retval;
+        };
+
+        cc2.store(0, make_num(1));
+        const auto bytes_per_line = cc2.memory_usage();
+        cc1.store(0, make_num(2));
+        cc1.store(column_cache::PAGE_SIZE, make_num(3));
+        // Touch the first page so that it is more recent than the second.
+        CHECK(cc1.lookup(0, num_name).has_value());
+
+        cfg.lc_column_cache_size = 3 * bytes_per_line + bytes_per_line / 2;
+        cc1.store(2 * column_cache::PAGE_SIZE, make_num(4));
+        cfg.lc_column_cache_size = saved_size;
+
+        // The oldest pages are evicted even when they belong to a
+        // different cache than the one being stored into.
+        CHECK_FALSE(cc2.lookup(0, num_name).has_value());
+        CHECK(cc1.lookup(0, num_name).has_value());
+        CHECK_FALSE(cc1.lookup(column_cache::PAGE_SIZE, num_name).has_value());
+        CHECK(cc1.lookup(2 * column_cache::PAGE_SIZE, num_name).has_value());
+        CHECK(cc2.memory_usage() == 0);
+        CHECK(cc1.memory_usage() == 2 * bytes_per_line);
+    }
+}
@@ -94,3 +94,33 @@ run_cap_test ${lnav_test} -nN \
 run_cap_test ${lnav_test} -nN -S "abc"
 
 run_cap_test ${lnav_test} -nN -S "2020-01-01abc"
+
+unset YES_COLOR
+
+run_test ${lnav_test} -n -L warning ${test_dir}/logfile_multiline.0
+
+check_output "messages below the min-level were not skipped?" <<EOF
+2009-07-20 22:59:30,221:ERROR:Goodbye, World!
+EOF
+
+run_test ${lnav_test} -n -L warning \
+    -c ";SELECT log_level, count(*) AS total FROM all_logs GROUP BY log_level" \
+    -c ":write-csv-to -" \
+    ${test_dir}/logfile_multiline.0
+
+check_output "skipped messages are counted?" <<EOF
+log_level,total
+error,1
+EOF
+
+run_test ${lnav_test} -n -L bogus ${test_dir}/logfile_multiline.0
+
+check_error_output "invalid min-level accepted?" <<EOF
+  error: invalid 'min-level' value “bogus”
+ = help: expecting a log level like “warning” or “error”
+EOF
+
+if ${lnav_test} -n -L bogus ${test_dir}/logfile_multiline.0 2> /dev/null; then
+    echo "invalid min-level did not fail"
+    exit 1
+fi
@@ -232,6 +232,28 @@ run_cap_test ${lnav_test} -n \
     -c ':hide-fields log_time log_level' \
     ${test_dir}/logfile_generic.0
 
+# The rendered lines are cached, so hiding and showing a field needs to
+# result in the lines being rendered again.
+run_test ${lnav_test} -n \
+    -c ":write-screen-to -" \
+    -c ":hide-fields c_ip" \
+    -c ":write-screen-to -" \
+    -c ":show-fields c_ip" \
+    -c ":write-screen-to -" \
+    ${test_dir}/logfile_access_log.0
+
+check_output "hidden field not applied to cached lines?" <<EOF
+192.168.202.254 - - [20/Jul/2009:22:59:26 +0000] "GET /vmw/cgi/tramp HTTP/1.0" 200 134 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkboot.gz HTTP/1.0" 404 46210 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkernel.gz HTTP/1.0" 200 78929 "-" "gPXE/0.9.7"
+⋮ - - [20/Jul/2009:22:59:26 +0000] "GET /vmw/cgi/tramp HTTP/1.0" 200 134 "-" "gPXE/0.9.7"
+⋮ - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkboot.gz HTTP/1.0" 404 46210 "-" "gPXE/0.9.7"
+⋮ - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkernel.gz HTTP/1.0" 200 78929 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:26 +0000] "GET /vmw/cgi/tramp HTTP/1.0" 200 134 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkboot.gz HTTP/1.0" 404 46210 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkernel.gz HTTP/1.0" 200 78929 "-" "gPXE/0.9.7"
+EOF
+
 run_cap_test ${lnav_test} -f- -n < ${test_dir}/formats/scripts/multiline-echo.lnav
 
 run_cap_test ${lnav_test} -n \
@@ -390,13 +412,106 @@ run_cap_test ${lnav_test} -n \
     -c ":filter-out World" \
     ${test_dir}/logfile_plain.0
 
-#TOO_MANY_FILTERS=""
-#for i in `seq 1 32`; do
-#    TOO_MANY_FILTERS="$TOO_MANY_FILTERS -c ':filter-out $i'"
-#done
-#run_cap_test ${lnav_test} -d /tmp/lnav.err -n \
-#    $TOO_MANY_FILTERS \
-#    ${test_dir}/logfile_filter.0
+# More than 32 filters need a second word in the per-line masks.  Deleting
+# the filters in the second word narrows the masks and adding one back
+# widens them again.
+awk 'BEGIN {
+    for (i = 0; i < 45; i++) {
+        printf "Nov  3 09:23:%02d veridian worker[100]: item-%d\n", i, i;
+    }
+}' > logfile_many_filters.0
+
+MANY_FILTERS=()
+for i in `seq 0 39`; do
+    MANY_FILTERS+=(-c ":filter-out item-$i\$")
+done
+DELETE_HIGH_FILTERS=()
+for i in `seq 32 39`; do
+    DELETE_HIGH_FILTERS+=(-c ":delete-filter item-$i\$")
+done
+
+run_test ${lnav_test} -n \
+    "${MANY_FILTERS[@]}" \
+    logfile_many_filters.0
+
+check_output "more than 32 filters are not applied?" <<EOF
+Nov  3 09:23:40 veridian worker[100]: item-40
+Nov  3 09:23:41 veridian worker[100]: item-41
+Nov  3 09:23:42 veridian worker[100]: item-42
+Nov  3 09:23:43 veridian worker[100]: item-43
+Nov  3 09:23:44 veridian worker[100]: item-44
+EOF
+
+run_test ${lnav_test} -n \
+    "${MANY_FILTERS[@]}" \
+    "${DELETE_HIGH_FILTERS[@]}" \
+    logfile_many_filters.0
+
+check_output "deleting filters past 32 does not narrow the masks?" <<EOF
+Nov  3 09:23:32 veridian worker[100]: item-32
+Nov  3 09:23:33 veridian worker[100]: item-33
+Nov  3 09:23:34 veridian worker[100]: item-34
+Nov  3 09:23:35 veridian worker[100]: item-35
+Nov  3 09:23:36 veridian worker[100]: item-36
+Nov  3 09:23:37 veridian worker[100]: item-37
+Nov  3 09:23:38 veridian worker[100]: item-38
+Nov  3 09:23:39 veridian worker[100]: item-39
+Nov  3 09:23:40 veridian worker[100]: item-40
+Nov  3 09:23:41 veridian worker[100]: item-41
+Nov  3 09:23:42 veridian worker[100]: item-42
+Nov  3 09:23:43 veridian worker[100]: item-43
+Nov  3 09:23:44 veridian worker[100]: item-44
+EOF
+
+run_test ${lnav_test} -n \
+    "${MANY_FILTERS[@]}" \
+    "${DELETE_HIGH_FILTERS[@]}" \
+    -c ":filter-out item-36\$" \
+    -c ":delete-filter item-5\$" \
+    logfile_many_filters.0
+
+check_output "re-adding a filter past 32 does not widen the masks?" <<EOF
+Nov  3 09:23:05 veridian worker[100]: item-5
+Nov  3 09:23:32 veridian worker[100]: item-32
+Nov  3 09:23:33 veridian worker[100]: item-33
+Nov  3 09:23:34 veridian worker[100]: item-34
+Nov  3 09:23:35 veridian worker[100]: item-35
+Nov  3 09:23:37 veridian worker[100]: item-37
+Nov  3 09:23:38 veridian worker[100]: item-38
+Nov  3 09:23:39 veridian worker[100]: item-39
+Nov  3 09:23:40 veridian worker[100]: item-40
+Nov  3 09:23:41 veridian worker[100]: item-41
+Nov  3 09:23:42 veridian worker[100]: item-42
+Nov  3 09:23:43 veridian worker[100]: item-43
+Nov  3 09:23:44 veridian worker[100]: item-44
+EOF
+
+# Enough lines that adding the filters evaluates them in several ranges on
+# the worker threads.  The result has to be the same as matching the lines
+# one at a time.
+awk 'BEGIN {
+    for (i = 0; i < 20000; i++) {
+        printf "Nov  3 %02d:%02d:%02d veridian worker[%d]: line id=%d tag-%d\n",
+            9 + i / 3600, (i / 60) % 60, i % 60, 100 + i % 50, i, i % 7;
+    }
+}' > logfile_filter_ranges.0
+
+rm -f filter_ranges.err
+run_test ${lnav_test} -n -d filter_ranges.err \
+    -c ":filter-in tag-[35]\$" \
+    -c ":filter-out id=[0-9]*7 " \
+    logfile_filter_ranges.0
+
+grep -E 'tag-[35]$' logfile_filter_ranges.0 | \
+    grep -Ev 'id=[0-9]*7 ' > filter_ranges.out
+check_output "filters evaluated in ranges differ from serial matching" \
+    < filter_ranges.out
+
+if ! grep -q "evaluated regex filters on .* lines in [2-9] ranges" \
+        filter_ranges.err; then
+    echo "regex filters were not evaluated in ranges"
+    exit 1
+fi
 
 run_cap_test ${lnav_test} -n \
     -c ":close" \
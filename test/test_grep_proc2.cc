@@ -31,7 +31,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
-#include <sys/wait.h>
 
 #include "config.h"
 #include "grep_proc.hh"
@@ -131,19 +130,21 @@ main(int argc, char* argv[])
 
     {
         my_sleeper_source mss;
+        my_sink msink;
         grep_proc<vis_line_t>* gp
             = new grep_proc<vis_line_t>(code, mss, psuperv);
-        int status;
 
+        gp->set_sink(&msink);
         gp->queue_request(-1_vl, gp->until_eof(1));
         gp->start();
 
-        assert(wait3(&status, WNOHANG, NULL) == 0);
+        // The lines are only read from the main loop, so start() should
+        // not block and deleting the grep_proc should cancel the request.
+        assert(gp->workers_active());
 
         delete gp;
 
-        assert(wait(&status) == -1);
-        assert(errno == ECHILD);
+        assert(msink.ms_finished);
     }
 
     return retval;
@@ -0,0 +1,251 @@
+/**
+ * Copyright (c) 2025, Timothy Stack
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * * Neither the name of Timothy Stack nor the names of its contributors
+ * may be used to endorse or promote products derived from this software
+ * without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <filesystem>
+#include <system_error>
+
+#include <stdlib.h>
+
+#include "base/injector.hh"
+#include "base/itertools.enumerate.hh"
+#include "config.h"
+#include "log_format_ext.hh"
+#include "log_format_loader.hh"
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+
+/**
+ * A temporary HOME directory that is removed when the test exits.
+ */
+struct temp_home {
+    temp_home()
+    {
+        char home_tmpl[] = "/tmp/lnav.test_log_format.XXXXXX";
+        auto* home = mkdtemp(home_tmpl);
+
+        REQUIRE(home != nullptr);
+        this->th_path = home;
+        setenv("HOME", home, 1);
+    }
+
+    ~temp_home()
+    {
+        std::error_code ec;
+
+        std::filesystem::remove_all(this->th_path, ec);
+    }
+
+    std::filesystem::path th_path;
+};
+
+static const std::vector<std::shared_ptr<log_format>>&
+loaded_formats()
+{
+    static temp_home home;
+    static auto retval = []() {
+
+        static auto builtin_formats
+            = injector::get<std::vector<std::shared_ptr<log_format>>>();
+        auto& root_formats = log_format::get_root_formats();
+
+        root_formats.insert(root_formats.begin(),
+                            builtin_formats.begin(),
+                            builtin_formats.end());
+        builtin_formats.clear();
+
+        std::vector<lnav::console::user_message> errors;
+        std::vector<std::filesystem::path> paths;
+
+        load_formats(paths, errors);
+        CHECK(errors.empty());
+
+        return root_formats;
+    }();
+
+    return retval;
+}
+
+/**
+ * The combined pattern numbers the captures of each branch after those of
+ * the branches before it, so this returns where the captures for the
+ * pattern at the given index start.
+ */
+static size_t
+combined_capture_offset(const external_log_format& elf, size_t pat_index)
+{
+    size_t retval = 0;
+
+    for (size_t lpc = 0; lpc < pat_index; lpc++) {
+        retval
+            += elf.elf_pattern_order[lpc]->p_pcre.pp_value->get_capture_count();
+    }
+
+    return retval;
+}
+
+TEST_CASE("combined pattern matches sequential scan")
+{
+    size_t combined_count = 0;
+
+    for (const auto& lf : loaded_formats()) {
+        auto elf = std::dynamic_pointer_cast<external_log_format>(lf);
+
+        if (elf == nullptr || elf->elf_combined_pattern == nullptr) {
+            continue;
+        }
+
+        combined_count += 1;
+        for (const auto& sample : elf->elf_samples) {
+            auto line = string_fragment::from_str(sample.s_line.pp_value)
+                            .split_lines()[0];
+            auto expected_index = -1;
+            auto seq_md = lnav::pcre2pp::match_data::unitialized();
+
+            for (const auto& [index, pat] :
+                 lnav::itertools::enumerate(elf->elf_pattern_order))
+            {
+                seq_md = pat->p_pcre.pp_value->create_match_data();
+                auto match_res = pat->p_pcre.pp_value->capture_from(line)
+                                     .into(seq_md)
+                                     .matches(PCRE2_NO_UTF_CHECK)
+                                     .ignore_error();
+                if (match_res) {
+                    expected_index = index;
+                    break;
+                }
+            }
+
+            INFO("format: " << elf->get_name().get());
+            INFO("sample: " << sample.s_line.pp_value);
+            CHECK(elf->first_matching_pattern(line) == expected_index);
+            if (expected_index == -1) {
+                continue;
+            }
+
+            // scan() reads the captures straight from the combined match,
+            // using the group numbers of the pattern that won.
+            auto combined_md = lnav::pcre2pp::match_data::unitialized();
+            REQUIRE(elf->first_matching_pattern(line, combined_md)
+                    == expected_index);
+            CHECK(elf->elf_combined_capture_offsets[expected_index]
+                  == combined_capture_offset(*elf, expected_index));
+
+            const auto& pat = elf->elf_pattern_order[expected_index];
+            for (size_t cap = 0;
+                 cap <= pat->p_pcre.pp_value->get_capture_count();
+                 cap++)
+            {
+                auto combined_cap = combined_md[cap];
+
+                INFO("pattern: " << pat->p_config_path);
+                INFO("capture: " << cap);
+                CHECK(seq_md[cap].has_value() == combined_cap.has_value());
+                if (seq_md[cap] && combined_cap) {
+                    CHECK(seq_md[cap]->sf_begin == combined_cap->sf_begin);
+                    CHECK(seq_md[cap]->sf_end == combined_cap->sf_end);
+                }
+            }
+        }
+    }
+
+    CHECK(combined_count > 0);
+}
+
+TEST_CASE("uncombinable patterns")
+{
+    for (const auto& lf : loaded_formats()) {
+        auto elf = std::dynamic_pointer_cast<external_log_format>(lf);
+
+        if (elf == nullptr || elf->elf_combined_pattern != nullptr) {
+            continue;
+        }
+
+        // Formats without a combined pattern must fall back to trying
+        // each pattern in turn.
+        for (const auto& sample : elf->elf_samples) {
+            auto line = string_fragment::from_str(sample.s_line.pp_value)
+                            .split_lines()[0];
+
+            INFO("format: " << elf->get_name().get());
+            CHECK_FALSE(elf->first_matching_pattern(line).has_value());
+        }
+    }
+
+    auto add_pattern = [](external_log_format& elf, const char* regex) {
+        auto pat = std::make_shared<external_log_format::pattern>();
+
+        pat->p_config_path = fmt::format(
+            FMT_STRING("/test_log/regex/{}"), elf.elf_pattern_order.size());
+        pat->p_pcre.pp_value
+            = lnav::pcre2pp::code::from(string_fragment::from_c_str(regex),
+                                        PCRE2_DOTALL)
+                  .unwrap()
+                  .to_shared();
+        elf.elf_pattern_order.emplace_back(pat);
+    };
+
+    SUBCASE("back-reference")
+    {
+        external_log_format elf(intern_string::lookup("test_log"));
+
+        add_pattern(elf, R"(^(?<word>\w+) \k<word>$)");
+        add_pattern(elf, R"(^(?<body>.*)$)");
+        elf.build_combined_pattern();
+        CHECK(elf.elf_combined_pattern == nullptr);
+        CHECK_FALSE(elf.first_matching_pattern(
+                            string_fragment::from_const("abc abc"))
+                        .has_value());
+    }
+
+    SUBCASE("unanchored")
+    {
+        external_log_format elf(intern_string::lookup("test_log"));
+
+        add_pattern(elf, R"(^(?<timestamp>\d+) (?<body>.*)$)");
+        add_pattern(elf, R"((?<body>error.*)$)");
+        elf.build_combined_pattern();
+        CHECK(elf.elf_combined_pattern == nullptr);
+    }
+
+    SUBCASE("duplicate names")
+    {
+        external_log_format elf(intern_string::lookup("test_log"));
+
+        add_pattern(elf, R"(^(?<timestamp>\d+) (?<body>.*)$)");
+        add_pattern(elf, R"(^(?<body>.*)$)");
+        elf.build_combined_pattern();
+        REQUIRE(elf.elf_combined_pattern != nullptr);
+        CHECK(elf.first_matching_pattern(
+                  string_fragment::from_const("123 hello"))
+              == 0);
+        CHECK(elf.first_matching_pattern(string_fragment::from_const("hello"))
+              == 1);
+    }
+}
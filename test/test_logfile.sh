@@ -208,6 +208,71 @@ log       logfile_access_log.0       1
 log       logfile_access_log.1       1
 EOF
 
+    if command -v zip > /dev/null 2>&1; then
+        rm -f test-logs.zip
+        (cd ${top_srcdir} && zip -q ${builddir}/test-logs.zip \
+            test/logfile_access_log.0 test/logfile_access_log.1 \
+            test/logfile_empty.0)
+
+        run_test env TMPDIR=logfile-tmp ${lnav_test} -n test-logs.zip
+
+        check_output "zip members not unpacked" <<EOF
+192.168.202.254 - - [20/Jul/2009:22:59:26 +0000] "GET /vmw/cgi/tramp HTTP/1.0" 200 134 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkboot.gz HTTP/1.0" 404 46210 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkernel.gz HTTP/1.0" 200 78929 "-" "gPXE/0.9.7"
+10.112.81.15 - - [15/Feb/2013:06:00:31 +0000] "-" 400 0 "-" "-"
+EOF
+
+        run_test env TMPDIR=logfile-tmp ${lnav_test} -n \
+            -c ';SELECT view_name, basename(filepath), visible FROM lnav_view_files' \
+            test-logs.zip
+
+        check_output "zip members not loaded correctly" <<EOF
+view_name  basename(filepath)  visible
+log       logfile_access_log.0       1
+log       logfile_access_log.1       1
+EOF
+    fi
+
+    rm -rf test-links
+    mkdir test-links
+    cp ${srcdir}/logfile_access_log.0 test-links/access.0
+    ln test-links/access.0 test-links/access-hard.0
+    ln -s access.0 test-links/access-sym.0
+    tar cfz ${builddir}/test-links.tgz -C test-links \
+        access.0 access-hard.0 access-sym.0
+
+    run_test env TMPDIR=logfile-tmp ${lnav_test} -n \
+        -c ':config /tuning/archive-manager/compress-cache true' \
+        ${srcdir}/logfile_syslog.0
+
+    run_test env TMPDIR=logfile-tmp ${lnav_test} -n test-links.tgz
+
+    check_output "compressed archive not loaded" <<EOF
+192.168.202.254 - - [20/Jul/2009:22:59:26 +0000] "GET /vmw/cgi/tramp HTTP/1.0" 200 134 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkboot.gz HTTP/1.0" 404 46210 "-" "gPXE/0.9.7"
+192.168.202.254 - - [20/Jul/2009:22:59:29 +0000] "GET /vmw/vSphere/default/vmkernel.gz HTTP/1.0" 200 78929 "-" "gPXE/0.9.7"
+EOF
+
+    if ! test -f logfile-tmp/*/archives/*-test-links.tgz/access.0.lnav.gz; then
+        echo "archived file not compressed"
+        exit 1
+    fi
+
+    if ! test -f logfile-tmp/*/archives/*-test-links.tgz/access-hard.0.lnav.gz; then
+        echo "hard link not created in compressed cache"
+        exit 1
+    fi
+
+    if ! test -f logfile-tmp/*/archives/*-test-links.tgz/access-sym.0.lnav.gz; then
+        echo "symlink does not point at the compressed file"
+        exit 1
+    fi
+
+    run_test env TMPDIR=logfile-tmp ${lnav_test} -n \
+        -c ':config /tuning/archive-manager/compress-cache false' \
+        ${srcdir}/logfile_syslog.0
+
     run_test env TMPDIR=logfile-tmp ${lnav_test} -n \
         test-logs-trunc.tgz
 
@@ -814,3 +879,67 @@ run_cap_test env TZ=UTC ${lnav_test} -n \
     -c ';select session_start from ts_value_log' \
     -c ':write-csv-to -' \
     ${test_dir}/logfile_ts_value.0
+
+rm -rf index-cache-tmp
+mkdir -p index-cache-tmp
+awk 'BEGIN {
+    for (i = 0; i < 30000; i++) {
+        printf "Jan  1 %02d:%02d:%02d veridian app[100]: message %05d%s\n",
+            i / 3600, (i / 60) % 60, i % 60, i,
+            (i % 10000 == 5 ? " keep-me" : "");
+    }
+}' > logfile_index_cache.0
+
+for pass in first second; do
+    if test x"${pass}" = x"second"; then
+        touch index-cache-tmp/before-second
+        sleep 1
+    fi
+    rm -f index_cache.err
+    run_test env TMPDIR=index-cache-tmp ${lnav_test} -n -d index_cache.err \
+        -c ':filter-in keep-me' \
+        logfile_index_cache.0
+
+    check_output "filter not applied to the ${pass} load of a large file" <<EOF
+Jan  1 00:00:05 veridian app[100]: message 00005 keep-me
+Jan  1 02:46:45 veridian app[100]: message 10005 keep-me
+Jan  1 05:33:25 veridian app[100]: message 20005 keep-me
+EOF
+
+    if ! test -d index-cache-tmp/lnav-user-*-work/index-cache; then
+        echo "index cache was not written"
+        exit 1
+    fi
+done
+
+if ! grep -q "loaded .* lines from index cache" index_cache.err; then
+    echo "index cache was not used on the second load"
+    exit 1
+fi
+
+if test -z "`find index-cache-tmp/lnav-user-*-work/index-cache -type f \
+        -newer index-cache-tmp/before-second`"; then
+    echo "index cache was not touched when it was used"
+    exit 1
+fi
+
+# Several files whose lines interleave, with enough lines in total that the
+# runs for each file are sorted on the worker threads during the full sort
+# of the initial index.
+for f in 0 1 2; do
+    awk -v f=$f 'BEGIN {
+        for (i = 0; i < 25000; i++) {
+            t = 3 * i + f;
+            printf "Nov  3 %02d:%02d:%02d veridian proc[%d]: file %d line %d\n",
+                t / 3600, (t / 60) % 60, t % 60, 100 + f, f, i;
+        }
+    }' > logfile_full_sort.$f
+done
+
+run_test ${lnav_test} -n \
+    logfile_full_sort.0 logfile_full_sort.1 logfile_full_sort.2
+
+LC_ALL=C sort logfile_full_sort.0 logfile_full_sort.1 logfile_full_sort.2 \
+    > full_sort.out
+check_output "files are not merged in time order by a full sort" \
+    < full_sort.out
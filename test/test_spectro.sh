@@ -18,3 +18,35 @@ run_cap_test ${lnav_test} -n \
     -c ":mark" \
     -c ":switch-to-view log" \
     ${test_dir}/logfile_access_log.0
+
+# A log that spans several rows of the spectrogram so they can be filled in
+# from the time rollups.  The line without a byte count is filtered out in
+# the second run to force a walk over the messages, which has to draw the
+# same thing.
+awk 'BEGIN {
+    for (i = 0; i < 240; i++) {
+        printf "192.168.202.254 - - [20/Jul/2009:22:%02d:%02d +0000] \"GET %s HTTP/1.0\" 200 %s \"-\" \"gPXE/0.9.7\"\n",
+            30 + i / 12, (i % 12) * 5,
+            (i == 100 ? "/skip-me" : "/vmw/cgi/tramp"),
+            (i == 100 ? "-" : (i % 7) * 100 + 100);
+    }
+}' > logfile_spectro_rollup.0
+
+rm -f spectro_rollup.err
+run_test ${lnav_test} -n -d spectro_rollup.err \
+    -c ":spectrogram sc_bytes" \
+    logfile_spectro_rollup.0
+cp `test_filename` spectro_rollup.out
+
+if ! grep -q "spectrogram row filled from rollups" spectro_rollup.err; then
+    echo "spectrogram rows were not filled from the rollups"
+    exit 1
+fi
+
+run_test ${lnav_test} -n \
+    -c ":filter-out skip-me" \
+    -c ":spectrogram sc_bytes" \
+    logfile_spectro_rollup.0
+
+check_output "spectrogram from rollups differs from the walk" \
+    < spectro_rollup.out
@@ -162,6 +162,17 @@ logfile_access_log.0,access_log,3,0
 logfile_access_log.1,access_log,1,0
 EOF
 
+run_test ${lnav_test} -n \
+    -c ";SELECT metric, CAST(value AS INTEGER) AS value, unit FROM lnav_perf WHERE kind = 'file' AND metric IN ('indexed_bytes', 'indexed_lines')" \
+    -c ":write-csv-to -" \
+    ${test_dir}/logfile_access_log.0
+
+check_output "lnav_perf table is not working?" <<EOF
+metric,value,unit
+indexed_bytes,351,bytes
+indexed_lines,3,lines
+EOF
+
 run_cap_test ${lnav_test} -n \
     -c ";UPDATE lnav_file SET time_offset = 60 * 1000" \
     ${test_dir}/logfile_access_log.0 \
@@ -973,3 +984,57 @@ run_cap_test ${lnav_test} -n \
 run_cap_test ${lnav_test} -n \
     -c ";SELECT * FROM all_opids" \
     ${test_dir}/logfile_vpxd.0
+
+# Two logs where each opid and thread ID covers a small part of the lines,
+# so the lookups are answered from the postings.  The unary plus keeps the
+# constraint from being passed to the vtab, which forces a full scan to
+# compare against.
+for f in 0 1; do
+    awk -v f=$f 'BEGIN {
+        for (i = 0; i < 400; i++) {
+            t = 2 * i + f;
+            printf "Nov  3 10:%02d:%02d veridian proc-%d[%d]: message %d\n",
+                t / 60, t % 60, i % 10, 100 + i % 20, i;
+        }
+    }' > logfile_postings.$f
+done
+
+rm -f postings_opid.err
+run_test ${lnav_test} -n -d postings_opid.err \
+    -c ";SELECT log_line, log_opid FROM syslog_log WHERE log_opid = 'proc-5[105]'" \
+    -c ":write-csv-to -" \
+    logfile_postings.0 logfile_postings.1
+cp `test_filename` postings_opid.out
+
+if ! grep -q "using postings to visit 40 of" postings_opid.err; then
+    echo "the opid lookup did not use the postings"
+    exit 1
+fi
+
+run_test ${lnav_test} -n \
+    -c ";SELECT log_line, log_opid FROM syslog_log WHERE +log_opid = 'proc-5[105]'" \
+    -c ":write-csv-to -" \
+    logfile_postings.0 logfile_postings.1
+
+check_output "opid lookup from postings differs from a full scan" \
+    < postings_opid.out
+
+rm -f postings_tid.err
+run_test ${lnav_test} -n -d postings_tid.err \
+    -c ";SELECT log_line, log_thread_id FROM syslog_log WHERE log_thread_id = '112'" \
+    -c ":write-csv-to -" \
+    logfile_postings.0 logfile_postings.1
+cp `test_filename` postings_tid.out
+
+if ! grep -q "using postings to visit 40 of" postings_tid.err; then
+    echo "the thread ID lookup did not use the postings"
+    exit 1
+fi
+
+run_test ${lnav_test} -n \
+    -c ";SELECT log_line, log_thread_id FROM syslog_log WHERE +log_thread_id = '112'" \
+    -c ":write-csv-to -" \
+    logfile_postings.0 logfile_postings.1
+
+check_output "thread ID lookup from postings differs from a full scan" \
+    < postings_tid.out